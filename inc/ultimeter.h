@@ -15,6 +15,37 @@
 #include "maths.h"
 #include "types.h"
 
+/*** ULTIMETER macros ***/
+
+#ifdef ULTIMETER_DRIVER_STATE
+// Increment when the state content changes.
+#define ULTIMETER_STATE_VERSION                 3
+
+#ifdef ULTIMETER_DRIVER_WIND_SPEED_RECIPROCAL
+#define ULTIMETER_STATE_GUST_SIZE_BYTES         4
+#else
+#define ULTIMETER_STATE_GUST_SIZE_BYTES         0
+#endif
+#ifdef ULTIMETER_DRIVER_WIND_ROSE_SECTORS
+#define ULTIMETER_STATE_WIND_ROSE_SIZE_BYTES    (2 * ((ULTIMETER_DRIVER_WIND_ROSE_SECTORS * ULTIMETER_DRIVER_WIND_ROSE_SPEED_BINS) + 1))
+#else
+#define ULTIMETER_STATE_WIND_ROSE_SIZE_BYTES    0
+#endif
+#ifdef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+#define ULTIMETER_STATE_DIRECTION_SIZE_BYTES    0
+#else
+#define ULTIMETER_STATE_DIRECTION_SIZE_BYTES    28
+#endif
+// Header (version, options, wind rose sectors and speed bins) + wind speed (count, sum, duration, peak sum and duration) + wind direction (trend point, weight, count) + CRC16.
+#define ULTIMETER_STATE_SIZE_BYTES              (4 + 24 + ULTIMETER_STATE_GUST_SIZE_BYTES + ULTIMETER_STATE_DIRECTION_SIZE_BYTES + ULTIMETER_STATE_WIND_ROSE_SIZE_BYTES + 2)
+#endif
+
+#ifdef ULTIMETER_DRIVER_SINK_BATCH_RECORDS
+// Windows closed in a sink record.
+#define ULTIMETER_SINK_WINDOW_WIND_SPEED        0x01
+#define ULTIMETER_SINK_WINDOW_WIND_DIRECTION    0x02
+#endif
+
 /*** ULTIMETER structures ***/
 
 /*!******************************************************************
@@ -26,6 +57,21 @@ typedef enum {
     ULTIMETER_SUCCESS = 0,
     ULTIMETER_ERROR_NULL_PARAMETER,
     ULTIMETER_ERROR_RESISTOR_DIVIDER_RATIO,
+    ULTIMETER_ERROR_TIMER_COUNTER_WIDTH,
+    ULTIMETER_ERROR_TIMER_FREQUENCY,
+    ULTIMETER_ERROR_SLIDING_WINDOW,
+    ULTIMETER_ERROR_SAMPLING_PERIOD,
+    ULTIMETER_ERROR_SNAPSHOT,
+    ULTIMETER_ERROR_WIND_ROSE_BITS,
+    ULTIMETER_ERROR_WIND_ROSE_BUFFER_SIZE,
+    ULTIMETER_ERROR_RECORDER_FULL,
+    ULTIMETER_ERROR_RECORDER_END,
+    ULTIMETER_ERROR_RECORDER_DATA,
+    ULTIMETER_ERROR_BATCH_LENGTH,
+    ULTIMETER_ERROR_DUTY_CYCLE,
+    ULTIMETER_ERROR_STATE_SIZE,
+    ULTIMETER_ERROR_STATE_VERSION,
+    ULTIMETER_ERROR_STATE_CRC,
     // Low level drivers errors.
     ULTIMETER_ERROR_BASE_TIMER = ERROR_BASE_STEP,
     ULTIMETER_ERROR_BASE_MATH = (ULTIMETER_ERROR_BASE_TIMER + ULTIMETER_DRIVER_TIMER_ERROR_BASE_LAST),
@@ -45,78 +91,700 @@ typedef enum {
     ULTIMETER_WIND_DIRECTION_STATUS_LAST
 } ULTIMETER_wind_direction_status_t;
 
+/*!******************************************************************
+ * \struct ULTIMETER_wind_direction_statistics_t
+ * \brief ULTIMETER driver wind direction statistics.
+ *******************************************************************/
+typedef struct {
+    int32_t average_direction_degrees;
+    uint32_t steadiness_per_mille;
+    uint32_t standard_deviation_degrees;
+    ULTIMETER_wind_direction_status_t direction_status;
+} ULTIMETER_wind_direction_statistics_t;
+
+#ifdef ULTIMETER_DRIVER_SLIDING_WINDOW_LONG_SAMPLES
+/*!******************************************************************
+ * \enum ULTIMETER_sliding_window_t
+ * \brief ULTIMETER driver sliding windows list.
+ *******************************************************************/
+typedef enum {
+    ULTIMETER_SLIDING_WINDOW_SHORT = 0,
+    ULTIMETER_SLIDING_WINDOW_LONG,
+    ULTIMETER_SLIDING_WINDOW_LAST
+} ULTIMETER_sliding_window_t;
+#endif
+
+/*!******************************************************************
+ * \struct ULTIMETER_snapshot_t
+ * \brief ULTIMETER driver consistent set of measurements.
+ * \note   The sequence number is incremented each time a new snapshot is published (end of wind speed or direction window, measurements reset).
+ *******************************************************************/
+typedef struct {
+    uint32_t sequence;
+    uint32_t wind_speed_sample_count;
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+    uint32_t wind_direction_sample_count;
+#endif
+    int32_t average_speed_mh;
+    int32_t peak_speed_mh;
+#ifdef ULTIMETER_DRIVER_WIND_SPEED_RECIPROCAL
+    int32_t instantaneous_gust_speed_mh;
+#endif
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+    ULTIMETER_wind_direction_statistics_t direction_statistics;
+#endif
+#ifdef ULTIMETER_DRIVER_SLIDING_WINDOW_LONG_SAMPLES
+    int32_t sliding_window_average_speed_mh[ULTIMETER_SLIDING_WINDOW_LAST];
+    int32_t sliding_window_average_direction_degrees[ULTIMETER_SLIDING_WINDOW_LAST];
+    ULTIMETER_wind_direction_status_t sliding_window_direction_status[ULTIMETER_SLIDING_WINDOW_LAST];
+    int32_t sliding_window_gust_speed_mh;
+#endif
+} ULTIMETER_snapshot_t;
+
+/*!******************************************************************
+ * \struct ULTIMETER_accumulators_t
+ * \brief ULTIMETER driver raw measurements accumulators.
+ * \note   A copy is published at the end of each window, the statistics of the snapshot are only computed when it is read.
+ * \note   Wind speeds are accumulated as the sum of the windows speeds multiplied by their duration (m/h x s), so that the average is exact whatever the run length.
+ *******************************************************************/
+typedef struct {
+    uint32_t sequence;
+    uint32_t wind_speed_data_count;
+    uint64_t wind_speed_sum;
+    uint32_t wind_speed_seconds_sum;
+    uint32_t wind_speed_peak_sum;
+    uint32_t wind_speed_peak_seconds;
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+    uint32_t wind_direction_data_count;
+    int64_t wind_direction_trend_point_x;
+    int64_t wind_direction_trend_point_y;
+    uint64_t wind_direction_weight_sum;
+#endif
+#ifdef ULTIMETER_DRIVER_WIND_SPEED_RECIPROCAL
+    uint32_t wind_speed_mh_gust;
+#endif
+#ifdef ULTIMETER_DRIVER_SLIDING_WINDOW_LONG_SAMPLES
+    uint32_t sliding_window_count;
+    uint32_t sliding_window_long_speed_sum;
+    int64_t sliding_window_long_trend_point_x;
+    int64_t sliding_window_long_trend_point_y;
+    uint32_t sliding_window_short_speed_sum;
+    int64_t sliding_window_short_trend_point_x;
+    int64_t sliding_window_short_trend_point_y;
+    uint32_t sliding_window_gust_speed_sum_max;
+#endif
+} ULTIMETER_accumulators_t;
+
+#ifdef ULTIMETER_DRIVER_DIAGNOSTICS
+/*!******************************************************************
+ * \struct ULTIMETER_diagnostics_cycles_t
+ * \brief ULTIMETER driver execution time accumulator.
+ *******************************************************************/
+typedef struct {
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    uint32_t count;
+} ULTIMETER_diagnostics_cycles_t;
+
+/*!******************************************************************
+ * \struct ULTIMETER_cycles_statistics_t
+ * \brief ULTIMETER driver execution time statistics in cycle counter units.
+ *******************************************************************/
+typedef struct {
+    uint32_t min_cycles;
+    uint32_t max_cycles;
+    uint32_t average_cycles;
+} ULTIMETER_cycles_statistics_t;
+
+/*!******************************************************************
+ * \struct ULTIMETER_diagnostics_t
+ * \brief ULTIMETER driver runtime diagnostics.
+ * \note   wind_direction_missing_count is the number of rotations without direction edge, wind_direction_rejected_count the number of direction edges discarded by the period and duty cycle checks.
+ * \note   missed_tick_count is the number of ticks which occurred before the previous one was handled by ULTIMETER_process().
+ *******************************************************************/
+typedef struct {
+    uint32_t wind_speed_edge_irq_count;
+    uint32_t wind_direction_edge_irq_count;
+    uint32_t tick_irq_count;
+    uint32_t process_count;
+    uint32_t wind_direction_missing_count;
+    uint32_t wind_direction_rejected_count;
+    uint32_t missed_tick_count;
+    ULTIMETER_cycles_statistics_t wind_speed_edge_irq_cycles;
+    ULTIMETER_cycles_statistics_t wind_direction_edge_irq_cycles;
+    ULTIMETER_cycles_statistics_t tick_irq_cycles;
+    ULTIMETER_cycles_statistics_t process_cycles;
+} ULTIMETER_diagnostics_t;
+#endif
+
+#ifdef ULTIMETER_DRIVER_ADAPTIVE_SAMPLING
+/*!******************************************************************
+ * \struct ULTIMETER_adaptive_sampling_t
+ * \brief ULTIMETER driver adaptive sampling policy parameters.
+ * \note   The wind speed window is doubled (up to the maximum) and the direction sampling is stopped after each hysteresis_windows consecutive windows below calm_threshold_mh.
+ * \note   The window comes back to the minimum after hysteresis_windows consecutive windows with a speed variation above gust_threshold_mh.
+ * \note   The direction sampling restarts after hysteresis_windows consecutive windows above calm_threshold_mh.
+ *******************************************************************/
+typedef struct {
+    uint32_t wind_speed_sampling_time_seconds_min;
+    uint32_t wind_speed_sampling_time_seconds_max;
+    uint32_t calm_threshold_mh;
+    uint32_t gust_threshold_mh;
+    uint8_t hysteresis_windows;
+} ULTIMETER_adaptive_sampling_t;
+#endif
+
+/*!******************************************************************
+ * \struct ULTIMETER_handle_t
+ * \brief ULTIMETER driver instance handle (forward declaration).
+ *******************************************************************/
+typedef struct ULTIMETER_handle_s ULTIMETER_handle_t;
+
+#ifdef ULTIMETER_DRIVER_RECORDER
+/*!******************************************************************
+ * \struct ULTIMETER_RECORDER_t
+ * \brief ULTIMETER recorder context (forward declaration, see ultimeter_recorder.h).
+ *******************************************************************/
+typedef struct ULTIMETER_RECORDER_s ULTIMETER_RECORDER_t;
+#endif
+
 /*!******************************************************************
  * \fn ULTIMETER_process_cb_t
  * \brief ULTIMETER driver process callback.
  *******************************************************************/
-typedef void (*ULTIMETER_process_cb_t)(void);
+typedef void (*ULTIMETER_process_cb_t)(ULTIMETER_handle_t* handle);
+
+#ifdef ULTIMETER_DRIVER_SINK_BATCH_RECORDS
+/*!******************************************************************
+ * \struct ULTIMETER_sink_record_t
+ * \brief ULTIMETER driver window record.
+ * \note   window_flags is a combination of ULTIMETER_SINK_WINDOW_WIND_SPEED and ULTIMETER_SINK_WINDOW_WIND_DIRECTION, speeds are only relevant when the wind speed window is closed.
+ * \note   When the wind direction window is closed, the direction is the average of the direction period, undefined if no direction has been measured during the period.
+ * \note   Otherwise, the direction is the one of the last rotation, it is only available when a wind speed window with wind is closed (as for the average direction).
+ * \note   sequence is the sequence number of the snapshot published with the record.
+ *******************************************************************/
+typedef struct {
+    uint32_t sequence;
+    uint32_t wind_speed_mh;
+    uint32_t peak_wind_speed_mh;
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+    int16_t wind_direction_degrees;
+    uint8_t direction_status;
+#endif
+    uint8_t window_flags;
+} ULTIMETER_sink_record_t;
+
+/*!******************************************************************
+ * \fn ULTIMETER_sink_cb_t
+ * \brief ULTIMETER driver window records sink callback.
+ * \note   The records array is only valid during the callback, which is called from the ULTIMETER_process() context.
+ *******************************************************************/
+typedef void (*ULTIMETER_sink_cb_t)(ULTIMETER_handle_t* handle, ULTIMETER_sink_record_t* records, uint32_t record_count);
+#endif
+
+/*!******************************************************************
+ * \struct ULTIMETER_configuration_t
+ * \brief ULTIMETER driver instance parameters.
+ * \note   sink_callback is optional, window records are not built when it is NULL.
+ *******************************************************************/
+typedef struct {
+    uint8_t instance;
+    ULTIMETER_process_cb_t process_callback;
+#ifdef ULTIMETER_DRIVER_SINK_BATCH_RECORDS
+    ULTIMETER_sink_cb_t sink_callback;
+#endif
+} ULTIMETER_configuration_t;
+
+/*!******************************************************************
+ * \struct ULTIMETER_handle_s
+ * \brief ULTIMETER driver instance context.
+ * \note   The structure is allocated by the caller (one per sensor) but its fields must only be accessed through the driver functions.
+ * \note   When ULTIMETER_DRIVER_EDGE_BUFFER_SIZE is defined, the edge interrupts only push raw timestamps which are processed by ULTIMETER_process().
+ * \note   In this mode, each edge interrupt reads the timer and pushes its entry in a critical section (see ULTIMETER_HW_enter_critical()), so that the buffer shared by both edge interrupts stays ordered.
+ * \note   When the timer counter is narrower than 32 bits, the counter must not wrap more than once between two ticks (the alarm delay is limited accordingly in tickless mode).
+ * \note   ULTIMETER_HW_enter_critical() must mask the edge and tick interrupts when they do not have the same priority level.
+ *******************************************************************/
+struct ULTIMETER_handle_s {
+    // Hardware interface.
+    uint32_t timer_counter_mask;
+    uint32_t timer_counter_last;
+    uint32_t timer_counter_extension;
+#if ((defined ULTIMETER_DRIVER_WIND_SPEED_RECIPROCAL) || (defined ULTIMETER_DRIVER_DEBOUNCE_WIND_SPEED_MAX_MH))
+    uint32_t timer_frequency_hz;
+#endif
+    uint8_t instance;
+    // State machine.
+    uint8_t wind_speed_sampling_time_seconds;
+    volatile uint8_t tick_second_flag;
+    // Flags only written from the ULTIMETER_process() context, packed in a single byte.
+    uint8_t wind_measurement_enable_flag : 1;
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+    uint8_t wind_direction_enable_flag : 1;
+#endif
+#ifdef ULTIMETER_DRIVER_ADAPTIVE_SAMPLING
+    uint8_t adaptive_sampling_enable_flag : 1;
+#endif
+#ifdef ULTIMETER_DRIVER_DUTY_CYCLE
+    uint8_t duty_cycle_capture_flag : 1;
+#endif
+    ULTIMETER_process_cb_t process_callback;
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+    uint32_t wind_direction_sampling_period_seconds;
+#endif
+#ifdef ULTIMETER_DRIVER_DEBOUNCE_WIND_SPEED_MAX_MH
+    // Edges filter.
+    uint32_t debounce_period_min;
+    volatile uint32_t debounce_wind_speed_counter_last;
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+    volatile uint32_t debounce_wind_direction_counter_last;
+#endif
+    volatile uint32_t debounce_rejected_edge_count;
+#endif
+#ifdef ULTIMETER_DRIVER_DEBOUNCE_STORM_EDGES
+    volatile uint32_t debounce_tick_rejected_edge_count;
+    volatile uint32_t debounce_storm_count;
+    volatile uint8_t debounce_interrupts_masked_flag;
+#endif
+#ifdef ULTIMETER_DRIVER_ADAPTIVE_SAMPLING
+    // Adaptive sampling.
+    ULTIMETER_adaptive_sampling_t adaptive_sampling;
+    uint32_t adaptive_sampling_last_speed_mh;
+    uint8_t adaptive_sampling_calm_count;
+    uint8_t adaptive_sampling_active_count;
+    uint8_t adaptive_sampling_gust_count;
+#endif
+#ifdef ULTIMETER_DRIVER_TICKLESS
+    volatile uint32_t alarm_delay_seconds;
+    uint32_t alarm_delay_seconds_max;
+#endif
+#ifdef ULTIMETER_DRIVER_DUTY_CYCLE
+    // Bursts schedule.
+    uint32_t duty_cycle_burst_seconds;
+    uint32_t duty_cycle_period_seconds;
+    volatile uint32_t duty_cycle_seconds_count;
+#endif
+    // Wind speed.
+    uint64_t wind_speed_sum;
+#ifdef ULTIMETER_DRIVER_WIND_SPEED_RECIPROCAL
+    volatile uint64_t wind_speed_period_sum;
+#endif
+    volatile uint32_t wind_speed_counter_start;
+    volatile uint32_t wind_speed_counter_stop;
+    volatile uint32_t wind_speed_edge_count;
+    uint32_t wind_speed_data_count;
+    uint32_t wind_speed_seconds_sum;
+    uint32_t wind_speed_peak_sum;
+    uint32_t wind_speed_peak_seconds;
+#ifdef ULTIMETER_DRIVER_WIND_SPEED_RECIPROCAL
+    volatile uint32_t wind_speed_period_count;
+    volatile uint32_t wind_speed_period_min;
+    uint32_t wind_speed_mh_gust;
+#endif
+    volatile uint8_t wind_speed_period_valid_flag;
+    volatile uint8_t wind_speed_seconds_count;
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+    // Wind direction.
+    volatile uint32_t wind_direction_counter;
+    volatile uint32_t wind_direction_angle;
+#ifdef ULTIMETER_DRIVER_WIND_DIRECTION_RECIPROCAL
+    volatile uint32_t wind_direction_period;
+#ifndef ULTIMETER_DRIVER_WIND_DIRECTION_PER_ROTATION
+    volatile uint32_t wind_direction_duty_cycle;
+#endif
+    volatile uint32_t wind_direction_period_reciprocal;
+#endif
+    volatile uint32_t wind_direction_seconds_count;
+#ifdef ULTIMETER_DRIVER_WIND_DIRECTION_PER_ROTATION
+    volatile uint32_t wind_direction_rotation_x_sum;
+    volatile uint32_t wind_direction_rotation_y_sum;
+    volatile uint32_t wind_direction_rotation_count;
+    uint32_t wind_direction_rotation_x_sum_last;
+    uint32_t wind_direction_rotation_y_sum_last;
+    uint32_t wind_direction_rotation_count_last;
+#endif
+    int64_t wind_direction_trend_point_x;
+    int64_t wind_direction_trend_point_y;
+    uint64_t wind_direction_weight_sum;
+    uint32_t wind_direction_data_count;
+#ifdef ULTIMETER_DRIVER_WIND_DIRECTION_RECIPROCAL
+    volatile uint8_t wind_direction_period_shift;
+#endif
+    volatile uint8_t wind_direction_irq_flag;
+#endif
+    // Published accumulators.
+    volatile ULTIMETER_accumulators_t snapshot[2];
+    volatile uint32_t snapshot_sequence;
+#ifdef ULTIMETER_DRIVER_SLIDING_WINDOW_LONG_SAMPLES
+    // Sliding windows samples.
+    uint32_t sliding_window_speed_mh[ULTIMETER_DRIVER_SLIDING_WINDOW_LONG_SAMPLES];
+    uint16_t sliding_window_direction_angle[ULTIMETER_DRIVER_SLIDING_WINDOW_LONG_SAMPLES];
+    uint16_t sliding_window_direction_weight[ULTIMETER_DRIVER_SLIDING_WINDOW_LONG_SAMPLES];
+    uint32_t sliding_window_position;
+    uint32_t sliding_window_count;
+    uint32_t sliding_window_sequence;
+    // Sliding windows running sums.
+    uint32_t sliding_window_long_speed_sum;
+    int64_t sliding_window_long_trend_point_x;
+    int64_t sliding_window_long_trend_point_y;
+    uint32_t sliding_window_short_speed_sum;
+    int64_t sliding_window_short_trend_point_x;
+    int64_t sliding_window_short_trend_point_y;
+    uint32_t sliding_window_gust_speed_sum;
+    // Gust maximum monotonic deque.
+    uint32_t sliding_window_gust_deque_sum[ULTIMETER_DRIVER_SLIDING_WINDOW_LONG_SAMPLES];
+    uint32_t sliding_window_gust_deque_sequence[ULTIMETER_DRIVER_SLIDING_WINDOW_LONG_SAMPLES];
+    uint32_t sliding_window_gust_deque_head;
+    uint32_t sliding_window_gust_deque_count;
+#endif
+#ifdef ULTIMETER_DRIVER_WIND_ROSE_SECTORS
+    // Wind rose saturating counters.
+    uint16_t wind_rose_count[ULTIMETER_DRIVER_WIND_ROSE_SECTORS][ULTIMETER_DRIVER_WIND_ROSE_SPEED_BINS];
+    uint16_t wind_rose_calm_count;
+#endif
+#ifdef ULTIMETER_DRIVER_RECORDER
+    ULTIMETER_RECORDER_t* recorder;
+#endif
+#ifdef ULTIMETER_DRIVER_SINK_BATCH_RECORDS
+    // Window records batch.
+    ULTIMETER_sink_cb_t sink_callback;
+    ULTIMETER_sink_record_t sink_records[ULTIMETER_DRIVER_SINK_BATCH_RECORDS];
+    uint32_t sink_record_count;
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+    // Trend point at the end of the last direction period.
+    int64_t sink_trend_point_x_last;
+    int64_t sink_trend_point_y_last;
+#endif
+#endif
+#ifdef ULTIMETER_DRIVER_DIAGNOSTICS
+    // Diagnostics.
+    volatile uint32_t diagnostics_wind_speed_edge_irq_count;
+    volatile uint32_t diagnostics_wind_direction_edge_irq_count;
+    volatile uint32_t diagnostics_tick_irq_count;
+    uint32_t diagnostics_process_count;
+    volatile uint32_t diagnostics_wind_direction_missing_count;
+    volatile uint32_t diagnostics_wind_direction_rejected_count;
+    volatile uint32_t diagnostics_missed_tick_count;
+    volatile ULTIMETER_diagnostics_cycles_t diagnostics_wind_speed_edge_irq_cycles;
+    volatile ULTIMETER_diagnostics_cycles_t diagnostics_wind_direction_edge_irq_cycles;
+    volatile ULTIMETER_diagnostics_cycles_t diagnostics_tick_irq_cycles;
+    ULTIMETER_diagnostics_cycles_t diagnostics_process_cycles;
+#endif
+#ifdef ULTIMETER_DRIVER_EDGE_BUFFER_SIZE
+    // Deferred edges buffer (both producers push in a critical section, single consumer).
+    volatile uint32_t edge_buffer_counter[ULTIMETER_DRIVER_EDGE_BUFFER_SIZE];
+    volatile uint8_t edge_buffer_type[ULTIMETER_DRIVER_EDGE_BUFFER_SIZE];
+    volatile uint32_t edge_buffer_write_index;
+    volatile uint32_t edge_buffer_read_index;
+    volatile uint32_t edge_buffer_tick_index;
+    volatile uint32_t edge_buffer_overflow_count;
+    volatile uint8_t edge_buffer_loss_flag;
+#endif
+};
 
 /*** ULTIMETER functions ***/
 
 /*!******************************************************************
- * \fn ULTIMETER_status_t ULTIMETER_init(ULTIMETER_process_cb_t process_callback)
- * \brief Init ULTIMETER driver.
- * \param[in]   process_callback: Function which will be called when the ULTIMETER driver has to be processed.
+ * \fn ULTIMETER_status_t ULTIMETER_init(ULTIMETER_handle_t* handle, ULTIMETER_configuration_t* configuration)
+ * \brief Init ULTIMETER driver instance.
+ * \param[in]   handle: Pointer to the instance context to initialize.
+ * \param[in]   configuration: Pointer to the instance parameters structure.
  * \param[out]  none
  * \retval      Function execution status.
  *******************************************************************/
-ULTIMETER_status_t ULTIMETER_init(ULTIMETER_process_cb_t process_callback);
+ULTIMETER_status_t ULTIMETER_init(ULTIMETER_handle_t* handle, ULTIMETER_configuration_t* configuration);
 
 /*!******************************************************************
- * \fn ULTIMETER_status_t ULTIMETER_de_init(void)
- * \brief Release ULTIMETER driver.
- * \param[in]   none
+ * \fn ULTIMETER_status_t ULTIMETER_de_init(ULTIMETER_handle_t* handle)
+ * \brief Release ULTIMETER driver instance.
+ * \param[in]   handle: Pointer to the instance context.
  * \param[out]  none
  * \retval      Function execution status.
  *******************************************************************/
-ULTIMETER_status_t ULTIMETER_de_init(void);
+ULTIMETER_status_t ULTIMETER_de_init(ULTIMETER_handle_t* handle);
 
 /*!******************************************************************
- * \fn ULTIMETER_status_t ULTIMETER_set_wind_measurement(uint8_t enable)
+ * \fn ULTIMETER_status_t ULTIMETER_set_wind_measurement(ULTIMETER_handle_t* handle, uint8_t enable)
  * \brief Control wind speed and direction measurements.
+ * \param[in]   handle: Pointer to the instance context.
  * \param[in]   enable: Disable (0) or enable (otherwise) wind speed and direction measurements.
  * \param[out]  none
  * \retval      Function execution status.
  *******************************************************************/
-ULTIMETER_status_t ULTIMETER_set_wind_measurement(uint8_t enable);
+ULTIMETER_status_t ULTIMETER_set_wind_measurement(ULTIMETER_handle_t* handle, uint8_t enable);
 
 /*!******************************************************************
- * \fn ULTIMETER_status_t ULTIMETER_process(void)
+ * \fn ULTIMETER_status_t ULTIMETER_process(ULTIMETER_handle_t* handle)
  * \brief ULTIMETER driver process function.
- * \param[in]   none
+ * \param[in]   handle: Pointer to the instance context.
  * \param[out]  none
  * \retval      Function execution status.
  *******************************************************************/
-ULTIMETER_status_t ULTIMETER_process(void);
+ULTIMETER_status_t ULTIMETER_process(ULTIMETER_handle_t* handle);
 
 /*!******************************************************************
- * \fn ULTIMETER_status_t ULTIMETER_get_wind_speed(int32_t* average_speed_mh, int32_t* peak_speed_mh)
+ * \fn ULTIMETER_status_t ULTIMETER_get_wind_speed(ULTIMETER_handle_t* handle, int32_t* average_speed_mh, int32_t* peak_speed_mh)
  * \brief Read wind speeds.
- * \param[in]   none
+ * \param[in]   handle: Pointer to the instance context.
  * \param[out]  average_speed_mh: Pointer to integer that will contain the average wind speed since last reset in m/h.
  * \param[out]  peak_speed_mh: Pointer to integer that will contain the peak wind speed since last reset in m/h.
  * \retval      Function execution status.
+ * \note   The average is weighted by the windows durations, the divisions are only computed when this function is called.
+ * \note   The peak is the highest wind speed window average, the fastest single rotation is given by ULTIMETER_get_instantaneous_wind_gust().
  *******************************************************************/
-ULTIMETER_status_t ULTIMETER_get_wind_speed(int32_t* average_speed_mh, int32_t* peak_speed_mh);
+ULTIMETER_status_t ULTIMETER_get_wind_speed(ULTIMETER_handle_t* handle, int32_t* average_speed_mh, int32_t* peak_speed_mh);
 
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
 /*!******************************************************************
- * \fn ULTIMETER_status_t ULTIMETER_get_wind_direction(int32_t* average_direction_degrees, ULTIMETER_wind_direction_status_t* direction_status)
+ * \fn ULTIMETER_status_t ULTIMETER_get_wind_direction(ULTIMETER_handle_t* handle, int32_t* average_direction_degrees, ULTIMETER_wind_direction_status_t* direction_status)
  * \brief Read wind average direction.
- * \param[in]   none
+ * \param[in]   handle: Pointer to the instance context.
  * \param[out]  average_direction_degrees: Pointer to integer that will contain the average wind direction since last reset in degrees.
  * \param[out]  direction_status: Status of the output data.
  * \retval      Function execution status.
  *******************************************************************/
-ULTIMETER_status_t ULTIMETER_get_wind_direction(int32_t* average_direction_degrees, ULTIMETER_wind_direction_status_t* direction_status);
+ULTIMETER_status_t ULTIMETER_get_wind_direction(ULTIMETER_handle_t* handle, int32_t* average_direction_degrees, ULTIMETER_wind_direction_status_t* direction_status);
+
+/*!******************************************************************
+ * \fn ULTIMETER_status_t ULTIMETER_get_wind_direction_statistics(ULTIMETER_handle_t* handle, ULTIMETER_wind_direction_statistics_t* direction_statistics)
+ * \brief Read wind direction statistics.
+ * \param[in]   handle: Pointer to the instance context.
+ * \param[out]  direction_statistics: Pointer to the structure that will contain the average direction, the mean resultant length (steadiness) and the Yamartino standard deviation since last reset.
+ * \retval      Function execution status.
+ *******************************************************************/
+ULTIMETER_status_t ULTIMETER_get_wind_direction_statistics(ULTIMETER_handle_t* handle, ULTIMETER_wind_direction_statistics_t* direction_statistics);
+#endif
+
+/*!******************************************************************
+ * \fn ULTIMETER_status_t ULTIMETER_get_snapshot(ULTIMETER_handle_t* handle, ULTIMETER_snapshot_t* snapshot)
+ * \brief Get all measurements of the last published window at once.
+ * \param[in]   handle: Pointer to the instance context.
+ * \param[out]  snapshot: Pointer to the snapshot structure.
+ * \retval      Function execution status.
+ * \note   Snapshots are double buffered and published by ULTIMETER_process(), so this function never blocks the producer and can be called from any context.
+ * \note   The copy is retried if a new snapshot is published meanwhile, ULTIMETER_ERROR_SNAPSHOT is returned if it never succeeds.
+ *******************************************************************/
+ULTIMETER_status_t ULTIMETER_get_snapshot(ULTIMETER_handle_t* handle, ULTIMETER_snapshot_t* snapshot);
+
+/*!******************************************************************
+ * \fn ULTIMETER_status_t ULTIMETER_reset_measurements(ULTIMETER_handle_t* handle)
+ * \brief Reset wind measurements.
+ * \param[in]   handle: Pointer to the instance context.
+ * \param[out]  none
+ * \retval      Function execution status.
+ *******************************************************************/
+ULTIMETER_status_t ULTIMETER_reset_measurements(ULTIMETER_handle_t* handle);
+
+/*!******************************************************************
+ * \fn ULTIMETER_status_t ULTIMETER_set_sampling_periods(ULTIMETER_handle_t* handle, uint32_t wind_speed_sampling_time_seconds, uint32_t wind_direction_sampling_period_seconds)
+ * \brief Set wind speed and direction sampling periods (default values are given by the compilation flags).
+ * \param[in]   handle: Pointer to the instance context.
+ * \param[in]   wind_speed_sampling_time_seconds: Time interval in seconds where the wind speed is evaluated (1 to 255).
+ * \param[in]   wind_direction_sampling_period_seconds: Wind direction reading period in seconds (ignored with ULTIMETER_DRIVER_WIND_SPEED_ONLY).
+ * \param[out]  none
+ * \retval      Function execution status.
+ * \note   The current wind speed window is closed as soon as its elapsed time reaches the new sampling time, its speed is computed with the elapsed time.
+ * \note   With ULTIMETER_DRIVER_TICKLESS, the new periods are used from the next alarm, which is never later than the end of the current windows.
+ * \note   With ULTIMETER_DRIVER_DUTY_CYCLE, ULTIMETER_ERROR_DUTY_CYCLE is returned if the bursts duration is not a multiple of the new sampling time.
+ *******************************************************************/
+ULTIMETER_status_t ULTIMETER_set_sampling_periods(ULTIMETER_handle_t* handle, uint32_t wind_speed_sampling_time_seconds, uint32_t wind_direction_sampling_period_seconds);
+
+#ifdef ULTIMETER_DRIVER_ADAPTIVE_SAMPLING
+/*!******************************************************************
+ * \fn ULTIMETER_status_t ULTIMETER_set_adaptive_sampling(ULTIMETER_handle_t* handle, ULTIMETER_adaptive_sampling_t* adaptive_sampling)
+ * \brief Enable or disable the adaptive sampling policy.
+ * \param[in]   handle: Pointer to the instance context.
+ * \param[in]   adaptive_sampling: Pointer to the policy parameters, NULL to disable the policy.
+ * \param[out]  none
+ * \retval      Function execution status.
+ * \note   With ULTIMETER_DRIVER_TICKLESS, the new sampling time is used from the next alarm.
+ * \note   With ULTIMETER_DRIVER_DUTY_CYCLE, the bursts duration must be a multiple of the minimum sampling time, and the policy keeps the current window instead of a length which does not divide the bursts.
+ *******************************************************************/
+ULTIMETER_status_t ULTIMETER_set_adaptive_sampling(ULTIMETER_handle_t* handle, ULTIMETER_adaptive_sampling_t* adaptive_sampling);
+#endif
+
+/*!******************************************************************
+ * \fn ULTIMETER_status_t ULTIMETER_get_next_deadline(ULTIMETER_handle_t* handle, uint32_t* delay_seconds)
+ * \brief Get the delay before the next wind speed or direction window end, where the driver has to be processed.
+ * \param[in]   handle: Pointer to the instance context.
+ * \param[out]  delay_seconds: Pointer to integer that will contain the delay in seconds.
+ * \retval      Function execution status.
+ *******************************************************************/
+ULTIMETER_status_t ULTIMETER_get_next_deadline(ULTIMETER_handle_t* handle, uint32_t* delay_seconds);
+
+#ifdef ULTIMETER_DRIVER_DUTY_CYCLE
+/*!******************************************************************
+ * \fn ULTIMETER_status_t ULTIMETER_set_duty_cycle(ULTIMETER_handle_t* handle, uint32_t burst_seconds, uint32_t period_seconds)
+ * \brief Set the measurement bursts schedule.
+ * \param[in]   handle: Pointer to the instance context.
+ * \param[in]   burst_seconds: Measurement duration in seconds at the beginning of each period (multiple of the wind speed sampling time).
+ * \param[in]   period_seconds: Bursts repetition period in seconds, 0 to measure continuously.
+ * \param[out]  none
+ * \retval      Function execution status.
+ * \note   The timer and edge interrupts are stopped between bursts and the windows are frozen, so that the statistics only contain complete windows measured during the bursts.
+ * \note   The schedule and the current windows restart with a burst.
+ * \note   The edges and the elapsed time of an incomplete wind speed window are discarded when the capture restarts.
+ *******************************************************************/
+ULTIMETER_status_t ULTIMETER_set_duty_cycle(ULTIMETER_handle_t* handle, uint32_t burst_seconds, uint32_t period_seconds);
+#endif
+
+#ifdef ULTIMETER_DRIVER_WIND_SPEED_RECIPROCAL
+/*!******************************************************************
+ * \fn ULTIMETER_status_t ULTIMETER_get_instantaneous_wind_gust(ULTIMETER_handle_t* handle, int32_t* gust_speed_mh)
+ * \brief Read instantaneous wind gust (fastest single rotation).
+ * \param[in]   handle: Pointer to the instance context.
+ * \param[out]  gust_speed_mh: Pointer to integer that will contain the instantaneous gust speed since last reset in m/h.
+ * \retval      Function execution status.
+ *******************************************************************/
+ULTIMETER_status_t ULTIMETER_get_instantaneous_wind_gust(ULTIMETER_handle_t* handle, int32_t* gust_speed_mh);
+#endif
+
+#ifdef ULTIMETER_DRIVER_DEBOUNCE_WIND_SPEED_MAX_MH
+/*!******************************************************************
+ * \fn ULTIMETER_status_t ULTIMETER_get_rejected_edge_count(ULTIMETER_handle_t* handle, uint32_t* rejected_edge_count, uint32_t* storm_count)
+ * \brief Read edges filter counters since last reset.
+ * \param[in]   handle: Pointer to the instance context.
+ * \param[out]  rejected_edge_count: Pointer to integer that will contain the number of edges rejected because they were closer than the rotation period at ULTIMETER_DRIVER_DEBOUNCE_WIND_SPEED_MAX_MH.
+ * \param[out]  storm_count: Pointer to integer that will contain the number of times the edge interrupts have been masked until the next tick (always 0 when ULTIMETER_DRIVER_DEBOUNCE_STORM_EDGES is undefined).
+ * \retval      Function execution status.
+ *******************************************************************/
+ULTIMETER_status_t ULTIMETER_get_rejected_edge_count(ULTIMETER_handle_t* handle, uint32_t* rejected_edge_count, uint32_t* storm_count);
+#endif
+
+#ifdef ULTIMETER_DRIVER_DIAGNOSTICS
+/*!******************************************************************
+ * \fn ULTIMETER_status_t ULTIMETER_get_diagnostics(ULTIMETER_handle_t* handle, ULTIMETER_diagnostics_t* diagnostics)
+ * \brief Read driver runtime diagnostics since init.
+ * \param[in]   handle: Pointer to the instance context.
+ * \param[out]  diagnostics: Pointer to the structure that will contain the callbacks counters, direction errors, missed ticks and execution times.
+ * \retval      Function execution status.
+ * \note   Execution times are measured with ULTIMETER_HW_get_cycle_counter().
+ *******************************************************************/
+ULTIMETER_status_t ULTIMETER_get_diagnostics(ULTIMETER_handle_t* handle, ULTIMETER_diagnostics_t* diagnostics);
+#endif
+
+#ifdef ULTIMETER_DRIVER_EDGE_BUFFER_SIZE
+/*!******************************************************************
+ * \fn ULTIMETER_status_t ULTIMETER_get_edge_buffer_overflow_count(ULTIMETER_handle_t* handle, uint32_t* overflow_count)
+ * \brief Read the number of edges lost because the deferred edge buffer was full.
+ * \param[in]   handle: Pointer to the instance context.
+ * \param[out]  overflow_count: Pointer to integer that will contain the number of lost edges since last reset.
+ * \retval      Function execution status.
+ *******************************************************************/
+ULTIMETER_status_t ULTIMETER_get_edge_buffer_overflow_count(ULTIMETER_handle_t* handle, uint32_t* overflow_count);
+#endif
+
+#ifdef ULTIMETER_DRIVER_SLIDING_WINDOW_LONG_SAMPLES
+/*!******************************************************************
+ * \fn ULTIMETER_status_t ULTIMETER_get_sliding_window_wind_speed(ULTIMETER_handle_t* handle, ULTIMETER_sliding_window_t window, int32_t* average_speed_mh)
+ * \brief Read wind average speed over a sliding window.
+ * \param[in]   handle: Pointer to the instance context.
+ * \param[in]   window: Sliding window to read.
+ * \param[out]  average_speed_mh: Pointer to integer that will contain the average wind speed over the last window samples in m/h.
+ * \retval      Function execution status.
+ *******************************************************************/
+ULTIMETER_status_t ULTIMETER_get_sliding_window_wind_speed(ULTIMETER_handle_t* handle, ULTIMETER_sliding_window_t window, int32_t* average_speed_mh);
+
+/*!******************************************************************
+ * \fn ULTIMETER_status_t ULTIMETER_get_sliding_window_wind_direction(ULTIMETER_handle_t* handle, ULTIMETER_sliding_window_t window, int32_t* average_direction_degrees, ULTIMETER_wind_direction_status_t* direction_status)
+ * \brief Read wind average direction over a sliding window.
+ * \param[in]   handle: Pointer to the instance context.
+ * \param[in]   window: Sliding window to read.
+ * \param[out]  average_direction_degrees: Pointer to integer that will contain the average wind direction over the last window samples in degrees.
+ * \param[out]  direction_status: Status of the output data.
+ * \retval      Function execution status.
+ * \note   Each sample is weighted by the number of rotations of its window, as for the average direction since last reset.
+ *******************************************************************/
+ULTIMETER_status_t ULTIMETER_get_sliding_window_wind_direction(ULTIMETER_handle_t* handle, ULTIMETER_sliding_window_t window, int32_t* average_direction_degrees, ULTIMETER_wind_direction_status_t* direction_status);
+
+/*!******************************************************************
+ * \fn ULTIMETER_status_t ULTIMETER_get_sliding_window_gust(ULTIMETER_handle_t* handle, int32_t* gust_speed_mh)
+ * \brief Read wind gust speed (maximum gust window average over the long sliding window).
+ * \param[in]   handle: Pointer to the instance context.
+ * \param[out]  gust_speed_mh: Pointer to integer that will contain the gust speed in m/h.
+ * \retval      Function execution status.
+ *******************************************************************/
+ULTIMETER_status_t ULTIMETER_get_sliding_window_gust(ULTIMETER_handle_t* handle, int32_t* gust_speed_mh);
+#endif
+
+#ifdef ULTIMETER_DRIVER_WIND_ROSE_SECTORS
+/*!******************************************************************
+ * \fn ULTIMETER_status_t ULTIMETER_get_wind_rose(ULTIMETER_handle_t* handle, uint8_t bits_per_counter, uint8_t* buffer, uint32_t buffer_size_bytes, uint32_t* data_size_bytes, uint16_t* full_scale_count)
+ * \brief Export the wind rose histogram as a bit-packed buffer.
+ * \param[in]   handle: Pointer to the instance context.
+ * \param[in]   bits_per_counter: Number of bits of each exported counter (1 to 16).
+ * \param[in]   buffer: Byte array that will contain the packed histogram.
+ * \param[in]   buffer_size_bytes: Size of the buffer in bytes.
+ * \param[out]  data_size_bytes: Pointer to integer that will contain the number of bytes written in the buffer.
+ * \param[out]  full_scale_count: Pointer to integer that will contain the number of wind speed windows corresponding to the maximum exported value.
+ * \retval      Function execution status.
+ * \note   Counters are packed MSB first: calm counter, then for each direction sector starting from north, each speed bin from the lowest.
+ * \note   Counters are scaled so that the full scale count (which is at least the maximum counter value) is mapped to (2^bits_per_counter - 1), non-zero counters are never exported as 0.
+ *******************************************************************/
+ULTIMETER_status_t ULTIMETER_get_wind_rose(ULTIMETER_handle_t* handle, uint8_t bits_per_counter, uint8_t* buffer, uint32_t buffer_size_bytes, uint32_t* data_size_bytes, uint16_t* full_scale_count);
 
 /*!******************************************************************
- * \fn void ULTIMETER_reset_measurements(void);
- * \brief Reset wind and rainfall measurements.
- * \param[in]   none
+ * \fn ULTIMETER_status_t ULTIMETER_reset_wind_rose(ULTIMETER_handle_t* handle)
+ * \brief Reset the wind rose histogram.
+ * \param[in]   handle: Pointer to the instance context.
+ * \retval      Function execution status.
+ *******************************************************************/
+ULTIMETER_status_t ULTIMETER_reset_wind_rose(ULTIMETER_handle_t* handle);
+#endif
+
+#ifdef ULTIMETER_DRIVER_RECORDER
+/*!******************************************************************
+ * \fn ULTIMETER_status_t ULTIMETER_set_recorder(ULTIMETER_handle_t* handle, ULTIMETER_RECORDER_t* recorder)
+ * \brief Record each wind speed window (speed, peak and direction).
+ * \param[in]   handle: Pointer to the instance context.
+ * \param[in]   recorder: Pointer to a recorder context initialized with ULTIMETER_RECORDER_init(), NULL to stop recording.
+ * \param[out]  none
+ * \retval      Function execution status.
+ * \note   Samples are appended by ULTIMETER_process(), the recorder must not be re-initialized while ULTIMETER_process() can be running.
+ *******************************************************************/
+ULTIMETER_status_t ULTIMETER_set_recorder(ULTIMETER_handle_t* handle, ULTIMETER_RECORDER_t* recorder);
+#endif
+
+#ifdef ULTIMETER_DRIVER_STATE
+/*!******************************************************************
+ * \fn ULTIMETER_status_t ULTIMETER_save_state(ULTIMETER_handle_t* handle, uint8_t* state, uint32_t state_size_bytes)
+ * \brief Serialize the measurements accumulators.
+ * \param[in]   handle: Pointer to the instance context.
+ * \param[in]   state: Byte array that will contain the state (at least ULTIMETER_STATE_SIZE_BYTES).
+ * \param[in]   state_size_bytes: Size of the state array in bytes.
  * \param[out]  none
- * \retval      none
+ * \retval      Function execution status.
+ * \note   The state contains the wind speed sums and peak, the direction trend point and the wind rose, in little endian order followed by a CRC16.
+ * \note   The current windows and the sliding windows are not saved.
  *******************************************************************/
-void ULTIMETER_reset_measurements(void);
+ULTIMETER_status_t ULTIMETER_save_state(ULTIMETER_handle_t* handle, uint8_t* state, uint32_t state_size_bytes);
+
+/*!******************************************************************
+ * \fn ULTIMETER_status_t ULTIMETER_restore_state(ULTIMETER_handle_t* handle, uint8_t* state, uint32_t state_size_bytes)
+ * \brief Restore the measurements accumulators saved with ULTIMETER_save_state().
+ * \param[in]   handle: Pointer to the instance context.
+ * \param[in]   state: Byte array containing the state.
+ * \param[in]   state_size_bytes: Size of the state array in bytes.
+ * \param[out]  none
+ * \retval      Function execution status.
+ * \note   The function must be called after ULTIMETER_init() and from the same context as ULTIMETER_process().
+ * \note   The accumulators are not modified if the state is corrupted or has been saved by a driver with another version, options or wind rose dimensions.
+ *******************************************************************/
+ULTIMETER_status_t ULTIMETER_restore_state(ULTIMETER_handle_t* handle, uint8_t* state, uint32_t state_size_bytes);
+#endif
+
+#ifdef ULTIMETER_DRIVER_SINK_BATCH_RECORDS
+/*!******************************************************************
+ * \fn ULTIMETER_status_t ULTIMETER_flush_sink(ULTIMETER_handle_t* handle)
+ * \brief Give the pending window records to the sink callback before the batch is full.
+ * \param[in]   handle: Pointer to the instance context.
+ * \param[out]  none
+ * \retval      Function execution status.
+ * \note   The function must be called from the same context as ULTIMETER_process(), for example before entering a low power mode.
+ * \note   Pending records are also flushed when the wind measurement is stopped.
+ *******************************************************************/
+ULTIMETER_status_t ULTIMETER_flush_sink(ULTIMETER_handle_t* handle);
+#endif
 
 /*******************************************************************/
 #define ULTIMETER_exit_error(base) { ERROR_check_exit(ultimeter_status, ULTIMETER_SUCCESS, base) }
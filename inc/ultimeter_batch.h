@@ -0,0 +1,82 @@
+/*
+ * ultimeter_batch.h
+ *
+ *  Created on: 17 oct. 2026
+ *      Author: Ludo
+ */
+
+#ifndef __ULTIMETER_BATCH_H__
+#define __ULTIMETER_BATCH_H__
+
+#ifndef ULTIMETER_DRIVER_DISABLE_FLAGS_FILE
+#include "ultimeter_driver_flags.h"
+#endif
+#include "ultimeter.h"
+#include "types.h"
+
+#ifndef ULTIMETER_DRIVER_DISABLE
+#ifdef ULTIMETER_DRIVER_BATCH
+
+/*** ULTIMETER BATCH structures ***/
+
+/*!******************************************************************
+ * \struct ULTIMETER_BATCH_input_t
+ * \brief ULTIMETER batch edges trace.
+ * \note   Timestamps are the raw timer counter values captured on each edge, sorted in chronological order and not older than start_counter.
+ * \note   Counter wrap is supported as long as the processed windows span less than 2^32 timer counter periods, longer traces must be split in several calls.
+ *******************************************************************/
+typedef struct {
+    uint32_t* wind_speed_edge_timestamps;
+    uint32_t wind_speed_edge_count;
+    uint32_t* wind_direction_edge_timestamps;
+    uint32_t wind_direction_edge_count;
+    uint32_t start_counter;
+    uint32_t timer_frequency_hz;
+    uint32_t wind_speed_sampling_time_seconds;
+    uint32_t wind_direction_sampling_period_seconds;
+} ULTIMETER_BATCH_input_t;
+
+/*!******************************************************************
+ * \struct ULTIMETER_BATCH_output_t
+ * \brief ULTIMETER batch results, one entry per wind speed window in each array.
+ * \note   peak_wind_speed_mh is the fastest rotation of the window (or the window speed if higher) with ULTIMETER_DRIVER_WIND_SPEED_RECIPROCAL, the window speed otherwise.
+ * \note   trend_point_x and trend_point_y are the wind vectors added to the direction trend point by ULTIMETER_process() at the end of the window.
+ * \note   With ULTIMETER_DRIVER_WIND_DIRECTION_PER_ROTATION, they are the sum of the unit vectors of all the rotations of the window.
+ *******************************************************************/
+typedef struct {
+    uint32_t* wind_speed_mh;
+    uint32_t* peak_wind_speed_mh;
+    int32_t* wind_direction_degrees;
+    ULTIMETER_wind_direction_status_t* direction_status;
+    int64_t* trend_point_x;
+    int64_t* trend_point_y;
+} ULTIMETER_BATCH_output_t;
+
+/*** ULTIMETER BATCH functions ***/
+
+/*!******************************************************************
+ * \fn ULTIMETER_status_t ULTIMETER_BATCH_process(ULTIMETER_BATCH_input_t* input, ULTIMETER_BATCH_output_t* output, uint32_t window_count)
+ * \brief Compute the wind measurements of a recorded edges trace.
+ * \param[in]   input: Pointer to the edges trace.
+ * \param[in]   window_count: Number of wind speed windows to compute from the trace start.
+ * \param[out]  output: Pointer to the results arrays (window_count entries each).
+ * \retval      Function execution status.
+ * \note   The function has no internal state and can be called from several threads. Results are identical to the values computed by ULTIMETER_process() on the same edges.
+ *******************************************************************/
+ULTIMETER_status_t ULTIMETER_BATCH_process(ULTIMETER_BATCH_input_t* input, ULTIMETER_BATCH_output_t* output, uint32_t window_count);
+
+/*!******************************************************************
+ * \fn ULTIMETER_status_t ULTIMETER_BATCH_get_wind_direction(ULTIMETER_BATCH_output_t* output, uint32_t window_count, int32_t* average_direction_degrees, ULTIMETER_wind_direction_status_t* direction_status)
+ * \brief Compute the average wind direction of several windows.
+ * \param[in]   output: Pointer to the results of ULTIMETER_BATCH_process().
+ * \param[in]   window_count: Number of windows to average.
+ * \param[out]  average_direction_degrees: Pointer to integer that will contain the average wind direction in degrees.
+ * \param[out]  direction_status: Pointer to the direction status.
+ * \retval      Function execution status.
+ *******************************************************************/
+ULTIMETER_status_t ULTIMETER_BATCH_get_wind_direction(ULTIMETER_BATCH_output_t* output, uint32_t window_count, int32_t* average_direction_degrees, ULTIMETER_wind_direction_status_t* direction_status);
+
+#endif /* ULTIMETER_DRIVER_BATCH */
+#endif /* ULTIMETER_DRIVER_DISABLE */
+
+#endif /* __ULTIMETER_BATCH_H__ */
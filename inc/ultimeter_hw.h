@@ -22,19 +22,22 @@
  * \fn ULTIMETER_HW_gpio_edge_irq_cb_t
  * \brief GPIO edge interrupt callback.
  *******************************************************************/
-typedef void (*ULTIMETER_HW_gpio_edge_irq_cb_t)(void);
+typedef void (*ULTIMETER_HW_gpio_edge_irq_cb_t)(ULTIMETER_handle_t* handle);
 
 /*!******************************************************************
  * \fn ULTIMETER_HW_tick_second_irq_cb_t
  * \brief 1 second timer interrupt callback.
+ * \note  When ULTIMETER_DRIVER_TICKLESS is defined, this callback must be called when the alarm programmed with ULTIMETER_HW_set_alarm() expires.
  *******************************************************************/
-typedef void (*ULTIMETER_HW_tick_second_irq_cb_t)(void);
+typedef void (*ULTIMETER_HW_tick_second_irq_cb_t)(ULTIMETER_handle_t* handle);
 
 /*!******************************************************************
  * \struct ULTIMETER_HW_configuration_t
  * \brief ULTIMETER hardware interface parameters.
+ * \note   The hardware interface must give the handle back as argument of each callback.
  *******************************************************************/
 typedef struct {
+    ULTIMETER_handle_t* handle;
     ULTIMETER_HW_gpio_edge_irq_cb_t wind_speed_edge_irq_callback;
     ULTIMETER_HW_gpio_edge_irq_cb_t wind_direction_edge_irq_callback;
     ULTIMETER_HW_tick_second_irq_cb_t tick_second_irq_callback;
@@ -43,58 +46,123 @@ typedef struct {
 /*** ULTIMETER HW functions ***/
 
 /*!******************************************************************
- * \fn ULTIMETER_status_t ULTIMETER_HW_init(ULTIMETER_HW_configuration_t* configuration)
+ * \fn ULTIMETER_status_t ULTIMETER_HW_init(uint8_t instance, ULTIMETER_HW_configuration_t* configuration)
  * \brief Init ULTIMETER hardware interface.
+ * \param[in]   instance: Hardware instance to use.
  * \param[in]   configuration: Pointer to the hardware interface parameters structure.
  * \param[out]  none
  * \retval      Function execution status.
  *******************************************************************/
-ULTIMETER_status_t ULTIMETER_HW_init(ULTIMETER_HW_configuration_t* configuration);
+ULTIMETER_status_t ULTIMETER_HW_init(uint8_t instance, ULTIMETER_HW_configuration_t* configuration);
 
 /*!******************************************************************
- * \fn ULTIMETER_status_t ULTIMETER_HW_de_init(void)
+ * \fn ULTIMETER_status_t ULTIMETER_HW_de_init(uint8_t instance)
  * \brief Release ULTIMETER hardware interface.
- * \param[in]   none
+ * \param[in]   instance: Hardware instance to release.
  * \param[out]  none
  * \retval      Function execution status.
  *******************************************************************/
-ULTIMETER_status_t ULTIMETER_HW_de_init(void);
+ULTIMETER_status_t ULTIMETER_HW_de_init(uint8_t instance);
 
 /*!******************************************************************
- * \fn ULTIMETER_status_t ULTIMETER_HW_set_wind_speed_direction_interrupts(uint8_t enable)
+ * \fn ULTIMETER_status_t ULTIMETER_HW_set_wind_speed_direction_interrupts(uint8_t instance, uint8_t enable)
  * \brief Set wind speed and direction interrupts state.
+ * \param[in]   instance: Hardware instance to control.
  * \param[in]   enable: Disable (0) or enable (otherwise) the wind speed and direction GPIOs interrupts.
  * \param[out]  none
  * \retval      Function execution status.
+ * \note   When ULTIMETER_DRIVER_DEBOUNCE_STORM_EDGES is defined, this function is also called from the edge and tick interrupts.
  *******************************************************************/
-ULTIMETER_status_t ULTIMETER_HW_set_wind_speed_direction_interrupts(uint8_t enable);
+ULTIMETER_status_t ULTIMETER_HW_set_wind_speed_direction_interrupts(uint8_t instance, uint8_t enable);
 
 /*!******************************************************************
- * \fn ULTIMETER_status_t ULTIMETER_HW_timer_start(void)
+ * \fn ULTIMETER_status_t ULTIMETER_HW_timer_start(uint8_t instance)
  * \brief Start timer.
- * \param[in]   none
+ * \param[in]   instance: Hardware instance to control.
  * \param[out]  none
  * \retval      Function execution status.
  *******************************************************************/
-ULTIMETER_status_t ULTIMETER_HW_timer_start(void);
+ULTIMETER_status_t ULTIMETER_HW_timer_start(uint8_t instance);
 
 /*!******************************************************************
- * \fn ULTIMETER_status_t ULTIMETER_HW_timer_stop(void)
+ * \fn ULTIMETER_status_t ULTIMETER_HW_timer_stop(uint8_t instance)
  * \brief Stop timer.
- * \param[in]   none
+ * \param[in]   instance: Hardware instance to control.
  * \param[out]  none
  * \retval      Function execution status.
  *******************************************************************/
-ULTIMETER_status_t ULTIMETER_HW_timer_stop(void);
+ULTIMETER_status_t ULTIMETER_HW_timer_stop(uint8_t instance);
 
 /*!******************************************************************
- * \fn uint32_t ULTIMETER_HW_timer_get_counter(void)
+ * \fn uint32_t ULTIMETER_HW_timer_get_counter(uint8_t instance)
  * \brief Get timer counter.
- * \param[in]   none
+ * \param[in]   instance: Hardware instance to read.
  * \param[out]  none
  * \retval      Current counter value.
  *******************************************************************/
-uint32_t ULTIMETER_HW_timer_get_counter(void);
+uint32_t ULTIMETER_HW_timer_get_counter(uint8_t instance);
+
+/*!******************************************************************
+ * \fn uint8_t ULTIMETER_HW_timer_get_counter_width(uint8_t instance)
+ * \brief Get timer counter width.
+ * \param[in]   instance: Hardware instance to read.
+ * \param[out]  none
+ * \retval      Number of bits of the timer counter (8 to 32), the driver extends narrower counters in software.
+ *******************************************************************/
+uint8_t ULTIMETER_HW_timer_get_counter_width(uint8_t instance);
+
+/*!******************************************************************
+ * \fn uint32_t ULTIMETER_HW_timer_get_frequency_hz(uint8_t instance)
+ * \brief Get timer counter frequency.
+ * \param[in]   instance: Hardware instance to read.
+ * \param[out]  none
+ * \retval      Timer counter frequency in Hz.
+ *******************************************************************/
+uint32_t ULTIMETER_HW_timer_get_frequency_hz(uint8_t instance);
+
+/*!******************************************************************
+ * \fn void ULTIMETER_HW_enter_critical(uint8_t instance)
+ * \brief Enter a critical section where the edge and tick interrupts can not preempt the caller.
+ * \param[in]   instance: Hardware instance to control.
+ * \param[out]  none
+ * \retval      none
+ * \note   The driver never nests critical sections and only keeps them for a few instructions (e.g. PRIMASK save and disable on Cortex-M).
+ * \note   The default implementation is empty, which is only correct when all the driver interrupts have the same priority level.
+ *******************************************************************/
+void ULTIMETER_HW_enter_critical(uint8_t instance);
+
+/*!******************************************************************
+ * \fn void ULTIMETER_HW_exit_critical(uint8_t instance)
+ * \brief Leave the critical section entered with ULTIMETER_HW_enter_critical().
+ * \param[in]   instance: Hardware instance to control.
+ * \param[out]  none
+ * \retval      none
+ *******************************************************************/
+void ULTIMETER_HW_exit_critical(uint8_t instance);
+
+#ifdef ULTIMETER_DRIVER_TICKLESS
+/*!******************************************************************
+ * \fn ULTIMETER_status_t ULTIMETER_HW_set_alarm(uint8_t instance, uint32_t delay_seconds)
+ * \brief Program a one-shot alarm which will call the tick callback.
+ * \param[in]   instance: Hardware instance to control.
+ * \param[in]   delay_seconds: Alarm delay in seconds, 0 to cancel the alarm.
+ * \param[out]  none
+ * \retval      Function execution status.
+ * \note   With ULTIMETER_DRIVER_DUTY_CYCLE, the alarm must keep running when the timer is stopped, since it wakes the driver up at the beginning of the next burst.
+ *******************************************************************/
+ULTIMETER_status_t ULTIMETER_HW_set_alarm(uint8_t instance, uint32_t delay_seconds);
+#endif
+
+#ifdef ULTIMETER_DRIVER_DIAGNOSTICS
+/*!******************************************************************
+ * \fn uint32_t ULTIMETER_HW_get_cycle_counter(uint8_t instance)
+ * \brief Read a free running cycle counter (e.g. DWT cycle counter or high frequency timer) used to measure the driver execution time.
+ * \param[in]   instance: Hardware instance to read.
+ * \param[out]  none
+ * \retval      Current cycle counter value (full 32-bit wrap).
+ *******************************************************************/
+uint32_t ULTIMETER_HW_get_cycle_counter(uint8_t instance);
+#endif
 
 #endif /* ULTIMETER_DRIVER_DISABLE */
 
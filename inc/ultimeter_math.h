@@ -0,0 +1,152 @@
+/*
+ * ultimeter_math.h
+ *
+ *  Created on: 17 oct. 2026
+ *      Author: Ludo
+ */
+
+#ifndef __ULTIMETER_MATH_H__
+#define __ULTIMETER_MATH_H__
+
+#ifndef ULTIMETER_DRIVER_DISABLE_FLAGS_FILE
+#include "ultimeter_driver_flags.h"
+#endif
+#include "maths.h"
+#include "ultimeter.h"
+#include "types.h"
+
+#ifndef ULTIMETER_DRIVER_DISABLE
+
+/*** ULTIMETER MATH macros ***/
+
+#define ULTIMETER_WIND_SPEED_1HZ_TO_MH          5400
+
+#define ULTIMETER_WIND_DIRECTION_ERROR_VALUE    0xFFFFFFFF
+
+#if (ULTIMETER_DRIVER_WIND_DIRECTION_RESOLUTION == 0)
+#error "ULTIMETER driver: ULTIMETER_DRIVER_WIND_DIRECTION_RESOLUTION must not be 0"
+#endif
+#define ULTIMETER_WIND_DIRECTION_FULL_TURN      (MATH_2_PI_DEGREES * ULTIMETER_DRIVER_WIND_DIRECTION_RESOLUTION)
+
+/*** ULTIMETER MATH functions ***/
+
+/*!******************************************************************
+ * \fn uint32_t ULTIMETER_MATH_compute_wind_speed_mh(uint32_t edge_count, uint32_t sampling_time_seconds)
+ * \brief Compute the wind speed from the number of rotations counted during a window.
+ * \param[in]   edge_count: Number of wind speed edges of the window.
+ * \param[in]   sampling_time_seconds: Window duration in seconds.
+ * \param[out]  none
+ * \retval      Wind speed in m/h.
+ *******************************************************************/
+uint32_t ULTIMETER_MATH_compute_wind_speed_mh(uint32_t edge_count, uint32_t sampling_time_seconds);
+
+/*!******************************************************************
+ * \fn uint32_t ULTIMETER_MATH_compute_rotation_speed_mh(uint32_t period_count, uint64_t period_sum, uint32_t timer_frequency_hz)
+ * \brief Compute the wind speed from measured rotation periods.
+ * \param[in]   period_count: Number of rotation periods.
+ * \param[in]   period_sum: Sum of the rotation periods in timer counter units (64 bits since a long window of a fast timer exceeds 32 bits).
+ * \param[in]   timer_frequency_hz: Timer counter frequency in Hz.
+ * \param[out]  none
+ * \retval      Wind speed in m/h.
+ *******************************************************************/
+uint32_t ULTIMETER_MATH_compute_rotation_speed_mh(uint32_t period_count, uint64_t period_sum, uint32_t timer_frequency_hz);
+
+/*!******************************************************************
+ * \fn void ULTIMETER_MATH_compute_window_speed_mh(uint32_t edge_count, uint32_t sampling_time_seconds, uint32_t period_count, uint64_t period_sum, uint32_t period_min, uint32_t timer_frequency_hz, uint32_t* wind_speed_mh, uint32_t* peak_wind_speed_mh)
+ * \brief Compute the average and peak wind speeds of a closed window.
+ * \param[in]   edge_count: Number of wind speed edges of the window.
+ * \param[in]   sampling_time_seconds: Window duration in seconds (must not be 0).
+ * \param[in]   period_count: Number of complete rotation periods of the window (ignored without ULTIMETER_DRIVER_WIND_SPEED_RECIPROCAL).
+ * \param[in]   period_sum: Sum of the rotation periods in timer counter units.
+ * \param[in]   period_min: Shortest rotation period in timer counter units.
+ * \param[in]   timer_frequency_hz: Timer counter frequency in Hz.
+ * \param[out]  wind_speed_mh: Pointer to the window average wind speed in m/h.
+ * \param[out]  peak_wind_speed_mh: Pointer to the window peak wind speed in m/h.
+ * \retval      none
+ * \note   Shared by the driver and the batch API so that both give the same results.
+ *******************************************************************/
+void ULTIMETER_MATH_compute_window_speed_mh(uint32_t edge_count, uint32_t sampling_time_seconds, uint32_t period_count, uint64_t period_sum, uint32_t period_min, uint32_t timer_frequency_hz, uint32_t* wind_speed_mh, uint32_t* peak_wind_speed_mh);
+
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+/*!******************************************************************
+ * \fn uint32_t ULTIMETER_MATH_compute_wind_direction_angle(uint32_t wind_direction_duty_cycle, uint32_t wind_direction_period)
+ * \brief Compute the wind direction of a rotation.
+ * \param[in]   wind_direction_duty_cycle: Time between the rotation start and the direction edge in timer counter units.
+ * \param[in]   wind_direction_period: Rotation period in timer counter units (must not be 0).
+ * \param[out]  none
+ * \retval      Wind direction in ULTIMETER_DRIVER_WIND_DIRECTION_RESOLUTION steps per degree.
+ *******************************************************************/
+uint32_t ULTIMETER_MATH_compute_wind_direction_angle(uint32_t wind_direction_duty_cycle, uint32_t wind_direction_period);
+
+#ifdef ULTIMETER_DRIVER_WIND_DIRECTION_RECIPROCAL
+/*!******************************************************************
+ * \fn void ULTIMETER_MATH_refine_wind_direction_reciprocal(uint32_t wind_direction_period, uint32_t* reciprocal, uint8_t* shift)
+ * \brief Refine the reciprocal of a rotation period with Newton-Raphson iterations.
+ * \param[in]   wind_direction_period: Rotation period in timer counter units (must not be 0).
+ * \param[in]   reciprocal: Pointer to the previous reciprocal, used as seed when the period has the same magnitude (0 to start from the fixed seed).
+ * \param[in]   shift: Pointer to the normalization shift of the previous reciprocal.
+ * \param[out]  reciprocal: Pointer to the reciprocal of the normalized period (2^63 / (period << shift)).
+ * \param[out]  shift: Pointer to the normalization shift of the period.
+ * \retval      none
+ *******************************************************************/
+void ULTIMETER_MATH_refine_wind_direction_reciprocal(uint32_t wind_direction_period, uint32_t* reciprocal, uint8_t* shift);
+
+/*!******************************************************************
+ * \fn uint32_t ULTIMETER_MATH_compute_wind_direction_angle_reciprocal(uint32_t wind_direction_duty_cycle, uint32_t wind_direction_period, uint32_t reciprocal, uint8_t shift)
+ * \brief Compute the wind direction of a rotation with a multiplication by the period reciprocal.
+ * \param[in]   wind_direction_duty_cycle: Time between the rotation start and the direction edge in timer counter units.
+ * \param[in]   wind_direction_period: Rotation period in timer counter units (must not be 0).
+ * \param[in]   reciprocal: Reciprocal given by ULTIMETER_MATH_refine_wind_direction_reciprocal(), possibly for a slightly different period.
+ * \param[in]   shift: Normalization shift of the reciprocal.
+ * \param[out]  none
+ * \retval      Wind direction in ULTIMETER_DRIVER_WIND_DIRECTION_RESOLUTION steps per degree.
+ * \note   The result is identical to ULTIMETER_MATH_compute_wind_direction_angle(), which is used when the quotient can not be corrected with 4 multiplications.
+ *******************************************************************/
+uint32_t ULTIMETER_MATH_compute_wind_direction_angle_reciprocal(uint32_t wind_direction_duty_cycle, uint32_t wind_direction_period, uint32_t reciprocal, uint8_t shift);
+#endif
+
+/*!******************************************************************
+ * \fn int32_t ULTIMETER_MATH_get_wind_direction_degrees(uint32_t wind_direction_angle)
+ * \brief Round a wind direction to the closest degree.
+ * \param[in]   wind_direction_angle: Wind direction in ULTIMETER_DRIVER_WIND_DIRECTION_RESOLUTION steps per degree.
+ * \param[out]  none
+ * \retval      Wind direction in degrees.
+ *******************************************************************/
+int32_t ULTIMETER_MATH_get_wind_direction_degrees(uint32_t wind_direction_angle);
+
+/*!******************************************************************
+ * \fn void ULTIMETER_MATH_get_unit_vector(uint32_t wind_direction_angle, int32_t* x, int32_t* y)
+ * \brief Get the unit vector of a wind direction.
+ * \param[in]   wind_direction_angle: Wind direction in ULTIMETER_DRIVER_WIND_DIRECTION_RESOLUTION steps per degree.
+ * \param[out]  x: Pointer to the vector abscissa (trigonometric tables scale).
+ * \param[out]  y: Pointer to the vector ordinate (trigonometric tables scale).
+ * \retval      none
+ *******************************************************************/
+void ULTIMETER_MATH_get_unit_vector(uint32_t wind_direction_angle, int32_t* x, int32_t* y);
+
+/*!******************************************************************
+ * \fn uint8_t ULTIMETER_MATH_scale_trend_point(int64_t* trend_point_x, int64_t* trend_point_y)
+ * \brief Scale down trend point coordinates to 31 bits.
+ * \param[in]   trend_point_x: Pointer to the trend point abscissa.
+ * \param[in]   trend_point_y: Pointer to the trend point ordinate.
+ * \param[out]  trend_point_x: Pointer to the scaled abscissa.
+ * \param[out]  trend_point_y: Pointer to the scaled ordinate.
+ * \retval      Number of right shifts applied to the coordinates.
+ *******************************************************************/
+uint8_t ULTIMETER_MATH_scale_trend_point(int64_t* trend_point_x, int64_t* trend_point_y);
+
+/*!******************************************************************
+ * \fn ULTIMETER_status_t ULTIMETER_MATH_compute_trend_point_angle(int64_t trend_point_x, int64_t trend_point_y, int32_t* average_direction_degrees, ULTIMETER_wind_direction_status_t* direction_status)
+ * \brief Compute the direction of a sum of wind vectors.
+ * \param[in]   trend_point_x: Trend point abscissa.
+ * \param[in]   trend_point_y: Trend point ordinate.
+ * \param[out]  average_direction_degrees: Pointer to integer that will contain the average wind direction in degrees.
+ * \param[out]  direction_status: Pointer to the direction status (undefined when the trend point is the origin).
+ * \retval      Function execution status.
+ *******************************************************************/
+ULTIMETER_status_t ULTIMETER_MATH_compute_trend_point_angle(int64_t trend_point_x, int64_t trend_point_y, int32_t* average_direction_degrees, ULTIMETER_wind_direction_status_t* direction_status);
+#endif
+
+#endif /* ULTIMETER_DRIVER_DISABLE */
+
+#endif /* __ULTIMETER_MATH_H__ */
@@ -0,0 +1,108 @@
+/*
+ * ultimeter_recorder.h
+ *
+ *  Created on: 17 oct. 2026
+ *      Author: Ludo
+ */
+
+#ifndef __ULTIMETER_RECORDER_H__
+#define __ULTIMETER_RECORDER_H__
+
+#ifndef ULTIMETER_DRIVER_DISABLE_FLAGS_FILE
+#include "ultimeter_driver_flags.h"
+#endif
+#include "ultimeter.h"
+#include "types.h"
+
+#ifndef ULTIMETER_DRIVER_DISABLE
+#ifdef ULTIMETER_DRIVER_RECORDER
+
+/*** ULTIMETER RECORDER structures ***/
+
+/*!******************************************************************
+ * \struct ULTIMETER_RECORDER_sample_t
+ * \brief ULTIMETER recorder wind speed window sample.
+ * \note   Speeds are recorded with a 100 m/h resolution and direction with a 1 degree resolution.
+ *******************************************************************/
+typedef struct {
+    uint32_t wind_speed_mh;
+    uint32_t peak_wind_speed_mh;
+    int32_t wind_direction_degrees;
+    ULTIMETER_wind_direction_status_t direction_status;
+} ULTIMETER_RECORDER_sample_t;
+
+/*!******************************************************************
+ * \struct ULTIMETER_RECORDER_s
+ * \brief ULTIMETER recorder context.
+ * \note   The same structure is used to record samples (ULTIMETER_RECORDER_init() and ULTIMETER_RECORDER_append()) or to read them back (ULTIMETER_RECORDER_open() and ULTIMETER_RECORDER_read()).
+ * \note   Each sample is encoded with exponential-Golomb codes: speed difference with the previous sample, peak excess over speed, direction validity bit and direction difference with the previous valid direction.
+ *******************************************************************/
+struct ULTIMETER_RECORDER_s {
+    uint8_t* buffer;
+    uint32_t size_bits;
+    uint32_t bit_index;
+    uint32_t sample_count;
+    uint32_t overflow_count;
+    uint32_t wind_speed_last;
+    uint32_t wind_direction_degrees_last;
+};
+
+/*** ULTIMETER RECORDER functions ***/
+
+/*!******************************************************************
+ * \fn ULTIMETER_status_t ULTIMETER_RECORDER_init(ULTIMETER_RECORDER_t* recorder, uint8_t* buffer, uint32_t buffer_size_bytes)
+ * \brief Start a new record.
+ * \param[in]   recorder: Pointer to the recorder context.
+ * \param[in]   buffer: Byte array that will contain the encoded samples.
+ * \param[in]   buffer_size_bytes: Size of the buffer in bytes.
+ * \param[out]  none
+ * \retval      Function execution status.
+ *******************************************************************/
+ULTIMETER_status_t ULTIMETER_RECORDER_init(ULTIMETER_RECORDER_t* recorder, uint8_t* buffer, uint32_t buffer_size_bytes);
+
+/*!******************************************************************
+ * \fn ULTIMETER_status_t ULTIMETER_RECORDER_append(ULTIMETER_RECORDER_t* recorder, ULTIMETER_RECORDER_sample_t* sample)
+ * \brief Encode a new sample at the end of the record.
+ * \param[in]   recorder: Pointer to the recorder context.
+ * \param[in]   sample: Pointer to the sample to record.
+ * \param[out]  none
+ * \retval      Function execution status.
+ * \note   When the sample does not fit in the remaining space, the record is left unchanged, the overflow counter is incremented and ULTIMETER_ERROR_RECORDER_FULL is returned.
+ *******************************************************************/
+ULTIMETER_status_t ULTIMETER_RECORDER_append(ULTIMETER_RECORDER_t* recorder, ULTIMETER_RECORDER_sample_t* sample);
+
+/*!******************************************************************
+ * \fn ULTIMETER_status_t ULTIMETER_RECORDER_get_data_size(ULTIMETER_RECORDER_t* recorder, uint32_t* data_size_bits, uint32_t* sample_count, uint32_t* overflow_count)
+ * \brief Get the current record size.
+ * \param[in]   recorder: Pointer to the recorder context.
+ * \param[out]  data_size_bits: Pointer to integer that will contain the number of bits written in the buffer.
+ * \param[out]  sample_count: Pointer to integer that will contain the number of recorded samples.
+ * \param[out]  overflow_count: Pointer to integer that will contain the number of samples dropped because the buffer was full.
+ * \retval      Function execution status.
+ *******************************************************************/
+ULTIMETER_status_t ULTIMETER_RECORDER_get_data_size(ULTIMETER_RECORDER_t* recorder, uint32_t* data_size_bits, uint32_t* sample_count, uint32_t* overflow_count);
+
+/*!******************************************************************
+ * \fn ULTIMETER_status_t ULTIMETER_RECORDER_open(ULTIMETER_RECORDER_t* recorder, uint8_t* buffer, uint32_t data_size_bits)
+ * \brief Open a record in order to decode it.
+ * \param[in]   recorder: Pointer to the recorder context.
+ * \param[in]   buffer: Byte array containing the encoded samples.
+ * \param[in]   data_size_bits: Number of valid bits in the buffer (zero padding bits at the end of the record are ignored, so the size in bytes multiplied by 8 can be used).
+ * \param[out]  none
+ * \retval      Function execution status.
+ *******************************************************************/
+ULTIMETER_status_t ULTIMETER_RECORDER_open(ULTIMETER_RECORDER_t* recorder, uint8_t* buffer, uint32_t data_size_bits);
+
+/*!******************************************************************
+ * \fn ULTIMETER_status_t ULTIMETER_RECORDER_read(ULTIMETER_RECORDER_t* recorder, ULTIMETER_RECORDER_sample_t* sample)
+ * \brief Decode the next sample of an opened record.
+ * \param[in]   recorder: Pointer to the recorder context.
+ * \param[out]  sample: Pointer to the decoded sample.
+ * \retval      Function execution status (ULTIMETER_ERROR_RECORDER_END when all samples have been read).
+ *******************************************************************/
+ULTIMETER_status_t ULTIMETER_RECORDER_read(ULTIMETER_RECORDER_t* recorder, ULTIMETER_RECORDER_sample_t* sample);
+
+#endif /* ULTIMETER_DRIVER_RECORDER */
+#endif /* ULTIMETER_DRIVER_DISABLE */
+
+#endif /* __ULTIMETER_RECORDER_H__ */
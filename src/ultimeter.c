@@ -13,260 +13,2341 @@
 #include "error.h"
 #include "maths.h"
 #include "ultimeter_hw.h"
+#include "ultimeter_math.h"
+#include "ultimeter_recorder.h"
 #include "types.h"
 
 #ifndef ULTIMETER_DRIVER_DISABLE
 
 /*** ULTIMETER local macros ***/
 
-#define ULTIMETER_WIND_SPEED_1HZ_TO_MH          5400
+#define ULTIMETER_YAMARTINO_FACTOR              1547
+#define ULTIMETER_YAMARTINO_FACTOR_SCALE        10000
 
-#define ULTIMETER_WIND_DIRECTION_ERROR_VALUE    0xFFFFFFFF
+#define ULTIMETER_WIND_SPEED_SAMPLING_TIME_SECONDS_MAX  255
+
+#define ULTIMETER_TIMER_COUNTER_WIDTH_MIN       8
+#define ULTIMETER_TIMER_COUNTER_WIDTH_MAX       32
+
+#define ULTIMETER_SNAPSHOT_READ_RETRY_MAX       4
+
+#ifdef ULTIMETER_DRIVER_STATE
+#define ULTIMETER_STATE_CRC16_POLYNOMIAL        0x1021
+#define ULTIMETER_STATE_CRC16_INIT              0xFFFF
+// Options which change the state content.
+#define ULTIMETER_STATE_OPTION_WIND_SPEED_RECIPROCAL        0x01
+#define ULTIMETER_STATE_OPTION_WIND_DIRECTION_PER_ROTATION  0x02
+#define ULTIMETER_STATE_OPTION_WIND_ROSE                    0x04
+#define ULTIMETER_STATE_OPTION_WIND_SPEED_ONLY              0x08
+#ifdef ULTIMETER_DRIVER_WIND_SPEED_RECIPROCAL
+#define ULTIMETER_STATE_OPTION_1                ULTIMETER_STATE_OPTION_WIND_SPEED_RECIPROCAL
+#else
+#define ULTIMETER_STATE_OPTION_1                0
+#endif
+#ifdef ULTIMETER_DRIVER_WIND_DIRECTION_PER_ROTATION
+#define ULTIMETER_STATE_OPTION_2                ULTIMETER_STATE_OPTION_WIND_DIRECTION_PER_ROTATION
+#else
+#define ULTIMETER_STATE_OPTION_2                0
+#endif
+#ifdef ULTIMETER_DRIVER_WIND_ROSE_SECTORS
+#define ULTIMETER_STATE_OPTION_3                ULTIMETER_STATE_OPTION_WIND_ROSE
+#else
+#define ULTIMETER_STATE_OPTION_3                0
+#endif
+#ifdef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+#define ULTIMETER_STATE_OPTION_4                ULTIMETER_STATE_OPTION_WIND_SPEED_ONLY
+#else
+#define ULTIMETER_STATE_OPTION_4                0
+#endif
+#define ULTIMETER_STATE_OPTIONS                 (ULTIMETER_STATE_OPTION_1 | ULTIMETER_STATE_OPTION_2 | ULTIMETER_STATE_OPTION_3 | ULTIMETER_STATE_OPTION_4)
+#ifdef ULTIMETER_DRIVER_WIND_ROSE_SECTORS
+#define ULTIMETER_STATE_WIND_ROSE_SECTORS       ULTIMETER_DRIVER_WIND_ROSE_SECTORS
+#define ULTIMETER_STATE_WIND_ROSE_SPEED_BINS    ULTIMETER_DRIVER_WIND_ROSE_SPEED_BINS
+#else
+#define ULTIMETER_STATE_WIND_ROSE_SECTORS       0
+#define ULTIMETER_STATE_WIND_ROSE_SPEED_BINS    0
+#endif
+#endif
+
+#ifdef ULTIMETER_DRIVER_TICKLESS
+#ifdef ULTIMETER_DRIVER_DEBOUNCE_STORM_EDGES
+// Edge interrupts are masked until the next alarm in case of storm.
+#define ULTIMETER_ALARM_DELAY_SECONDS_MAX       4
+#else
+#define ULTIMETER_ALARM_DELAY_SECONDS_MAX       0xFFFFFFFF
+#endif
+#endif
+
+#ifdef ULTIMETER_DRIVER_DUTY_CYCLE
+#ifdef ULTIMETER_DRIVER_TICKLESS
+// Wake-up is given by the alarm so the timer can be stopped between bursts.
+#define ULTIMETER_DUTY_CYCLE_TIMER_FLAG         1
+#else
+// Timer generates the tick which schedules the bursts.
+#define ULTIMETER_DUTY_CYCLE_TIMER_FLAG         0
+#endif
+#endif
+
+#ifdef ULTIMETER_DRIVER_WIND_DIRECTION_PER_ROTATION
+#define ULTIMETER_ROTATION_SUMS_READ_RETRY_MAX  4
+#endif
+
+#if ((ULTIMETER_DRIVER_WIND_SPEED_SAMPLING_TIME_SECONDS == 0) || (ULTIMETER_DRIVER_WIND_SPEED_SAMPLING_TIME_SECONDS > ULTIMETER_WIND_SPEED_SAMPLING_TIME_SECONDS_MAX))
+#error "ULTIMETER driver: ULTIMETER_DRIVER_WIND_SPEED_SAMPLING_TIME_SECONDS must be between 1 and 255"
+#endif
+
+#if ((defined ULTIMETER_DRIVER_WIND_SPEED_RECIPROCAL) || (defined ULTIMETER_DRIVER_ADAPTIVE_SAMPLING) || (defined ULTIMETER_DRIVER_SLIDING_WINDOW_LONG_SAMPLES) || (defined ULTIMETER_DRIVER_WIND_ROSE_SECTORS) || (defined ULTIMETER_DRIVER_RECORDER) || (defined ULTIMETER_DRIVER_SINK_BATCH_RECORDS))
+// Options which use the speed of each window.
+#define ULTIMETER_WINDOW_SPEED_REQUIRED
+#endif
+
+#ifdef ULTIMETER_DRIVER_SLIDING_WINDOW_LONG_SAMPLES
+#if ((ULTIMETER_DRIVER_SLIDING_WINDOW_SHORT_SAMPLES > ULTIMETER_DRIVER_SLIDING_WINDOW_LONG_SAMPLES) || (ULTIMETER_DRIVER_SLIDING_WINDOW_GUST_SAMPLES > ULTIMETER_DRIVER_SLIDING_WINDOW_LONG_SAMPLES))
+#error "ULTIMETER driver: short and gust sliding windows must not be longer than the long sliding window"
+#endif
+#if (ULTIMETER_WIND_DIRECTION_FULL_TURN >= 0xFFFF)
+#error "ULTIMETER driver: ULTIMETER_DRIVER_WIND_DIRECTION_RESOLUTION is too high for the sliding windows storage"
+#endif
+#define ULTIMETER_SLIDING_WINDOW_DIRECTION_ERROR_VALUE  0xFFFF
+#endif
+
+#ifdef ULTIMETER_DRIVER_WIND_ROSE_SECTORS
+#if ((ULTIMETER_DRIVER_WIND_ROSE_SECTORS == 0) || (ULTIMETER_DRIVER_WIND_ROSE_SPEED_BINS == 0) || (ULTIMETER_DRIVER_WIND_ROSE_SPEED_BIN_WIDTH_MH == 0))
+#error "ULTIMETER driver: invalid wind rose configuration"
+#endif
+#define ULTIMETER_WIND_ROSE_COUNT_MAX           0xFFFF
+#define ULTIMETER_WIND_ROSE_BITS_PER_COUNTER_MAX    16
+#endif
+
+#ifdef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+#if ((defined ULTIMETER_DRIVER_WIND_DIRECTION_RECIPROCAL) || (defined ULTIMETER_DRIVER_WIND_DIRECTION_PER_ROTATION) || (defined ULTIMETER_DRIVER_SLIDING_WINDOW_LONG_SAMPLES) || (defined ULTIMETER_DRIVER_WIND_ROSE_SECTORS) || (defined ULTIMETER_DRIVER_RECORDER) || (defined ULTIMETER_DRIVER_BATCH))
+#error "ULTIMETER driver: wind direction features can not be used with ULTIMETER_DRIVER_WIND_SPEED_ONLY"
+#endif
+#endif
+
+#if ((defined ULTIMETER_DRIVER_DEBOUNCE_STORM_EDGES) && (!defined ULTIMETER_DRIVER_DEBOUNCE_WIND_SPEED_MAX_MH))
+#error "ULTIMETER driver: ULTIMETER_DRIVER_DEBOUNCE_STORM_EDGES requires ULTIMETER_DRIVER_DEBOUNCE_WIND_SPEED_MAX_MH"
+#endif
+
+#if ((defined ULTIMETER_DRIVER_SINK_BATCH_RECORDS) && (ULTIMETER_DRIVER_SINK_BATCH_RECORDS == 0))
+#error "ULTIMETER driver: ULTIMETER_DRIVER_SINK_BATCH_RECORDS must not be 0"
+#endif
+
+#ifdef ULTIMETER_DRIVER_EDGE_BUFFER_SIZE
+#if ((ULTIMETER_DRIVER_EDGE_BUFFER_SIZE & (ULTIMETER_DRIVER_EDGE_BUFFER_SIZE - 1)) != 0)
+#error "ULTIMETER driver: ULTIMETER_DRIVER_EDGE_BUFFER_SIZE must be a power of 2"
+#endif
+#define ULTIMETER_EDGE_BUFFER_INDEX_MASK        (ULTIMETER_DRIVER_EDGE_BUFFER_SIZE - 1)
+// Set in the type of the first entry pushed after lost edges.
+#define ULTIMETER_EDGE_BUFFER_LOSS_FLAG         0x80
+#endif
+
+#ifdef ULTIMETER_DRIVER_DIAGNOSTICS
+#define ULTIMETER_DIAGNOSTICS_increment(counter)            { handle->diagnostics_##counter++; }
+#define ULTIMETER_DIAGNOSTICS_start(start_cycles)           { start_cycles = ULTIMETER_HW_get_cycle_counter(handle->instance); }
+#define ULTIMETER_DIAGNOSTICS_stop(start_cycles, cycles)    { _ULTIMETER_diagnostics_add_cycles(&(handle->diagnostics_##cycles), (ULTIMETER_HW_get_cycle_counter(handle->instance) - start_cycles)); }
+#else
+#define ULTIMETER_DIAGNOSTICS_increment(counter)
+#define ULTIMETER_DIAGNOSTICS_start(start_cycles)
+#define ULTIMETER_DIAGNOSTICS_stop(start_cycles, cycles)
+#endif
+
+#ifdef ULTIMETER_DRIVER_RAM_BUDGET_BYTES
+// Compile time check of the instance context size (array size is negative when the budget is exceeded).
+typedef char ULTIMETER_handle_size_check_t[(sizeof(ULTIMETER_handle_t) <= ULTIMETER_DRIVER_RAM_BUDGET_BYTES) ? 1 : -1];
+#endif
 
 /*** ULTIMETER local structures ***/
 
 /*******************************************************************/
-typedef struct {
-    // State machine.
-    ULTIMETER_process_cb_t process_callback;
-    volatile uint8_t tick_second_flag;
-    uint8_t wind_measurement_enable_flag;
+typedef struct {
+    uint32_t edge_count;
+    uint32_t seconds;
+    uint32_t sum;
+#ifdef ULTIMETER_WINDOW_SPEED_REQUIRED
+    uint32_t wind_speed_mh;
+    uint32_t peak_wind_speed_mh;
+#endif
+} ULTIMETER_wind_speed_window_t;
+
+#ifdef ULTIMETER_DRIVER_EDGE_BUFFER_SIZE
+/*******************************************************************/
+typedef enum {
+    ULTIMETER_EDGE_TYPE_WIND_SPEED = 0,
+    ULTIMETER_EDGE_TYPE_WIND_DIRECTION,
+    ULTIMETER_EDGE_TYPE_LAST
+} ULTIMETER_edge_type_t;
+#endif
+
+/*** ULTIMETER local functions ***/
+
+#ifdef ULTIMETER_DRIVER_DIAGNOSTICS
+/*******************************************************************/
+static void _ULTIMETER_diagnostics_add_cycles(volatile ULTIMETER_diagnostics_cycles_t* cycles, uint32_t value) {
+    // Update accumulator.
+    if (value < cycles->min) {
+        cycles->min = value;
+    }
+    if (value > cycles->max) {
+        cycles->max = value;
+    }
+    cycles->sum += (uint64_t) value;
+    cycles->count++;
+}
+
+/*******************************************************************/
+static void _ULTIMETER_diagnostics_reset_cycles(volatile ULTIMETER_diagnostics_cycles_t* cycles) {
+    // Reset accumulator.
+    cycles->min = 0xFFFFFFFF;
+    cycles->max = 0;
+    cycles->sum = 0;
+    cycles->count = 0;
+}
+
+/*******************************************************************/
+static void _ULTIMETER_diagnostics_get_cycles_statistics(volatile ULTIMETER_diagnostics_cycles_t* cycles, ULTIMETER_cycles_statistics_t* statistics) {
+    // Reset output.
+    statistics->min_cycles = 0;
+    statistics->max_cycles = 0;
+    statistics->average_cycles = 0;
+    // Compute statistics.
+    if (cycles->count != 0) {
+        statistics->min_cycles = cycles->min;
+        statistics->max_cycles = cycles->max;
+        statistics->average_cycles = (uint32_t) (cycles->sum / ((uint64_t) cycles->count));
+    }
+}
+#endif
+
+/*******************************************************************/
+static uint32_t _ULTIMETER_timer_extend_counter(ULTIMETER_handle_t* handle) {
+    // Local variables.
+    uint32_t counter = (ULTIMETER_HW_timer_get_counter(handle->instance) & handle->timer_counter_mask);
+    // Extend narrow counters in software (no effect on 32-bits counters since the mask + 1 is 0).
+    if (counter < handle->timer_counter_last) {
+        handle->timer_counter_extension += (handle->timer_counter_mask + 1);
+    }
+    handle->timer_counter_last = counter;
+    return (handle->timer_counter_extension + counter);
+}
+
+/*******************************************************************/
+static uint32_t _ULTIMETER_timer_get_counter(ULTIMETER_handle_t* handle) {
+    // Local variables.
+    uint32_t counter = 0;
+    // Edge and tick interrupts must not interleave between the counter read and the extension update.
+    ULTIMETER_HW_enter_critical(handle->instance);
+    counter = _ULTIMETER_timer_extend_counter(handle);
+    ULTIMETER_HW_exit_critical(handle->instance);
+    return counter;
+}
+
+#ifdef ULTIMETER_DRIVER_WIND_DIRECTION_RECIPROCAL
+/*******************************************************************/
+static void _ULTIMETER_update_wind_direction(ULTIMETER_handle_t* handle) {
+    // Local variables.
+    uint32_t wind_direction_period = 0;
+#ifndef ULTIMETER_DRIVER_WIND_DIRECTION_PER_ROTATION
+    uint32_t wind_direction_duty_cycle = 0;
+#endif
+    uint32_t reciprocal = handle->wind_direction_period_reciprocal;
+    uint8_t shift = handle->wind_direction_period_shift;
+    // Read the last rotation captured by the speed edge callback.
+    ULTIMETER_HW_enter_critical(handle->instance);
+    wind_direction_period = handle->wind_direction_period;
+#ifndef ULTIMETER_DRIVER_WIND_DIRECTION_PER_ROTATION
+    wind_direction_duty_cycle = handle->wind_direction_duty_cycle;
+#endif
+    ULTIMETER_HW_exit_critical(handle->instance);
+    // Newton-Raphson iterations are only run here, once per tick.
+    if (wind_direction_period != 0) {
+        ULTIMETER_MATH_refine_wind_direction_reciprocal(wind_direction_period, &reciprocal, &shift);
+        handle->wind_direction_period_reciprocal = reciprocal;
+        handle->wind_direction_period_shift = shift;
+    }
+#ifndef ULTIMETER_DRIVER_WIND_DIRECTION_PER_ROTATION
+    // Only the last rotation direction is used, it is directly computed here.
+    handle->wind_direction_angle = (wind_direction_period != 0) ? ULTIMETER_MATH_compute_wind_direction_angle_reciprocal(wind_direction_duty_cycle, wind_direction_period, reciprocal, shift) : ULTIMETER_WIND_DIRECTION_ERROR_VALUE;
+#endif
+}
+#endif
+
+/*******************************************************************/
+static void _ULTIMETER_wind_speed_edge(ULTIMETER_handle_t* handle, uint32_t counter) {
+    // Local variables.
+#if ((!defined ULTIMETER_DRIVER_WIND_SPEED_ONLY) || (defined ULTIMETER_DRIVER_WIND_SPEED_RECIPROCAL))
+    uint32_t wind_direction_period = 0;
+#endif
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+    uint32_t wind_direction_duty_cycle = 0;
+#endif
+#ifdef ULTIMETER_DRIVER_WIND_DIRECTION_PER_ROTATION
+    int32_t wind_direction_degrees = 0;
+#endif
+    // Wind speed.
+    handle->wind_speed_edge_count++;
+    // Capture period.
+    handle->wind_speed_counter_stop = counter;
+#if ((!defined ULTIMETER_DRIVER_WIND_SPEED_ONLY) || (defined ULTIMETER_DRIVER_WIND_SPEED_RECIPROCAL))
+    // Compute period with modular arithmetic to support counter wrap.
+    wind_direction_period = (handle->wind_speed_counter_stop - handle->wind_speed_counter_start);
+#endif
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+    // Reset direction.
+#if ((defined ULTIMETER_DRIVER_WIND_DIRECTION_RECIPROCAL) && (!defined ULTIMETER_DRIVER_WIND_DIRECTION_PER_ROTATION))
+    handle->wind_direction_period = 0;
+#else
+    handle->wind_direction_angle = ULTIMETER_WIND_DIRECTION_ERROR_VALUE;
+#endif
+    wind_direction_duty_cycle = (handle->wind_direction_counter - handle->wind_speed_counter_start);
+    // Check counters.
+    if ((handle->wind_speed_period_valid_flag != 0) &&
+        (handle->wind_direction_enable_flag != 0) &&
+        (handle->wind_direction_irq_flag != 0) &&
+        (wind_direction_period != 0) &&
+        (wind_direction_duty_cycle <= wind_direction_period)) {
+        // Compute wind direction.
+#ifdef ULTIMETER_DRIVER_WIND_DIRECTION_RECIPROCAL
+        // Store the rotation for the reciprocal refinement of ULTIMETER_process().
+#ifdef ULTIMETER_DRIVER_WIND_DIRECTION_PER_ROTATION
+        handle->wind_direction_period = wind_direction_period;
+        handle->wind_direction_angle = ULTIMETER_MATH_compute_wind_direction_angle_reciprocal(wind_direction_duty_cycle, wind_direction_period, handle->wind_direction_period_reciprocal, handle->wind_direction_period_shift);
+#else
+        handle->wind_direction_duty_cycle = wind_direction_duty_cycle;
+        handle->wind_direction_period = wind_direction_period;
+#endif
+#else
+        handle->wind_direction_angle = ULTIMETER_MATH_compute_wind_direction_angle(wind_direction_duty_cycle, wind_direction_period);
+#endif
+#ifdef ULTIMETER_DRIVER_WIND_DIRECTION_PER_ROTATION
+        // Accumulate the unit vector of each rotation (modular sums, the count is updated last since it is used as sequence number).
+        wind_direction_degrees = ULTIMETER_MATH_get_wind_direction_degrees(handle->wind_direction_angle);
+        handle->wind_direction_rotation_x_sum += (uint32_t) ((int32_t) MATH_COS_TABLE[wind_direction_degrees]);
+        handle->wind_direction_rotation_y_sum += (uint32_t) ((int32_t) MATH_SIN_TABLE[wind_direction_degrees]);
+        handle->wind_direction_rotation_count++;
+#endif
+    }
+#ifdef ULTIMETER_DRIVER_DIAGNOSTICS
+    else if (handle->wind_direction_enable_flag != 0) {
+        if (handle->wind_direction_irq_flag == 0) {
+            ULTIMETER_DIAGNOSTICS_increment(wind_direction_missing_count);
+        }
+        else {
+            ULTIMETER_DIAGNOSTICS_increment(wind_direction_rejected_count);
+        }
+    }
+#endif
+    handle->wind_direction_irq_flag = 0;
+#endif /* ULTIMETER_DRIVER_WIND_SPEED_ONLY */
+#ifdef ULTIMETER_DRIVER_WIND_SPEED_RECIPROCAL
+    // Accumulate complete rotation periods.
+    if ((handle->wind_speed_period_valid_flag != 0) && (wind_direction_period != 0)) {
+        handle->wind_speed_period_sum += (uint64_t) wind_direction_period;
+        handle->wind_speed_period_count++;
+        if (wind_direction_period < handle->wind_speed_period_min) {
+            handle->wind_speed_period_min = wind_direction_period;
+        }
+    }
+#endif
+    // Start new period.
+    handle->wind_speed_period_valid_flag = 1;
+    handle->wind_speed_counter_start = handle->wind_speed_counter_stop;
+}
+
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+/*******************************************************************/
+static void _ULTIMETER_wind_direction_edge(ULTIMETER_handle_t* handle, uint32_t counter) {
+    // Set flag and store counter.
+    handle->wind_direction_irq_flag = 1;
+    handle->wind_direction_counter = counter;
+}
+#endif
+
+#ifdef ULTIMETER_DRIVER_EDGE_BUFFER_SIZE
+/*******************************************************************/
+static void _ULTIMETER_edge_buffer_push(ULTIMETER_handle_t* handle, ULTIMETER_edge_type_t edge_type, uint32_t counter) {
+    // Local variables.
+    uint32_t write_index = handle->edge_buffer_write_index;
+    uint32_t position = (write_index & ULTIMETER_EDGE_BUFFER_INDEX_MASK);
+    // Check free space.
+    if ((write_index - handle->edge_buffer_read_index) >= ULTIMETER_DRIVER_EDGE_BUFFER_SIZE) {
+        handle->edge_buffer_overflow_count++;
+        // The period which spans the lost edge will be discarded when the next entry is processed.
+        handle->edge_buffer_loss_flag = 1;
+        return;
+    }
+    // Store raw timestamp.
+    handle->edge_buffer_counter[position] = counter;
+    handle->edge_buffer_type[position] = (uint8_t) ((handle->edge_buffer_loss_flag != 0) ? (edge_type | ULTIMETER_EDGE_BUFFER_LOSS_FLAG) : edge_type);
+    handle->edge_buffer_loss_flag = 0;
+    // Publish entry once written.
+    handle->edge_buffer_write_index = (write_index + 1);
+}
+
+/*******************************************************************/
+static void _ULTIMETER_edge_buffer_drain(ULTIMETER_handle_t* handle) {
+    // Local variables.
+    uint32_t read_index = handle->edge_buffer_read_index;
+    uint32_t tick_index = handle->edge_buffer_tick_index;
+    uint32_t position = 0;
+    uint8_t edge_type = 0;
+    // Process all edges captured before the last tick.
+    while (read_index != tick_index) {
+        position = (read_index & ULTIMETER_EDGE_BUFFER_INDEX_MASK);
+        edge_type = handle->edge_buffer_type[position];
+        // Edges have been lost just before this one: the period in progress spans them.
+        if ((edge_type & ULTIMETER_EDGE_BUFFER_LOSS_FLAG) != 0) {
+            handle->wind_speed_period_valid_flag = 0;
+            edge_type &= (uint8_t) (~ULTIMETER_EDGE_BUFFER_LOSS_FLAG);
+        }
+        if (edge_type == ULTIMETER_EDGE_TYPE_WIND_SPEED) {
+            _ULTIMETER_wind_speed_edge(handle, handle->edge_buffer_counter[position]);
+        }
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+        else {
+            _ULTIMETER_wind_direction_edge(handle, handle->edge_buffer_counter[position]);
+        }
+#endif
+        read_index++;
+    }
+    // Release entries.
+    handle->edge_buffer_read_index = read_index;
+}
+#endif
+
+#ifdef ULTIMETER_DRIVER_DEBOUNCE_WIND_SPEED_MAX_MH
+/*******************************************************************/
+static uint8_t _ULTIMETER_debounce_edge(ULTIMETER_handle_t* handle, uint32_t counter, volatile uint32_t* counter_last, uint32_t interval_min) {
+    // Local variables.
+    uint8_t accept_flag = 1;
+    // Edges closer than the fastest physically possible rotation are bounces or noise.
+    if ((counter - (*counter_last)) < interval_min) {
+        accept_flag = 0;
+        handle->debounce_rejected_edge_count++;
+#ifdef ULTIMETER_DRIVER_DEBOUNCE_STORM_EDGES
+        // Mask edge interrupts until next tick in case of interrupt storm.
+        handle->debounce_tick_rejected_edge_count++;
+        if ((handle->debounce_tick_rejected_edge_count >= ULTIMETER_DRIVER_DEBOUNCE_STORM_EDGES) && (handle->debounce_interrupts_masked_flag == 0)) {
+            handle->debounce_interrupts_masked_flag = 1;
+            handle->debounce_storm_count++;
+            // Rotation period will span the masked time.
+#ifdef ULTIMETER_DRIVER_EDGE_BUFFER_SIZE
+            handle->edge_buffer_loss_flag = 1;
+#else
+            handle->wind_speed_period_valid_flag = 0;
+#endif
+            ULTIMETER_HW_set_wind_speed_direction_interrupts(handle->instance, 0);
+        }
+#endif
+    }
+    else {
+        (*counter_last) = counter;
+    }
+    return accept_flag;
+}
+#endif
+
+/*******************************************************************/
+static void _ULTIMETER_wind_speed_edge_callback(ULTIMETER_handle_t* handle) {
+    // Local variables.
+#ifdef ULTIMETER_DRIVER_DIAGNOSTICS
+    uint32_t start_cycles = 0;
+#endif
+    uint32_t counter = 0;
+    uint8_t accept_flag = 1;
+    // Read timer.
+    ULTIMETER_DIAGNOSTICS_start(start_cycles);
+    ULTIMETER_DIAGNOSTICS_increment(wind_speed_edge_irq_count);
+#ifdef ULTIMETER_DRIVER_EDGE_BUFFER_SIZE
+    // Timestamp and push at once, so that the buffer is ordered whatever the interrupts priority levels.
+    ULTIMETER_HW_enter_critical(handle->instance);
+    counter = _ULTIMETER_timer_extend_counter(handle);
+#else
+    counter = _ULTIMETER_timer_get_counter(handle);
+#endif
+#ifdef ULTIMETER_DRIVER_DEBOUNCE_WIND_SPEED_MAX_MH
+    accept_flag = _ULTIMETER_debounce_edge(handle, counter, &(handle->debounce_wind_speed_counter_last), handle->debounce_period_min);
+#endif
+    if (accept_flag != 0) {
+#ifdef ULTIMETER_DRIVER_EDGE_BUFFER_SIZE
+        _ULTIMETER_edge_buffer_push(handle, ULTIMETER_EDGE_TYPE_WIND_SPEED, counter);
+#else
+        _ULTIMETER_wind_speed_edge(handle, counter);
+#endif
+    }
+#ifdef ULTIMETER_DRIVER_EDGE_BUFFER_SIZE
+    ULTIMETER_HW_exit_critical(handle->instance);
+#endif
+    ULTIMETER_DIAGNOSTICS_stop(start_cycles, wind_speed_edge_irq_cycles);
+}
+
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+/*******************************************************************/
+static void _ULTIMETER_wind_direction_edge_callback(ULTIMETER_handle_t* handle) {
+    // Local variables.
+#ifdef ULTIMETER_DRIVER_DIAGNOSTICS
+    uint32_t start_cycles = 0;
+#endif
+    uint32_t counter = 0;
+    uint8_t accept_flag = 1;
+    // Read timer.
+    ULTIMETER_DIAGNOSTICS_start(start_cycles);
+    ULTIMETER_DIAGNOSTICS_increment(wind_direction_edge_irq_count);
+#ifdef ULTIMETER_DRIVER_EDGE_BUFFER_SIZE
+    // Timestamp and push at once, so that the buffer is ordered whatever the interrupts priority levels.
+    ULTIMETER_HW_enter_critical(handle->instance);
+    counter = _ULTIMETER_timer_extend_counter(handle);
+#else
+    counter = _ULTIMETER_timer_get_counter(handle);
+#endif
+#ifdef ULTIMETER_DRIVER_DEBOUNCE_WIND_SPEED_MAX_MH
+    // Direction edges can get closer than one rotation when the direction moves backward.
+    accept_flag = _ULTIMETER_debounce_edge(handle, counter, &(handle->debounce_wind_direction_counter_last), (handle->debounce_period_min / 2));
+#endif
+    if (accept_flag != 0) {
+#ifdef ULTIMETER_DRIVER_EDGE_BUFFER_SIZE
+        _ULTIMETER_edge_buffer_push(handle, ULTIMETER_EDGE_TYPE_WIND_DIRECTION, counter);
+#else
+        _ULTIMETER_wind_direction_edge(handle, counter);
+#endif
+    }
+#ifdef ULTIMETER_DRIVER_EDGE_BUFFER_SIZE
+    ULTIMETER_HW_exit_critical(handle->instance);
+#endif
+    ULTIMETER_DIAGNOSTICS_stop(start_cycles, wind_direction_edge_irq_cycles);
+}
+#endif
+
+/*******************************************************************/
+static ULTIMETER_status_t _ULTIMETER_start_capture(ULTIMETER_handle_t* handle, uint8_t timer_flag) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    if (timer_flag != 0) {
+        // Restart counter extension.
+        handle->timer_counter_last = 0;
+        handle->timer_counter_extension = 0;
+        status = ULTIMETER_HW_timer_start(handle->instance);
+        if (status != ULTIMETER_SUCCESS) goto errors;
+    }
+    // Restart period measurement.
+    handle->wind_speed_period_valid_flag = 0;
+#ifdef ULTIMETER_DRIVER_DEBOUNCE_WIND_SPEED_MAX_MH
+    // Accept first edges whatever their timestamp (edges are compared with the extended counter).
+    handle->debounce_wind_speed_counter_last = (_ULTIMETER_timer_get_counter(handle) - handle->debounce_period_min);
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+    handle->debounce_wind_direction_counter_last = handle->debounce_wind_speed_counter_last;
+#endif
+#endif
+#ifdef ULTIMETER_DRIVER_DEBOUNCE_STORM_EDGES
+    handle->debounce_tick_rejected_edge_count = 0;
+    handle->debounce_interrupts_masked_flag = 0;
+#endif
+    status = ULTIMETER_HW_set_wind_speed_direction_interrupts(handle->instance, 1);
+    if (status != ULTIMETER_SUCCESS) goto errors;
+errors:
+    return status;
+}
+
+/*******************************************************************/
+static ULTIMETER_status_t _ULTIMETER_stop_capture(ULTIMETER_handle_t* handle, uint8_t timer_flag) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    status = ULTIMETER_HW_set_wind_speed_direction_interrupts(handle->instance, 0);
+    if (status != ULTIMETER_SUCCESS) goto errors;
+#ifdef ULTIMETER_DRIVER_DEBOUNCE_STORM_EDGES
+    // Interrupts must not be unmasked by the next tick.
+    handle->debounce_interrupts_masked_flag = 0;
+#endif
+    if (timer_flag != 0) {
+        ULTIMETER_HW_timer_stop(handle->instance);
+    }
+errors:
+    return status;
+}
+
+#ifdef ULTIMETER_DRIVER_DUTY_CYCLE
+/*******************************************************************/
+static uint8_t _ULTIMETER_duty_cycle_is_burst(ULTIMETER_handle_t* handle) {
+    // Measurement is continuous when the period is 0.
+    return (((handle->duty_cycle_period_seconds == 0) || (handle->duty_cycle_seconds_count < handle->duty_cycle_burst_seconds)) ? 1 : 0);
+}
+
+/*******************************************************************/
+static uint8_t _ULTIMETER_duty_cycle_check_sampling_time(ULTIMETER_handle_t* handle, uint32_t wind_speed_sampling_time_seconds) {
+    // Bursts must contain complete wind speed windows.
+    return (((handle->duty_cycle_period_seconds == 0) || ((handle->duty_cycle_burst_seconds % wind_speed_sampling_time_seconds) == 0)) ? 1 : 0);
+}
+
+/*******************************************************************/
+static void _ULTIMETER_discard_edges(ULTIMETER_handle_t* handle) {
+    // Reset current wind speed window, its duration does not include the time elapsed since its edges.
+    handle->wind_speed_seconds_count = 0;
+    handle->wind_speed_edge_count = 0;
+#ifdef ULTIMETER_DRIVER_WIND_SPEED_RECIPROCAL
+    handle->wind_speed_period_count = 0;
+    handle->wind_speed_period_sum = 0;
+    handle->wind_speed_period_min = 0xFFFFFFFF;
+#endif
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+    handle->wind_direction_irq_flag = 0;
+#endif
+#ifdef ULTIMETER_DRIVER_EDGE_BUFFER_SIZE
+    // Only consumer side indexes can be updated here.
+    handle->edge_buffer_read_index = handle->edge_buffer_write_index;
+    handle->edge_buffer_tick_index = handle->edge_buffer_read_index;
+#endif
+}
+
+/*******************************************************************/
+static ULTIMETER_status_t _ULTIMETER_duty_cycle_update(ULTIMETER_handle_t* handle) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    uint8_t burst_flag = _ULTIMETER_duty_cycle_is_burst(handle);
+    // Start capture at the beginning of each burst.
+    if ((burst_flag != 0) && (handle->duty_cycle_capture_flag == 0)) {
+        // Edges captured after the end of the previous burst do not belong to any window.
+        _ULTIMETER_discard_edges(handle);
+        status = _ULTIMETER_start_capture(handle, ULTIMETER_DUTY_CYCLE_TIMER_FLAG);
+        if (status != ULTIMETER_SUCCESS) goto errors;
+        handle->duty_cycle_capture_flag = 1;
+    }
+    // Stop capture once the last window of the burst has been computed.
+    if ((burst_flag == 0) && (handle->duty_cycle_capture_flag != 0)) {
+        status = _ULTIMETER_stop_capture(handle, ULTIMETER_DUTY_CYCLE_TIMER_FLAG);
+        if (status != ULTIMETER_SUCCESS) goto errors;
+        handle->duty_cycle_capture_flag = 0;
+    }
+errors:
+    return status;
+}
+#endif
+
+/*******************************************************************/
+static uint32_t _ULTIMETER_get_next_deadline_seconds(ULTIMETER_handle_t* handle) {
+    // Local variables.
+    uint32_t remaining_seconds = (handle->wind_speed_sampling_time_seconds - (handle->wind_speed_seconds_count % handle->wind_speed_sampling_time_seconds));
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+    uint32_t wind_direction_remaining_seconds = (handle->wind_direction_sampling_period_seconds - (handle->wind_direction_seconds_count % handle->wind_direction_sampling_period_seconds));
+#endif
+#ifdef ULTIMETER_DRIVER_DUTY_CYCLE
+    uint32_t duty_cycle_remaining_seconds = 0;
+#endif
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+    // Closest window end, direction window is not relevant when direction sampling is disabled.
+    if ((handle->wind_direction_enable_flag != 0) && (wind_direction_remaining_seconds < remaining_seconds)) {
+        remaining_seconds = wind_direction_remaining_seconds;
+    }
+#endif
+#ifdef ULTIMETER_DRIVER_DUTY_CYCLE
+    if (handle->duty_cycle_period_seconds != 0) {
+        if (_ULTIMETER_duty_cycle_is_burst(handle) != 0) {
+            // Burst end.
+            duty_cycle_remaining_seconds = (handle->duty_cycle_burst_seconds - handle->duty_cycle_seconds_count);
+            if (duty_cycle_remaining_seconds < remaining_seconds) {
+                remaining_seconds = duty_cycle_remaining_seconds;
+            }
+        }
+        else {
+            // Windows are frozen until the next burst.
+            remaining_seconds = (handle->duty_cycle_period_seconds - handle->duty_cycle_seconds_count);
+        }
+    }
+#endif
+    return remaining_seconds;
+}
+
+#ifdef ULTIMETER_DRIVER_TICKLESS
+/*******************************************************************/
+static ULTIMETER_status_t _ULTIMETER_set_next_alarm(ULTIMETER_handle_t* handle) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    uint32_t delay_seconds = _ULTIMETER_get_next_deadline_seconds(handle);
+    // Program alarm on next window end, with intermediate wake-ups if it is too far.
+#ifdef ULTIMETER_DRIVER_DUTY_CYCLE
+    // Timer and edge interrupts are stopped between bursts.
+    if ((delay_seconds > handle->alarm_delay_seconds_max) && (_ULTIMETER_duty_cycle_is_burst(handle) != 0)) {
+#else
+    if (delay_seconds > handle->alarm_delay_seconds_max) {
+#endif
+        delay_seconds = handle->alarm_delay_seconds_max;
+    }
+    handle->alarm_delay_seconds = delay_seconds;
+    status = ULTIMETER_HW_set_alarm(handle->instance, delay_seconds);
+    if (status != ULTIMETER_SUCCESS) goto errors;
+errors:
+    return status;
+}
+#endif
+
+/*******************************************************************/
+static void _ULTIMETER_tick_second_callback(ULTIMETER_handle_t* handle) {
+    // Local variables.
+#ifdef ULTIMETER_DRIVER_DIAGNOSTICS
+    uint32_t start_cycles = 0;
+#endif
+    uint32_t elapsed_seconds = 1;
+    ULTIMETER_DIAGNOSTICS_start(start_cycles);
+    ULTIMETER_DIAGNOSTICS_increment(tick_irq_count);
+    // Check enable flag.
+    if (handle->wind_measurement_enable_flag != 0) {
+        // Sample timer at least once per tick to track narrow counters wrap.
+        _ULTIMETER_timer_get_counter(handle);
+#ifdef ULTIMETER_DRIVER_TICKLESS
+        // Callback is triggered by the alarm.
+        // While the windows run, the alarm never ends after the wind speed window, whose sampling time is at most 255 seconds: the elapsed time always fits the 8-bit seconds counter.
+        elapsed_seconds = handle->alarm_delay_seconds;
+#endif
+        // Update local flags.
+#ifdef ULTIMETER_DRIVER_DUTY_CYCLE
+        // Only the time spent in bursts belongs to the windows.
+        if (_ULTIMETER_duty_cycle_is_burst(handle) != 0) {
+            handle->wind_speed_seconds_count = (uint8_t) (handle->wind_speed_seconds_count + elapsed_seconds);
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+            handle->wind_direction_seconds_count += elapsed_seconds;
+#endif
+        }
+        handle->duty_cycle_seconds_count += elapsed_seconds;
+        if (handle->duty_cycle_seconds_count >= handle->duty_cycle_period_seconds) {
+            handle->duty_cycle_seconds_count = 0;
+        }
+#else
+        handle->wind_speed_seconds_count = (uint8_t) (handle->wind_speed_seconds_count + elapsed_seconds);
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+        handle->wind_direction_seconds_count += elapsed_seconds;
+#endif
+#endif
+#ifdef ULTIMETER_DRIVER_EDGE_BUFFER_SIZE
+        // Mark the edges which belong to the elapsed time.
+        handle->edge_buffer_tick_index = handle->edge_buffer_write_index;
+#endif
+#ifdef ULTIMETER_DRIVER_DEBOUNCE_STORM_EDGES
+        // Start a new storm detection period and unmask edge interrupts.
+        handle->debounce_tick_rejected_edge_count = 0;
+        if (handle->debounce_interrupts_masked_flag != 0) {
+            handle->debounce_interrupts_masked_flag = 0;
+            ULTIMETER_HW_set_wind_speed_direction_interrupts(handle->instance, 1);
+        }
+#endif
+#ifdef ULTIMETER_DRIVER_DIAGNOSTICS
+        // Previous tick has not been processed yet.
+        if (handle->tick_second_flag != 0) {
+            ULTIMETER_DIAGNOSTICS_increment(missed_tick_count);
+        }
+#endif
+        handle->tick_second_flag = 1;
+#ifdef ULTIMETER_DRIVER_TICKLESS
+        // Program next wake-up.
+        _ULTIMETER_set_next_alarm(handle);
+#endif
+        // Ask for processing.
+        if (handle->process_callback != NULL) {
+            handle->process_callback(handle);
+        }
+    }
+    ULTIMETER_DIAGNOSTICS_stop(start_cycles, tick_irq_cycles);
+}
+
+/*******************************************************************/
+static void _ULTIMETER_close_wind_speed_window(ULTIMETER_handle_t* handle, ULTIMETER_wind_speed_window_t* window) {
+    // Local variables.
+#ifdef ULTIMETER_DRIVER_WIND_SPEED_RECIPROCAL
+    uint32_t period_count = 0;
+    uint64_t period_sum = 0;
+    uint32_t period_min = 0;
+#endif
+    // Read and reset the edge accumulators at once, the 64-bits sum can not be read atomically.
+    ULTIMETER_HW_enter_critical(handle->instance);
+    window->edge_count = handle->wind_speed_edge_count;
+    handle->wind_speed_edge_count = 0;
+#ifdef ULTIMETER_DRIVER_WIND_SPEED_RECIPROCAL
+    period_count = handle->wind_speed_period_count;
+    period_sum = handle->wind_speed_period_sum;
+    period_min = handle->wind_speed_period_min;
+    handle->wind_speed_period_count = 0;
+    handle->wind_speed_period_sum = 0;
+    handle->wind_speed_period_min = 0xFFFFFFFF;
+#endif
+    ULTIMETER_HW_exit_critical(handle->instance);
+    // Elapsed duration, which differs from the sampling time when it has been changed during the window.
+    window->seconds = handle->wind_speed_seconds_count;
+    handle->wind_speed_seconds_count = 0;
+#ifdef ULTIMETER_DRIVER_WIND_SPEED_RECIPROCAL
+    // Window speeds are computed as in the batch API.
+    ULTIMETER_MATH_compute_window_speed_mh(window->edge_count, window->seconds, period_count, period_sum, period_min, handle->timer_frequency_hz, &(window->wind_speed_mh), &(window->peak_wind_speed_mh));
+    // Update instantaneous gust, the window peak is the fastest rotation as soon as a period has been measured.
+    if ((period_count != 0) && (window->peak_wind_speed_mh > handle->wind_speed_mh_gust)) {
+        handle->wind_speed_mh_gust = window->peak_wind_speed_mh;
+    }
+    window->sum = (window->wind_speed_mh * window->seconds);
+#else
+    // Speed multiplied by the window duration is directly given by the number of rotations.
+    window->sum = (window->edge_count * ULTIMETER_WIND_SPEED_1HZ_TO_MH);
+#ifdef ULTIMETER_WINDOW_SPEED_REQUIRED
+    // Window speeds are computed as in the batch API.
+    ULTIMETER_MATH_compute_window_speed_mh(window->edge_count, window->seconds, 0, 0, 0, 0, &(window->wind_speed_mh), &(window->peak_wind_speed_mh));
+#endif
+#endif
+}
+
+/*******************************************************************/
+static void _ULTIMETER_add_wind_speed_window(ULTIMETER_handle_t* handle, ULTIMETER_wind_speed_window_t* window) {
+    // Accumulate raw values, divisions are computed when the statistics are read.
+    handle->wind_speed_sum += (uint64_t) window->sum;
+    handle->wind_speed_seconds_sum += window->seconds;
+    handle->wind_speed_data_count++;
+    // Peak is the highest window average, compared with the current one without division.
+    if ((handle->wind_speed_peak_seconds == 0) || ((((uint64_t) window->sum) * ((uint64_t) handle->wind_speed_peak_seconds)) > (((uint64_t) handle->wind_speed_peak_sum) * ((uint64_t) window->seconds)))) {
+        handle->wind_speed_peak_sum = window->sum;
+        handle->wind_speed_peak_seconds = window->seconds;
+    }
+}
+
+#ifdef ULTIMETER_DRIVER_ADAPTIVE_SAMPLING
+/*******************************************************************/
+static ULTIMETER_status_t _ULTIMETER_adaptive_sampling_update(ULTIMETER_handle_t* handle, uint32_t wind_speed_mh) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    uint32_t wind_speed_variation_mh = 0;
+    uint32_t wind_speed_sampling_time_seconds = handle->wind_speed_sampling_time_seconds;
+    // Check enable flag.
+    if (handle->adaptive_sampling_enable_flag != 0) {
+        // Compute variation since last window.
+        wind_speed_variation_mh = (wind_speed_mh > handle->adaptive_sampling_last_speed_mh) ? (wind_speed_mh - handle->adaptive_sampling_last_speed_mh) : (handle->adaptive_sampling_last_speed_mh - wind_speed_mh);
+        handle->adaptive_sampling_last_speed_mh = wind_speed_mh;
+        if (wind_speed_variation_mh >= handle->adaptive_sampling.gust_threshold_mh) {
+            // Gusty conditions: come back to the shortest window and sample direction.
+            handle->adaptive_sampling_calm_count = 0;
+            handle->adaptive_sampling_active_count = 0;
+            handle->adaptive_sampling_gust_count++;
+            if (handle->adaptive_sampling_gust_count >= handle->adaptive_sampling.hysteresis_windows) {
+                handle->adaptive_sampling_gust_count = 0;
+                wind_speed_sampling_time_seconds = handle->adaptive_sampling.wind_speed_sampling_time_seconds_min;
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+                handle->wind_direction_enable_flag = 1;
+#endif
+            }
+        }
+        else if (wind_speed_mh < handle->adaptive_sampling.calm_threshold_mh) {
+            // Calm conditions: lengthen window step by step and stop direction sampling.
+            handle->adaptive_sampling_gust_count = 0;
+            handle->adaptive_sampling_active_count = 0;
+            handle->adaptive_sampling_calm_count++;
+            if (handle->adaptive_sampling_calm_count >= handle->adaptive_sampling.hysteresis_windows) {
+                handle->adaptive_sampling_calm_count = 0;
+                wind_speed_sampling_time_seconds = (handle->wind_speed_sampling_time_seconds << 1);
+                if (wind_speed_sampling_time_seconds > handle->adaptive_sampling.wind_speed_sampling_time_seconds_max) {
+                    wind_speed_sampling_time_seconds = handle->adaptive_sampling.wind_speed_sampling_time_seconds_max;
+                }
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+                handle->wind_direction_enable_flag = 0;
+#endif
+            }
+        }
+        else {
+            // Steady wind: restart direction sampling.
+            handle->adaptive_sampling_gust_count = 0;
+            handle->adaptive_sampling_calm_count = 0;
+            handle->adaptive_sampling_active_count++;
+            if (handle->adaptive_sampling_active_count >= handle->adaptive_sampling.hysteresis_windows) {
+                handle->adaptive_sampling_active_count = 0;
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+                handle->wind_direction_enable_flag = 1;
+#endif
+            }
+        }
+#ifdef ULTIMETER_DRIVER_DUTY_CYCLE
+        // Keep the current window if the bursts would not contain complete windows anymore.
+        if (_ULTIMETER_duty_cycle_check_sampling_time(handle, wind_speed_sampling_time_seconds) == 0) {
+            wind_speed_sampling_time_seconds = handle->wind_speed_sampling_time_seconds;
+        }
+#endif
+        handle->wind_speed_sampling_time_seconds = (uint8_t) wind_speed_sampling_time_seconds;
+    }
+    // In tickless mode, the new windows are used from the next alarm.
+    return status;
+}
+#endif
+
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+#ifndef ULTIMETER_DRIVER_WIND_DIRECTION_PER_ROTATION
+/*******************************************************************/
+static void _ULTIMETER_add_trend_point(ULTIMETER_handle_t* handle, uint32_t weight, uint32_t wind_direction_angle) {
+    // Local variables.
+    int32_t x = 0;
+    int32_t y = 0;
+    // Add weighted unit vector to the 64-bits accumulators.
+    ULTIMETER_MATH_get_unit_vector(wind_direction_angle, &x, &y);
+    handle->wind_direction_trend_point_x += ((int64_t) weight) * ((int64_t) x);
+    handle->wind_direction_trend_point_y += ((int64_t) weight) * ((int64_t) y);
+    handle->wind_direction_weight_sum += (uint64_t) weight;
+    handle->wind_direction_data_count++;
+}
+
+/*******************************************************************/
+static void _ULTIMETER_add_window_trend_point(ULTIMETER_handle_t* handle, ULTIMETER_wind_speed_window_t* window) {
+    // Compute direction only if there is wind (window speed of at least 1 km/h, compared without division).
+    if ((window->edge_count != 0) && (window->sum >= (window->seconds * 1000)) && (handle->wind_direction_angle != ULTIMETER_WIND_DIRECTION_ERROR_VALUE)) {
+        // Add new wind direction vector weighted by the number of rotations, which is proportional to the wind speed multiplied by the window duration.
+        _ULTIMETER_add_trend_point(handle, window->edge_count, handle->wind_direction_angle);
+    }
+}
+#else
+/*******************************************************************/
+static void _ULTIMETER_fold_rotation_vectors(ULTIMETER_handle_t* handle, uint8_t add_flag) {
+    // Local variables.
+    uint32_t count = 0;
+    uint32_t x_sum = 0;
+    uint32_t y_sum = 0;
+    uint8_t idx = 0;
+    // Read the sums updated by the edges callback.
+    for (idx = 0; idx < ULTIMETER_ROTATION_SUMS_READ_RETRY_MAX; idx++) {
+        count = handle->wind_direction_rotation_count;
+        x_sum = handle->wind_direction_rotation_x_sum;
+        y_sum = handle->wind_direction_rotation_y_sum;
+        // Sums are consistent if no rotation has been added meanwhile.
+        if (handle->wind_direction_rotation_count == count) break;
+    }
+    // Pending rotations are kept for the next call if the sums are always being updated.
+    if (idx < ULTIMETER_ROTATION_SUMS_READ_RETRY_MAX) {
+        if (add_flag != 0) {
+            // Each rotation is weighted by its unit vector, so that the sum is naturally weighted by the wind speed.
+            handle->wind_direction_trend_point_x += (int64_t) ((int32_t) (x_sum - handle->wind_direction_rotation_x_sum_last));
+            handle->wind_direction_trend_point_y += (int64_t) ((int32_t) (y_sum - handle->wind_direction_rotation_y_sum_last));
+            handle->wind_direction_weight_sum += (uint64_t) (count - handle->wind_direction_rotation_count_last);
+            handle->wind_direction_data_count += (count - handle->wind_direction_rotation_count_last);
+        }
+        handle->wind_direction_rotation_x_sum_last = x_sum;
+        handle->wind_direction_rotation_y_sum_last = y_sum;
+        handle->wind_direction_rotation_count_last = count;
+    }
+}
+#endif
+
+/*******************************************************************/
+static uint64_t _ULTIMETER_sqrt(uint64_t value) {
+    // Local variables.
+    uint64_t result = 0;
+    uint64_t bit = (((uint64_t) 1) << 62);
+    // Bitwise integer square root.
+    while (bit > value) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (value >= (result + bit)) {
+            value -= (result + bit);
+            result = (result >> 1) + bit;
+        }
+        else {
+            result >>= 1;
+        }
+        bit >>= 2;
+    }
+    return result;
+}
+#endif /* ULTIMETER_DRIVER_WIND_SPEED_ONLY */
+
+#ifdef ULTIMETER_DRIVER_SLIDING_WINDOW_LONG_SAMPLES
+/*******************************************************************/
+static uint32_t _ULTIMETER_sliding_window_get_position(ULTIMETER_handle_t* handle, uint32_t age) {
+    // Local variables.
+    uint32_t position = handle->sliding_window_position;
+    // Go back in the circular buffer.
+    return ((position >= age) ? (position - age) : (position + ULTIMETER_DRIVER_SLIDING_WINDOW_LONG_SAMPLES - age));
+}
+
+/*******************************************************************/
+static void _ULTIMETER_sliding_window_get_vector(uint16_t weight, uint16_t wind_direction_angle, int32_t* x, int32_t* y) {
+    // Reset vector.
+    (*x) = 0;
+    (*y) = 0;
+    // Vector weighted by the number of rotations of the window, as for the average direction.
+    if (wind_direction_angle != ULTIMETER_SLIDING_WINDOW_DIRECTION_ERROR_VALUE) {
+        ULTIMETER_MATH_get_unit_vector(wind_direction_angle, x, y);
+        (*x) *= ((int32_t) weight);
+        (*y) *= ((int32_t) weight);
+    }
+}
+
+/*******************************************************************/
+static void _ULTIMETER_sliding_window_remove(ULTIMETER_handle_t* handle, uint32_t position, uint32_t* speed_sum, int64_t* trend_point_x, int64_t* trend_point_y) {
+    // Local variables.
+    int32_t x = 0;
+    int32_t y = 0;
+    // Remove sample from running sums.
+    _ULTIMETER_sliding_window_get_vector(handle->sliding_window_direction_weight[position], handle->sliding_window_direction_angle[position], &x, &y);
+    (*speed_sum) -= handle->sliding_window_speed_mh[position];
+    if (trend_point_x != NULL) {
+        (*trend_point_x) -= (int64_t) x;
+        (*trend_point_y) -= (int64_t) y;
+    }
+}
+
+/*******************************************************************/
+static void _ULTIMETER_sliding_window_add(ULTIMETER_handle_t* handle, ULTIMETER_wind_speed_window_t* window, uint32_t wind_direction_angle) {
+    // Local variables.
+    uint32_t wind_speed_mh = window->wind_speed_mh;
+    uint32_t position = handle->sliding_window_position;
+    uint32_t count = handle->sliding_window_count;
+    uint16_t direction = ULTIMETER_SLIDING_WINDOW_DIRECTION_ERROR_VALUE;
+    uint16_t weight = (window->edge_count > 0xFFFF) ? 0xFFFF : ((uint16_t) window->edge_count);
+    uint32_t deque_position = 0;
+    int32_t x = 0;
+    int32_t y = 0;
+    // Direction is only relevant if there is wind.
+    if (((wind_speed_mh / 1000) > 0) && (wind_direction_angle != ULTIMETER_WIND_DIRECTION_ERROR_VALUE)) {
+        direction = (uint16_t) wind_direction_angle;
+    }
+    // Remove samples which leave each window.
+    if (count >= ULTIMETER_DRIVER_SLIDING_WINDOW_LONG_SAMPLES) {
+        _ULTIMETER_sliding_window_remove(handle, position, &(handle->sliding_window_long_speed_sum), &(handle->sliding_window_long_trend_point_x), &(handle->sliding_window_long_trend_point_y));
+    }
+    if (count >= ULTIMETER_DRIVER_SLIDING_WINDOW_SHORT_SAMPLES) {
+        _ULTIMETER_sliding_window_remove(handle, _ULTIMETER_sliding_window_get_position(handle, ULTIMETER_DRIVER_SLIDING_WINDOW_SHORT_SAMPLES), &(handle->sliding_window_short_speed_sum), &(handle->sliding_window_short_trend_point_x), &(handle->sliding_window_short_trend_point_y));
+    }
+    if (count >= ULTIMETER_DRIVER_SLIDING_WINDOW_GUST_SAMPLES) {
+        _ULTIMETER_sliding_window_remove(handle, _ULTIMETER_sliding_window_get_position(handle, ULTIMETER_DRIVER_SLIDING_WINDOW_GUST_SAMPLES), &(handle->sliding_window_gust_speed_sum), NULL, NULL);
+    }
+    // Store new sample.
+    handle->sliding_window_speed_mh[position] = wind_speed_mh;
+    handle->sliding_window_direction_angle[position] = direction;
+    handle->sliding_window_direction_weight[position] = weight;
+    // Add sample to running sums.
+    _ULTIMETER_sliding_window_get_vector(weight, direction, &x, &y);
+    handle->sliding_window_long_speed_sum += wind_speed_mh;
+    handle->sliding_window_long_trend_point_x += (int64_t) x;
+    handle->sliding_window_long_trend_point_y += (int64_t) y;
+    handle->sliding_window_short_speed_sum += wind_speed_mh;
+    handle->sliding_window_short_trend_point_x += (int64_t) x;
+    handle->sliding_window_short_trend_point_y += (int64_t) y;
+    handle->sliding_window_gust_speed_sum += wind_speed_mh;
+    // Update gust maximum monotonic deque once the first gust window is complete.
+    if ((count + 1) >= ULTIMETER_DRIVER_SLIDING_WINDOW_GUST_SAMPLES) {
+        // Remove older values which can not be the maximum anymore.
+        while (handle->sliding_window_gust_deque_count > 0) {
+            deque_position = (handle->sliding_window_gust_deque_head + handle->sliding_window_gust_deque_count - 1) % ULTIMETER_DRIVER_SLIDING_WINDOW_LONG_SAMPLES;
+            if (handle->sliding_window_gust_deque_sum[deque_position] > handle->sliding_window_gust_speed_sum) break;
+            handle->sliding_window_gust_deque_count--;
+        }
+        // Push new value.
+        deque_position = (handle->sliding_window_gust_deque_head + handle->sliding_window_gust_deque_count) % ULTIMETER_DRIVER_SLIDING_WINDOW_LONG_SAMPLES;
+        handle->sliding_window_gust_deque_sum[deque_position] = handle->sliding_window_gust_speed_sum;
+        handle->sliding_window_gust_deque_sequence[deque_position] = handle->sliding_window_sequence;
+        handle->sliding_window_gust_deque_count++;
+        // Remove maximum if it is out of the long window.
+        if ((handle->sliding_window_sequence - handle->sliding_window_gust_deque_sequence[handle->sliding_window_gust_deque_head]) >= ULTIMETER_DRIVER_SLIDING_WINDOW_LONG_SAMPLES) {
+            handle->sliding_window_gust_deque_head = (handle->sliding_window_gust_deque_head + 1) % ULTIMETER_DRIVER_SLIDING_WINDOW_LONG_SAMPLES;
+            handle->sliding_window_gust_deque_count--;
+        }
+    }
+    // Update indexes.
+    handle->sliding_window_position = ((position + 1) >= ULTIMETER_DRIVER_SLIDING_WINDOW_LONG_SAMPLES) ? 0 : (position + 1);
+    handle->sliding_window_sequence++;
+    if (count < ULTIMETER_DRIVER_SLIDING_WINDOW_LONG_SAMPLES) {
+        handle->sliding_window_count++;
+    }
+}
+
+/*******************************************************************/
+static void _ULTIMETER_sliding_window_reset(ULTIMETER_handle_t* handle) {
+    // Indexes.
+    handle->sliding_window_position = 0;
+    handle->sliding_window_count = 0;
+    handle->sliding_window_sequence = 0;
+    // Running sums.
+    handle->sliding_window_long_speed_sum = 0;
+    handle->sliding_window_long_trend_point_x = 0;
+    handle->sliding_window_long_trend_point_y = 0;
+    handle->sliding_window_short_speed_sum = 0;
+    handle->sliding_window_short_trend_point_x = 0;
+    handle->sliding_window_short_trend_point_y = 0;
+    handle->sliding_window_gust_speed_sum = 0;
+    // Gust deque.
+    handle->sliding_window_gust_deque_head = 0;
+    handle->sliding_window_gust_deque_count = 0;
+}
+#endif
+
+#ifdef ULTIMETER_DRIVER_WIND_ROSE_SECTORS
+/*******************************************************************/
+static void _ULTIMETER_wind_rose_add(ULTIMETER_handle_t* handle, uint32_t wind_speed_mh, uint32_t wind_direction_angle) {
+    // Local variables.
+    uint16_t* count = &(handle->wind_rose_calm_count);
+    uint32_t sector = 0;
+    uint32_t bin = 0;
+    // Select counter, direction is only relevant if there is wind.
+    if (((wind_speed_mh / 1000) > 0) && (wind_direction_angle != ULTIMETER_WIND_DIRECTION_ERROR_VALUE)) {
+        // Sectors are centered on their direction (first one on north).
+        sector = ((((wind_direction_angle * 2 * ULTIMETER_DRIVER_WIND_ROSE_SECTORS) + ULTIMETER_WIND_DIRECTION_FULL_TURN) / (2 * ULTIMETER_WIND_DIRECTION_FULL_TURN)) % ULTIMETER_DRIVER_WIND_ROSE_SECTORS);
+        // Last bin includes all higher speeds.
+        bin = (wind_speed_mh / ULTIMETER_DRIVER_WIND_ROSE_SPEED_BIN_WIDTH_MH);
+        if (bin >= ULTIMETER_DRIVER_WIND_ROSE_SPEED_BINS) {
+            bin = (ULTIMETER_DRIVER_WIND_ROSE_SPEED_BINS - 1);
+        }
+        count = &(handle->wind_rose_count[sector][bin]);
+    }
+    // Saturating increment.
+    if ((*count) < ULTIMETER_WIND_ROSE_COUNT_MAX) {
+        (*count)++;
+    }
+}
+
+/*******************************************************************/
+static void _ULTIMETER_wind_rose_pack(uint16_t count, uint16_t full_scale_count, uint8_t bits_per_counter, uint8_t* buffer, uint32_t* bit_index) {
+    // Local variables.
+    uint32_t value_max = ((((uint32_t) 1) << bits_per_counter) - 1);
+    uint32_t value = ((((uint32_t) count) * value_max) + (full_scale_count / 2)) / full_scale_count;
+    uint8_t idx = 0;
+    // Keep non-zero counters visible.
+    if ((count != 0) && (value == 0)) {
+        value = 1;
+    }
+    // Write bits MSB first.
+    for (idx = 0; idx < bits_per_counter; idx++) {
+        if ((value & (((uint32_t) 1) << (bits_per_counter - 1 - idx))) != 0) {
+            buffer[(*bit_index) >> 3] |= (uint8_t) (0x80 >> ((*bit_index) & 0x07));
+        }
+        (*bit_index)++;
+    }
+}
+#endif
+
+#ifdef ULTIMETER_DRIVER_RECORDER
+/*******************************************************************/
+static void _ULTIMETER_record_window(ULTIMETER_handle_t* handle, uint32_t wind_speed_mh, uint32_t wind_speed_mh_window_peak, uint32_t wind_direction_angle) {
+    // Local variables.
+    ULTIMETER_RECORDER_sample_t sample;
+    // Check recorder.
+    if (handle->recorder == NULL) return;
+    // Build sample, direction is only relevant if there is wind.
+    sample.wind_speed_mh = wind_speed_mh;
+    sample.peak_wind_speed_mh = wind_speed_mh_window_peak;
+    sample.wind_direction_degrees = 0;
+    sample.direction_status = ULTIMETER_WIND_DIRECTION_STATUS_UNDEFINED;
+    if (((wind_speed_mh / 1000) > 0) && (wind_direction_angle != ULTIMETER_WIND_DIRECTION_ERROR_VALUE)) {
+        sample.wind_direction_degrees = ULTIMETER_MATH_get_wind_direction_degrees(wind_direction_angle);
+        sample.direction_status = ULTIMETER_WIND_DIRECTION_STATUS_AVAILABLE;
+    }
+    // Dropped samples are counted by the recorder.
+    ULTIMETER_RECORDER_append(handle->recorder, &sample);
+}
+#endif
+
+#ifdef ULTIMETER_DRIVER_SINK_BATCH_RECORDS
+/*******************************************************************/
+static void _ULTIMETER_sink_flush(ULTIMETER_handle_t* handle) {
+    // Check callback and pending records.
+    if ((handle->sink_callback == NULL) || (handle->sink_record_count == 0)) return;
+    // Give the whole batch to the application.
+    handle->sink_callback(handle, handle->sink_records, handle->sink_record_count);
+    handle->sink_record_count = 0;
+}
+
+/*******************************************************************/
+static ULTIMETER_status_t _ULTIMETER_sink_push(ULTIMETER_handle_t* handle, uint8_t window_flags, uint32_t wind_speed_mh, uint32_t wind_speed_mh_window_peak) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    ULTIMETER_sink_record_t* record = NULL;
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+    int32_t average_direction_degrees = 0;
+    ULTIMETER_wind_direction_status_t direction_status = ULTIMETER_WIND_DIRECTION_STATUS_UNDEFINED;
+#endif
+    // Check callback.
+    if (handle->sink_callback == NULL) goto errors;
+    // Build record in place.
+    record = &(handle->sink_records[handle->sink_record_count]);
+    record->sequence = handle->snapshot_sequence;
+    record->wind_speed_mh = wind_speed_mh;
+    record->peak_wind_speed_mh = wind_speed_mh_window_peak;
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+    record->wind_direction_degrees = 0;
+    record->direction_status = ULTIMETER_WIND_DIRECTION_STATUS_UNDEFINED;
+    if ((window_flags & ULTIMETER_SINK_WINDOW_WIND_DIRECTION) != 0) {
+        // Average direction of the vectors added to the trend point during the direction period.
+        status = ULTIMETER_MATH_compute_trend_point_angle((handle->wind_direction_trend_point_x - handle->sink_trend_point_x_last), (handle->wind_direction_trend_point_y - handle->sink_trend_point_y_last), &average_direction_degrees, &direction_status);
+        handle->sink_trend_point_x_last = handle->wind_direction_trend_point_x;
+        handle->sink_trend_point_y_last = handle->wind_direction_trend_point_y;
+        if (status != ULTIMETER_SUCCESS) goto errors;
+        record->wind_direction_degrees = (int16_t) average_direction_degrees;
+        record->direction_status = (uint8_t) direction_status;
+    }
+    else if (((wind_speed_mh / 1000) > 0) && (handle->wind_direction_angle != ULTIMETER_WIND_DIRECTION_ERROR_VALUE)) {
+        // Direction of the last rotation is only relevant if there is wind.
+        record->wind_direction_degrees = (int16_t) ULTIMETER_MATH_get_wind_direction_degrees(handle->wind_direction_angle);
+        record->direction_status = ULTIMETER_WIND_DIRECTION_STATUS_AVAILABLE;
+    }
+#endif
+    record->window_flags = window_flags;
+    handle->sink_record_count++;
+    // Deliver records when the batch is full.
+    if (handle->sink_record_count >= ULTIMETER_DRIVER_SINK_BATCH_RECORDS) {
+        _ULTIMETER_sink_flush(handle);
+    }
+errors:
+    return status;
+}
+#endif
+
+/*******************************************************************/
+static void _ULTIMETER_get_accumulators(ULTIMETER_handle_t* handle, ULTIMETER_accumulators_t* accumulators) {
+    // Wind speed.
+    accumulators->sequence = handle->snapshot_sequence;
+    accumulators->wind_speed_data_count = handle->wind_speed_data_count;
+    accumulators->wind_speed_sum = handle->wind_speed_sum;
+    accumulators->wind_speed_seconds_sum = handle->wind_speed_seconds_sum;
+    accumulators->wind_speed_peak_sum = handle->wind_speed_peak_sum;
+    accumulators->wind_speed_peak_seconds = handle->wind_speed_peak_seconds;
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+    // Wind direction.
+    accumulators->wind_direction_data_count = handle->wind_direction_data_count;
+    accumulators->wind_direction_trend_point_x = handle->wind_direction_trend_point_x;
+    accumulators->wind_direction_trend_point_y = handle->wind_direction_trend_point_y;
+    accumulators->wind_direction_weight_sum = handle->wind_direction_weight_sum;
+#endif
+#ifdef ULTIMETER_DRIVER_WIND_SPEED_RECIPROCAL
+    accumulators->wind_speed_mh_gust = handle->wind_speed_mh_gust;
+#endif
+#ifdef ULTIMETER_DRIVER_SLIDING_WINDOW_LONG_SAMPLES
+    // Sliding windows running sums.
+    accumulators->sliding_window_count = handle->sliding_window_count;
+    accumulators->sliding_window_long_speed_sum = handle->sliding_window_long_speed_sum;
+    accumulators->sliding_window_long_trend_point_x = handle->sliding_window_long_trend_point_x;
+    accumulators->sliding_window_long_trend_point_y = handle->sliding_window_long_trend_point_y;
+    accumulators->sliding_window_short_speed_sum = handle->sliding_window_short_speed_sum;
+    accumulators->sliding_window_short_trend_point_x = handle->sliding_window_short_trend_point_x;
+    accumulators->sliding_window_short_trend_point_y = handle->sliding_window_short_trend_point_y;
+    // Maximum gust window sum is the head of the deque.
+    accumulators->sliding_window_gust_speed_sum_max = 0;
+    if (handle->sliding_window_gust_deque_count > 0) {
+        accumulators->sliding_window_gust_speed_sum_max = handle->sliding_window_gust_deque_sum[handle->sliding_window_gust_deque_head];
+    }
+#endif
+}
+
+/*******************************************************************/
+static void _ULTIMETER_compute_wind_speed(ULTIMETER_accumulators_t* accumulators, int32_t* average_speed_mh, int32_t* peak_speed_mh) {
+    // Divide the accumulated speeds by the accumulated durations.
+    (*average_speed_mh) = (accumulators->wind_speed_seconds_sum == 0) ? 0 : ((int32_t) (accumulators->wind_speed_sum / ((uint64_t) accumulators->wind_speed_seconds_sum)));
+    (*peak_speed_mh) = (accumulators->wind_speed_peak_seconds == 0) ? 0 : ((int32_t) (accumulators->wind_speed_peak_sum / accumulators->wind_speed_peak_seconds));
+}
+
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+/*******************************************************************/
+static ULTIMETER_status_t _ULTIMETER_compute_wind_direction_statistics(ULTIMETER_accumulators_t* accumulators, ULTIMETER_wind_direction_statistics_t* direction_statistics) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    MATH_status_t math_status = MATH_SUCCESS;
+    int64_t trend_point_x = 0;
+    int64_t trend_point_y = 0;
+    uint64_t weight_sum = 0;
+    uint64_t resultant_length = 0;
+    uint64_t epsilon = 0;
+    int32_t epsilon_asin_degrees = 0;
+    uint8_t shift = 0;
+    // Reset output.
+    direction_statistics->average_direction_degrees = 0;
+    direction_statistics->steadiness_per_mille = 0;
+    direction_statistics->standard_deviation_degrees = 0;
+    direction_statistics->direction_status = ULTIMETER_WIND_DIRECTION_STATUS_UNDEFINED;
+    // Mean direction.
+    status = ULTIMETER_MATH_compute_trend_point_angle(accumulators->wind_direction_trend_point_x, accumulators->wind_direction_trend_point_y, &(direction_statistics->average_direction_degrees), &(direction_statistics->direction_status));
+    if (status != ULTIMETER_SUCCESS) goto errors;
+    if (direction_statistics->direction_status != ULTIMETER_WIND_DIRECTION_STATUS_AVAILABLE) goto errors;
+    // Mean resultant length (trend point norm divided by the sum of weighted unit vectors norms).
+    trend_point_x = accumulators->wind_direction_trend_point_x;
+    trend_point_y = accumulators->wind_direction_trend_point_y;
+    shift = ULTIMETER_MATH_scale_trend_point(&trend_point_x, &trend_point_y);
+    weight_sum = ((accumulators->wind_direction_weight_sum * ((uint64_t) MATH_COS_TABLE[0])) >> shift);
+    if (weight_sum == 0) goto errors;
+    resultant_length = _ULTIMETER_sqrt((uint64_t) ((trend_point_x * trend_point_x) + (trend_point_y * trend_point_y)));
+    resultant_length = ((resultant_length * 1000) / weight_sum);
+    if (resultant_length > 1000) {
+        resultant_length = 1000;
+    }
+    direction_statistics->steadiness_per_mille = (uint32_t) resultant_length;
+    // Yamartino standard deviation: asin(epsilon) * (1 + 0.1547 * epsilon^3) with epsilon = sqrt(1 - R^2).
+    epsilon = _ULTIMETER_sqrt(1000000 - (resultant_length * resultant_length));
+    // asin(epsilon) = atan2(epsilon, R) since R = sqrt(1 - epsilon^2).
+    math_status = MATH_atan2((int32_t) resultant_length, (int32_t) epsilon, &epsilon_asin_degrees);
+    MATH_exit_error(ULTIMETER_ERROR_BASE_MATH);
+    direction_statistics->standard_deviation_degrees = (uint32_t) (epsilon_asin_degrees + ((((uint64_t) epsilon_asin_degrees) * ULTIMETER_YAMARTINO_FACTOR * epsilon * epsilon * epsilon) / (((uint64_t) ULTIMETER_YAMARTINO_FACTOR_SCALE) * 1000000000)));
+errors:
+    return status;
+}
+#endif
+
+#ifdef ULTIMETER_DRIVER_SLIDING_WINDOW_LONG_SAMPLES
+/*******************************************************************/
+static ULTIMETER_status_t _ULTIMETER_compute_sliding_window_wind_speed(ULTIMETER_accumulators_t* accumulators, ULTIMETER_sliding_window_t window, int32_t* average_speed_mh) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    uint32_t count = 0;
+    uint32_t speed_sum = 0;
+    // Select window.
+    switch (window) {
+    case ULTIMETER_SLIDING_WINDOW_SHORT:
+        count = ULTIMETER_DRIVER_SLIDING_WINDOW_SHORT_SAMPLES;
+        speed_sum = accumulators->sliding_window_short_speed_sum;
+        break;
+    case ULTIMETER_SLIDING_WINDOW_LONG:
+        count = ULTIMETER_DRIVER_SLIDING_WINDOW_LONG_SAMPLES;
+        speed_sum = accumulators->sliding_window_long_speed_sum;
+        break;
+    default:
+        status = ULTIMETER_ERROR_SLIDING_WINDOW;
+        goto errors;
+    }
+    // Use the number of available samples until the window is full.
+    if (accumulators->sliding_window_count < count) {
+        count = accumulators->sliding_window_count;
+    }
+    (*average_speed_mh) = (count == 0) ? 0 : ((int32_t) (speed_sum / count));
+errors:
+    return status;
+}
+
+/*******************************************************************/
+static ULTIMETER_status_t _ULTIMETER_compute_sliding_window_wind_direction(ULTIMETER_accumulators_t* accumulators, ULTIMETER_sliding_window_t window, int32_t* average_direction_degrees, ULTIMETER_wind_direction_status_t* direction_status) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    // Select window.
+    switch (window) {
+    case ULTIMETER_SLIDING_WINDOW_SHORT:
+        status = ULTIMETER_MATH_compute_trend_point_angle(accumulators->sliding_window_short_trend_point_x, accumulators->sliding_window_short_trend_point_y, average_direction_degrees, direction_status);
+        break;
+    case ULTIMETER_SLIDING_WINDOW_LONG:
+        status = ULTIMETER_MATH_compute_trend_point_angle(accumulators->sliding_window_long_trend_point_x, accumulators->sliding_window_long_trend_point_y, average_direction_degrees, direction_status);
+        break;
+    default:
+        status = ULTIMETER_ERROR_SLIDING_WINDOW;
+        break;
+    }
+    return status;
+}
+#endif
+
+/*******************************************************************/
+static ULTIMETER_status_t _ULTIMETER_compute_snapshot(ULTIMETER_accumulators_t* accumulators, ULTIMETER_snapshot_t* snapshot) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+#ifdef ULTIMETER_DRIVER_SLIDING_WINDOW_LONG_SAMPLES
+    ULTIMETER_sliding_window_t window = ULTIMETER_SLIDING_WINDOW_SHORT;
+#endif
+    // Counters.
+    snapshot->sequence = accumulators->sequence;
+    snapshot->wind_speed_sample_count = accumulators->wind_speed_data_count;
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+    snapshot->wind_direction_sample_count = accumulators->wind_direction_data_count;
+#endif
+    // Statistics.
+    _ULTIMETER_compute_wind_speed(accumulators, &(snapshot->average_speed_mh), &(snapshot->peak_speed_mh));
+#ifdef ULTIMETER_DRIVER_WIND_SPEED_RECIPROCAL
+    snapshot->instantaneous_gust_speed_mh = (int32_t) (accumulators->wind_speed_mh_gust);
+#endif
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+    status = _ULTIMETER_compute_wind_direction_statistics(accumulators, &(snapshot->direction_statistics));
+    if (status != ULTIMETER_SUCCESS) goto errors;
+#endif
+#ifdef ULTIMETER_DRIVER_SLIDING_WINDOW_LONG_SAMPLES
+    for (window = 0; window < ULTIMETER_SLIDING_WINDOW_LAST; window++) {
+        status = _ULTIMETER_compute_sliding_window_wind_speed(accumulators, window, &(snapshot->sliding_window_average_speed_mh[window]));
+        if (status != ULTIMETER_SUCCESS) goto errors;
+        status = _ULTIMETER_compute_sliding_window_wind_direction(accumulators, window, &(snapshot->sliding_window_average_direction_degrees[window]), &(snapshot->sliding_window_direction_status[window]));
+        if (status != ULTIMETER_SUCCESS) goto errors;
+    }
+    snapshot->sliding_window_gust_speed_mh = (int32_t) (accumulators->sliding_window_gust_speed_sum_max / ULTIMETER_DRIVER_SLIDING_WINDOW_GUST_SAMPLES);
+#endif
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+errors:
+#endif
+    return status;
+}
+
+/*******************************************************************/
+static void _ULTIMETER_publish_snapshot(ULTIMETER_handle_t* handle) {
+    // Local variables.
+    ULTIMETER_accumulators_t accumulators;
+    uint32_t sequence = (handle->snapshot_sequence + 1);
+    // Copy raw values only, statistics are computed when the snapshot is read.
+    _ULTIMETER_get_accumulators(handle, &accumulators);
+    accumulators.sequence = sequence;
+    // Write the buffer which is not read, then switch buffers.
+    handle->snapshot[sequence & 0x01] = accumulators;
+    handle->snapshot_sequence = sequence;
+}
+
+#ifdef ULTIMETER_DRIVER_STATE
+/*******************************************************************/
+static void _ULTIMETER_state_write(uint8_t* state, uint32_t* idx, uint64_t value, uint8_t size_bytes) {
+    // Local variables.
+    uint8_t byte_idx = 0;
+    // Little endian order.
+    for (byte_idx = 0; byte_idx < size_bytes; byte_idx++) {
+        state[(*idx)++] = (uint8_t) (value >> (8 * byte_idx));
+    }
+}
+
+/*******************************************************************/
+static uint64_t _ULTIMETER_state_read(uint8_t* state, uint32_t* idx, uint8_t size_bytes) {
+    // Local variables.
+    uint64_t value = 0;
+    uint8_t byte_idx = 0;
+    // Little endian order.
+    for (byte_idx = 0; byte_idx < size_bytes; byte_idx++) {
+        value |= (((uint64_t) state[(*idx)++]) << (8 * byte_idx));
+    }
+    return value;
+}
+
+/*******************************************************************/
+static uint16_t _ULTIMETER_state_compute_crc16(uint8_t* data, uint32_t size_bytes) {
+    // Local variables.
+    uint16_t crc = ULTIMETER_STATE_CRC16_INIT;
+    uint32_t idx = 0;
+    uint8_t bit_idx = 0;
+    // CRC16-CCITT bitwise computation (the state is only processed at startup and before sleep).
+    for (idx = 0; idx < size_bytes; idx++) {
+        crc ^= (uint16_t) (((uint16_t) data[idx]) << 8);
+        for (bit_idx = 0; bit_idx < 8; bit_idx++) {
+            crc = ((crc & 0x8000) != 0) ? (uint16_t) ((crc << 1) ^ ULTIMETER_STATE_CRC16_POLYNOMIAL) : (uint16_t) (crc << 1);
+        }
+    }
+    return crc;
+}
+#endif
+
+/*** ULTIMETER functions ***/
+
+/*******************************************************************/
+ULTIMETER_status_t ULTIMETER_init(ULTIMETER_handle_t* handle, ULTIMETER_configuration_t* configuration) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    ULTIMETER_HW_configuration_t hw_config;
+    uint8_t timer_counter_width = 0;
+#ifdef ULTIMETER_DRIVER_TICKLESS
+    uint32_t timer_frequency_hz = 0;
+#endif
+    // Check parameters.
+    if ((handle == NULL) || (configuration == NULL)) {
+        status = ULTIMETER_ERROR_NULL_PARAMETER;
+        goto errors;
+    }
+    if (configuration->process_callback == NULL) {
+        status = ULTIMETER_ERROR_NULL_PARAMETER;
+        goto errors;
+    }
+    // Reset data.
+    handle->snapshot_sequence = 0;
+#ifdef ULTIMETER_DRIVER_WIND_DIRECTION_PER_ROTATION
+    handle->wind_direction_rotation_x_sum = 0;
+    handle->wind_direction_rotation_y_sum = 0;
+    handle->wind_direction_rotation_count = 0;
+#endif
+#ifdef ULTIMETER_DRIVER_SLIDING_WINDOW_LONG_SAMPLES
+    _ULTIMETER_sliding_window_reset(handle);
+#endif
+    ULTIMETER_reset_measurements(handle);
+#ifdef ULTIMETER_DRIVER_RECORDER
+    handle->recorder = NULL;
+#endif
+#ifdef ULTIMETER_DRIVER_SINK_BATCH_RECORDS
+    handle->sink_callback = (configuration->sink_callback);
+    handle->sink_record_count = 0;
+#endif
+#ifdef ULTIMETER_DRIVER_DIAGNOSTICS
+    handle->diagnostics_wind_speed_edge_irq_count = 0;
+    handle->diagnostics_wind_direction_edge_irq_count = 0;
+    handle->diagnostics_tick_irq_count = 0;
+    handle->diagnostics_process_count = 0;
+    handle->diagnostics_wind_direction_missing_count = 0;
+    handle->diagnostics_wind_direction_rejected_count = 0;
+    handle->diagnostics_missed_tick_count = 0;
+    _ULTIMETER_diagnostics_reset_cycles(&(handle->diagnostics_wind_speed_edge_irq_cycles));
+    _ULTIMETER_diagnostics_reset_cycles(&(handle->diagnostics_wind_direction_edge_irq_cycles));
+    _ULTIMETER_diagnostics_reset_cycles(&(handle->diagnostics_tick_irq_cycles));
+    _ULTIMETER_diagnostics_reset_cycles(&(handle->diagnostics_process_cycles));
+#endif
+#ifdef ULTIMETER_DRIVER_WIND_ROSE_SECTORS
+    ULTIMETER_reset_wind_rose(handle);
+#endif
+    // Init context.
+    handle->instance = (configuration->instance);
+    handle->wind_measurement_enable_flag = 0;
+    handle->tick_second_flag = 0;
+    handle->process_callback = (configuration->process_callback);
+    handle->wind_speed_sampling_time_seconds = (uint8_t) ULTIMETER_DRIVER_WIND_SPEED_SAMPLING_TIME_SECONDS;
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+    handle->wind_direction_sampling_period_seconds = ULTIMETER_DRIVER_WIND_DIRECTION_SAMPLING_PERIOD_SECONDS;
+    handle->wind_direction_enable_flag = 1;
+#endif
+#ifdef ULTIMETER_DRIVER_ADAPTIVE_SAMPLING
+    handle->adaptive_sampling_enable_flag = 0;
+#endif
+#ifdef ULTIMETER_DRIVER_DUTY_CYCLE
+    handle->duty_cycle_burst_seconds = 0;
+    handle->duty_cycle_period_seconds = 0;
+    handle->duty_cycle_seconds_count = 0;
+    handle->duty_cycle_capture_flag = 0;
+#endif
+    // Init hardware interface.
+    hw_config.handle = handle;
+    hw_config.wind_speed_edge_irq_callback = &_ULTIMETER_wind_speed_edge_callback;
+#ifdef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+    // Direction input is not used.
+    hw_config.wind_direction_edge_irq_callback = NULL;
+#else
+    hw_config.wind_direction_edge_irq_callback = &_ULTIMETER_wind_direction_edge_callback;
+#endif
+    hw_config.tick_second_irq_callback = &_ULTIMETER_tick_second_callback;
+    status = ULTIMETER_HW_init(handle->instance, &hw_config);
+    if (status != ULTIMETER_SUCCESS) goto errors;
+    // Read timer counter width.
+    timer_counter_width = ULTIMETER_HW_timer_get_counter_width(handle->instance);
+    if ((timer_counter_width < ULTIMETER_TIMER_COUNTER_WIDTH_MIN) || (timer_counter_width > ULTIMETER_TIMER_COUNTER_WIDTH_MAX)) {
+        status = ULTIMETER_ERROR_TIMER_COUNTER_WIDTH;
+        goto errors;
+    }
+    handle->timer_counter_mask = (timer_counter_width == ULTIMETER_TIMER_COUNTER_WIDTH_MAX) ? 0xFFFFFFFF : ((((uint32_t) 1) << timer_counter_width) - 1);
+#if ((defined ULTIMETER_DRIVER_WIND_SPEED_RECIPROCAL) || (defined ULTIMETER_DRIVER_DEBOUNCE_WIND_SPEED_MAX_MH))
+    // Read timer frequency.
+    handle->timer_frequency_hz = ULTIMETER_HW_timer_get_frequency_hz(handle->instance);
+    if (handle->timer_frequency_hz == 0) {
+        status = ULTIMETER_ERROR_TIMER_FREQUENCY;
+        goto errors;
+    }
+#endif
+#ifdef ULTIMETER_DRIVER_DEBOUNCE_WIND_SPEED_MAX_MH
+    // Rotation period at the maximum wind speed.
+    handle->debounce_period_min = (uint32_t) ((((uint64_t) ULTIMETER_WIND_SPEED_1HZ_TO_MH) * ((uint64_t) handle->timer_frequency_hz)) / ((uint64_t) ULTIMETER_DRIVER_DEBOUNCE_WIND_SPEED_MAX_MH));
+    if (handle->debounce_period_min == 0) {
+        handle->debounce_period_min = 1;
+    }
+#endif
+#ifdef ULTIMETER_DRIVER_TICKLESS
+    handle->alarm_delay_seconds_max = ULTIMETER_ALARM_DELAY_SECONDS_MAX;
+    if (timer_counter_width < ULTIMETER_TIMER_COUNTER_WIDTH_MAX) {
+        // The software extension can not detect more than one wrap of narrow counters between two alarms.
+        timer_frequency_hz = ULTIMETER_HW_timer_get_frequency_hz(handle->instance);
+        if (timer_frequency_hz == 0) {
+            status = ULTIMETER_ERROR_TIMER_FREQUENCY;
+            goto errors;
+        }
+        // Longest delay strictly below one wrap period (the tick period is the minimum).
+        if ((handle->timer_counter_mask / timer_frequency_hz) < handle->alarm_delay_seconds_max) {
+            handle->alarm_delay_seconds_max = (handle->timer_counter_mask / timer_frequency_hz);
+        }
+        if (handle->alarm_delay_seconds_max == 0) {
+            handle->alarm_delay_seconds_max = 1;
+        }
+    }
+#endif
+errors:
+    return status;
+}
+
+/*******************************************************************/
+ULTIMETER_status_t ULTIMETER_de_init(ULTIMETER_handle_t* handle) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    // Check parameter.
+    if (handle == NULL) {
+        status = ULTIMETER_ERROR_NULL_PARAMETER;
+        goto errors;
+    }
+    // Release hardware interface.
+    status = ULTIMETER_HW_de_init(handle->instance);
+    if (status != ULTIMETER_SUCCESS) goto errors;
+errors:
+    return status;
+}
+
+/*******************************************************************/
+ULTIMETER_status_t ULTIMETER_set_wind_measurement(ULTIMETER_handle_t* handle, uint8_t enable) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    // Check parameter.
+    if (handle == NULL) {
+        status = ULTIMETER_ERROR_NULL_PARAMETER;
+        goto errors;
+    }
+    // Update local enable flag.
+    handle->wind_measurement_enable_flag = (enable != 0) ? 1 : 0;
+    // Check enable bit.
+    if (enable == 0) {
+        // Stop timer and interrupts.
+        status = _ULTIMETER_stop_capture(handle, 1);
+        if (status != ULTIMETER_SUCCESS) goto errors;
+#ifdef ULTIMETER_DRIVER_DUTY_CYCLE
+        handle->duty_cycle_capture_flag = 0;
+#endif
+#ifdef ULTIMETER_DRIVER_TICKLESS
+        // Cancel alarm.
+        handle->alarm_delay_seconds = 0;
+        ULTIMETER_HW_set_alarm(handle->instance, 0);
+#endif
+        // Reset second counters.
+        handle->wind_speed_seconds_count = 0;
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+        handle->wind_direction_seconds_count = 0;
+#endif
+        handle->tick_second_flag = 0;
+#ifdef ULTIMETER_DRIVER_SINK_BATCH_RECORDS
+        // No window will be closed anymore.
+        _ULTIMETER_sink_flush(handle);
+#endif
+    }
+    else {
+#ifdef ULTIMETER_DRIVER_DUTY_CYCLE
+        // Start with a burst.
+        handle->duty_cycle_seconds_count = 0;
+        handle->duty_cycle_capture_flag = 1;
+#endif
+        // Start timer and interrupts.
+        status = _ULTIMETER_start_capture(handle, 1);
+        if (status != ULTIMETER_SUCCESS) goto errors;
+#ifdef ULTIMETER_DRIVER_TICKLESS
+        // Program first wake-up.
+        status = _ULTIMETER_set_next_alarm(handle);
+        if (status != ULTIMETER_SUCCESS) goto errors;
+#endif
+    }
+errors:
+    return status;
+}
+
+/*******************************************************************/
+ULTIMETER_status_t ULTIMETER_process(ULTIMETER_handle_t* handle) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    ULTIMETER_wind_speed_window_t window;
+    uint8_t publish_flag = 0;
+#ifdef ULTIMETER_DRIVER_SINK_BATCH_RECORDS
+    uint8_t window_flags = 0;
+#endif
+#ifdef ULTIMETER_DRIVER_DIAGNOSTICS
+    uint32_t start_cycles = 0;
+#endif
+    // Check parameter.
+    if (handle == NULL) {
+        status = ULTIMETER_ERROR_NULL_PARAMETER;
+        goto errors;
+    }
+    // Check flag.
+    if (handle->tick_second_flag == 0) goto errors;
+    // Clear flag.
+    handle->tick_second_flag = 0;
+    ULTIMETER_DIAGNOSTICS_start(start_cycles);
+    ULTIMETER_DIAGNOSTICS_increment(process_count);
+    // No wind speed window closed yet.
+    window.edge_count = 0;
+    window.seconds = 0;
+    window.sum = 0;
+#ifdef ULTIMETER_WINDOW_SPEED_REQUIRED
+    window.wind_speed_mh = 0;
+    window.peak_wind_speed_mh = 0;
+#endif
+#ifdef ULTIMETER_DRIVER_EDGE_BUFFER_SIZE
+    // Process deferred edges.
+    _ULTIMETER_edge_buffer_drain(handle);
+#endif
+#ifdef ULTIMETER_DRIVER_WIND_DIRECTION_RECIPROCAL
+    // Refine the period reciprocal outside of the edge interrupt.
+    _ULTIMETER_update_wind_direction(handle);
+#endif
+    // Update wind speed if period is reached.
+    if (handle->wind_speed_seconds_count >= handle->wind_speed_sampling_time_seconds) {
+        // Read window and update accumulators.
+        _ULTIMETER_close_wind_speed_window(handle, &window);
+        _ULTIMETER_add_wind_speed_window(handle, &window);
+#if ((!defined ULTIMETER_DRIVER_WIND_SPEED_ONLY) && (!defined ULTIMETER_DRIVER_WIND_DIRECTION_PER_ROTATION))
+        _ULTIMETER_add_window_trend_point(handle, &window);
+#endif
+#ifdef ULTIMETER_DRIVER_SLIDING_WINDOW_LONG_SAMPLES
+        // Update sliding windows.
+        _ULTIMETER_sliding_window_add(handle, &window, handle->wind_direction_angle);
+#endif
+#ifdef ULTIMETER_DRIVER_WIND_ROSE_SECTORS
+        // Update wind rose.
+        _ULTIMETER_wind_rose_add(handle, window.wind_speed_mh, handle->wind_direction_angle);
+#endif
+#ifdef ULTIMETER_DRIVER_RECORDER
+        // Record window.
+        _ULTIMETER_record_window(handle, window.wind_speed_mh, window.peak_wind_speed_mh, handle->wind_direction_angle);
+#endif
+#ifdef ULTIMETER_DRIVER_ADAPTIVE_SAMPLING
+        // Update windows according to wind conditions.
+        status = _ULTIMETER_adaptive_sampling_update(handle, window.wind_speed_mh);
+        if (status != ULTIMETER_SUCCESS) goto errors;
+#endif
+#ifdef ULTIMETER_DRIVER_SINK_BATCH_RECORDS
+        window_flags |= ULTIMETER_SINK_WINDOW_WIND_SPEED;
+#endif
+        publish_flag = 1;
+    }
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+    // Update wind direction if period is reached.
+    if (handle->wind_direction_seconds_count >= handle->wind_direction_sampling_period_seconds) {
+        // Reset seconds counter.
+        handle->wind_direction_seconds_count = 0;
+#ifdef ULTIMETER_DRIVER_WIND_DIRECTION_PER_ROTATION
+        // Add all the rotations of the period.
+        _ULTIMETER_fold_rotation_vectors(handle, 1);
+#endif
+#ifdef ULTIMETER_DRIVER_SINK_BATCH_RECORDS
+        window_flags |= ULTIMETER_SINK_WINDOW_WIND_DIRECTION;
+#endif
+        publish_flag = 1;
+    }
+#endif
+#ifdef ULTIMETER_DRIVER_DUTY_CYCLE
+    // Start or stop the capture according to the bursts schedule.
+    status = _ULTIMETER_duty_cycle_update(handle);
+    if (status != ULTIMETER_SUCCESS) goto errors;
+#endif
+    // Publish new measurements.
+    if (publish_flag != 0) {
+        _ULTIMETER_publish_snapshot(handle);
+#ifdef ULTIMETER_DRIVER_SINK_BATCH_RECORDS
+        // Push window record.
+        status = _ULTIMETER_sink_push(handle, window_flags, window.wind_speed_mh, window.peak_wind_speed_mh);
+        if (status != ULTIMETER_SUCCESS) goto errors;
+#endif
+    }
+    ULTIMETER_DIAGNOSTICS_stop(start_cycles, process_cycles);
+errors:
+    return status;
+}
+
+/*******************************************************************/
+ULTIMETER_status_t ULTIMETER_get_wind_speed(ULTIMETER_handle_t* handle, int32_t* average_speed_mh, int32_t* peak_speed_mh) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    ULTIMETER_accumulators_t accumulators;
+    // Check parameters.
+    if ((handle == NULL) || (average_speed_mh == NULL) || (peak_speed_mh == NULL)) {
+        status = ULTIMETER_ERROR_NULL_PARAMETER;
+        goto errors;
+    }
+    _ULTIMETER_get_accumulators(handle, &accumulators);
+    _ULTIMETER_compute_wind_speed(&accumulators, average_speed_mh, peak_speed_mh);
+errors:
+    return status;
+}
+
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+/*******************************************************************/
+ULTIMETER_status_t ULTIMETER_get_wind_direction(ULTIMETER_handle_t* handle, int32_t* average_direction_degrees, ULTIMETER_wind_direction_status_t* direction_status) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    // Check parameters.
+    if ((handle == NULL) || (average_direction_degrees == NULL) || (direction_status == NULL)) {
+        status = ULTIMETER_ERROR_NULL_PARAMETER;
+        goto errors;
+    }
+    // Compute trend point angle.
+    status = ULTIMETER_MATH_compute_trend_point_angle(handle->wind_direction_trend_point_x, handle->wind_direction_trend_point_y, average_direction_degrees, direction_status);
+    if (status != ULTIMETER_SUCCESS) goto errors;
+errors:
+    return status;
+}
+
+/*******************************************************************/
+ULTIMETER_status_t ULTIMETER_get_wind_direction_statistics(ULTIMETER_handle_t* handle, ULTIMETER_wind_direction_statistics_t* direction_statistics) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    ULTIMETER_accumulators_t accumulators;
+    // Check parameters.
+    if ((handle == NULL) || (direction_statistics == NULL)) {
+        status = ULTIMETER_ERROR_NULL_PARAMETER;
+        goto errors;
+    }
+    _ULTIMETER_get_accumulators(handle, &accumulators);
+    status = _ULTIMETER_compute_wind_direction_statistics(&accumulators, direction_statistics);
+    if (status != ULTIMETER_SUCCESS) goto errors;
+errors:
+    return status;
+}
+#endif
+
+/*******************************************************************/
+ULTIMETER_status_t ULTIMETER_get_snapshot(ULTIMETER_handle_t* handle, ULTIMETER_snapshot_t* snapshot) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    ULTIMETER_accumulators_t accumulators;
+    uint32_t sequence = 0;
+    uint8_t idx = 0;
+    // Check parameters.
+    if ((handle == NULL) || (snapshot == NULL)) {
+        status = ULTIMETER_ERROR_NULL_PARAMETER;
+        goto errors;
+    }
+    for (idx = 0; idx < ULTIMETER_SNAPSHOT_READ_RETRY_MAX; idx++) {
+        // Copy the last published buffer.
+        sequence = handle->snapshot_sequence;
+        accumulators = handle->snapshot[sequence & 0x01];
+        // Copy is valid if the buffer has not been rewritten meanwhile.
+        if (handle->snapshot_sequence == sequence) break;
+    }
+    if (idx >= ULTIMETER_SNAPSHOT_READ_RETRY_MAX) {
+        status = ULTIMETER_ERROR_SNAPSHOT;
+        goto errors;
+    }
+    // Compute statistics in the caller context.
+    status = _ULTIMETER_compute_snapshot(&accumulators, snapshot);
+    if (status != ULTIMETER_SUCCESS) goto errors;
+errors:
+    return status;
+}
+
+/*******************************************************************/
+ULTIMETER_status_t ULTIMETER_reset_measurements(ULTIMETER_handle_t* handle) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    // Check parameter.
+    if (handle == NULL) {
+        status = ULTIMETER_ERROR_NULL_PARAMETER;
+        goto errors;
+    }
     // Wind speed.
-    volatile uint32_t wind_speed_counter_start;
-    volatile uint32_t wind_speed_counter_stop;
-    volatile uint8_t wind_speed_seconds_count;
-    volatile uint32_t wind_speed_edge_count;
-    uint32_t wind_speed_data_count;
-    uint32_t wind_speed_mh_average;
-    uint32_t wind_speed_mh_peak;
+    handle->wind_speed_period_valid_flag = 0;
+    handle->wind_speed_counter_start = 0;
+    handle->wind_speed_counter_stop = 0;
+    handle->wind_speed_seconds_count = 0;
+    handle->wind_speed_edge_count = 0;
+    handle->wind_speed_data_count = 0;
+    handle->wind_speed_sum = 0;
+    handle->wind_speed_seconds_sum = 0;
+    handle->wind_speed_peak_sum = 0;
+    handle->wind_speed_peak_seconds = 0;
+#ifdef ULTIMETER_DRIVER_WIND_SPEED_RECIPROCAL
+    handle->wind_speed_period_count = 0;
+    handle->wind_speed_period_sum = 0;
+    handle->wind_speed_period_min = 0xFFFFFFFF;
+    handle->wind_speed_mh_gust = 0;
+#endif
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
     // Wind direction.
-    volatile uint8_t wind_direction_irq_flag;
-    volatile uint32_t wind_direction_counter;
-    volatile uint32_t wind_direction_degrees;
-    volatile uint32_t wind_direction_seconds_count;
-    int32_t wind_direction_trend_point_x;
-    int32_t wind_direction_trend_point_y;
-} ULTIMETER_context_t;
-
-/*** ULTIMETER local global variables ***/
-
-static ULTIMETER_context_t ultimeter_ctx;
+    handle->wind_direction_irq_flag = 0;
+    handle->wind_direction_counter = 0;
+    handle->wind_direction_angle = 0;
+#ifdef ULTIMETER_DRIVER_WIND_DIRECTION_RECIPROCAL
+    handle->wind_direction_period_reciprocal = 0;
+    handle->wind_direction_period_shift = 0;
+    handle->wind_direction_period = 0;
+#ifndef ULTIMETER_DRIVER_WIND_DIRECTION_PER_ROTATION
+    handle->wind_direction_duty_cycle = 0;
+#endif
+#endif
+    handle->wind_direction_seconds_count = 0;
+    handle->wind_direction_trend_point_x = 0;
+    handle->wind_direction_trend_point_y = 0;
+    handle->wind_direction_weight_sum = 0;
+    handle->wind_direction_data_count = 0;
+#ifdef ULTIMETER_DRIVER_SINK_BATCH_RECORDS
+    handle->sink_trend_point_x_last = 0;
+    handle->sink_trend_point_y_last = 0;
+#endif
+#ifdef ULTIMETER_DRIVER_WIND_DIRECTION_PER_ROTATION
+    // Discard pending rotations.
+    _ULTIMETER_fold_rotation_vectors(handle, 0);
+#endif
+#endif /* ULTIMETER_DRIVER_WIND_SPEED_ONLY */
+#ifdef ULTIMETER_DRIVER_EDGE_BUFFER_SIZE
+    // Edge buffer (only consumer side indexes can be updated here).
+    handle->edge_buffer_read_index = handle->edge_buffer_write_index;
+    handle->edge_buffer_tick_index = handle->edge_buffer_read_index;
+    handle->edge_buffer_overflow_count = 0;
+    handle->edge_buffer_loss_flag = 0;
+#endif
+#ifdef ULTIMETER_DRIVER_DEBOUNCE_WIND_SPEED_MAX_MH
+    handle->debounce_rejected_edge_count = 0;
+#endif
+#ifdef ULTIMETER_DRIVER_DEBOUNCE_STORM_EDGES
+    handle->debounce_storm_count = 0;
+#endif
+    // Publish reset values.
+    _ULTIMETER_publish_snapshot(handle);
+errors:
+    return status;
+}
 
-/*** ULTIMETER local functions ***/
+#ifdef ULTIMETER_DRIVER_WIND_SPEED_RECIPROCAL
+/*******************************************************************/
+ULTIMETER_status_t ULTIMETER_get_instantaneous_wind_gust(ULTIMETER_handle_t* handle, int32_t* gust_speed_mh) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    // Check parameters.
+    if ((handle == NULL) || (gust_speed_mh == NULL)) {
+        status = ULTIMETER_ERROR_NULL_PARAMETER;
+        goto errors;
+    }
+    (*gust_speed_mh) = (int32_t) (handle->wind_speed_mh_gust);
+errors:
+    return status;
+}
+#endif
 
+#ifdef ULTIMETER_DRIVER_EDGE_BUFFER_SIZE
 /*******************************************************************/
-static void _ULTIMETER_wind_speed_edge_callback(void) {
+ULTIMETER_status_t ULTIMETER_get_edge_buffer_overflow_count(ULTIMETER_handle_t* handle, uint32_t* overflow_count) {
     // Local variables.
-    uint32_t wind_direction_period = 0;
-    uint32_t wind_direction_duty_cycle = 0;
-    // Wind speed.
-    ultimeter_ctx.wind_speed_edge_count++;
-    // Capture period.
-    ultimeter_ctx.wind_speed_counter_stop = ULTIMETER_HW_timer_get_counter();
-    // Reset direction.
-    ultimeter_ctx.wind_direction_degrees = ULTIMETER_WIND_DIRECTION_ERROR_VALUE;
-    // Check counters.
-    if ((ultimeter_ctx.wind_direction_irq_flag != 0) &&
-        (ultimeter_ctx.wind_speed_counter_start < ultimeter_ctx.wind_speed_counter_stop) &&
-        (ultimeter_ctx.wind_direction_counter >= ultimeter_ctx.wind_speed_counter_start) &&
-        (ultimeter_ctx.wind_direction_counter <= ultimeter_ctx.wind_speed_counter_stop)) {
-        // Compute wind direction.
-        wind_direction_period = (ultimeter_ctx.wind_speed_counter_stop - ultimeter_ctx.wind_speed_counter_start);
-        wind_direction_duty_cycle = (ultimeter_ctx.wind_direction_counter - ultimeter_ctx.wind_speed_counter_start);
-        // Compute wind direction.
-        ultimeter_ctx.wind_direction_degrees = (((wind_direction_duty_cycle * MATH_2_PI_DEGREES) / (wind_direction_period)) % MATH_2_PI_DEGREES);
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    // Check parameters.
+    if ((handle == NULL) || (overflow_count == NULL)) {
+        status = ULTIMETER_ERROR_NULL_PARAMETER;
+        goto errors;
     }
-    // Start new period.
-    ultimeter_ctx.wind_direction_irq_flag = 0;
-    ultimeter_ctx.wind_speed_counter_start = ultimeter_ctx.wind_speed_counter_stop;
+    (*overflow_count) = handle->edge_buffer_overflow_count;
+errors:
+    return status;
 }
+#endif
 
 /*******************************************************************/
-static void _ULTIMETER_wind_direction_edge_callback(void) {
-    // Set flag and store counter.
-    ultimeter_ctx.wind_direction_irq_flag = 1;
-    ultimeter_ctx.wind_direction_counter = ULTIMETER_HW_timer_get_counter();
+ULTIMETER_status_t ULTIMETER_set_sampling_periods(ULTIMETER_handle_t* handle, uint32_t wind_speed_sampling_time_seconds, uint32_t wind_direction_sampling_period_seconds) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    // Check parameters.
+    if (handle == NULL) {
+        status = ULTIMETER_ERROR_NULL_PARAMETER;
+        goto errors;
+    }
+    if ((wind_speed_sampling_time_seconds == 0) || (wind_speed_sampling_time_seconds > ULTIMETER_WIND_SPEED_SAMPLING_TIME_SECONDS_MAX) || (wind_direction_sampling_period_seconds == 0)) {
+        status = ULTIMETER_ERROR_SAMPLING_PERIOD;
+        goto errors;
+    }
+#ifdef ULTIMETER_DRIVER_DUTY_CYCLE
+    if (_ULTIMETER_duty_cycle_check_sampling_time(handle, wind_speed_sampling_time_seconds) == 0) {
+        status = ULTIMETER_ERROR_DUTY_CYCLE;
+        goto errors;
+    }
+#endif
+    // Update periods.
+    handle->wind_speed_sampling_time_seconds = (uint8_t) wind_speed_sampling_time_seconds;
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+    handle->wind_direction_sampling_period_seconds = wind_direction_sampling_period_seconds;
+#endif
+    // The pending alarm is not reprogrammed in tickless mode, since the windows are only credited with its delay when it expires.
+errors:
+    return status;
 }
 
+#ifdef ULTIMETER_DRIVER_ADAPTIVE_SAMPLING
 /*******************************************************************/
-static void _ULTIMETER_tick_second_callback(void) {
-    // Check enable flag.
-    if (ultimeter_ctx.wind_measurement_enable_flag != 0) {
-        // Update local flags.
-        ultimeter_ctx.wind_speed_seconds_count++;
-        ultimeter_ctx.wind_direction_seconds_count++;
-        ultimeter_ctx.tick_second_flag = 1;
-        // Ask for processing.
-        if (ultimeter_ctx.process_callback != NULL) {
-            ultimeter_ctx.process_callback();
+ULTIMETER_status_t ULTIMETER_set_adaptive_sampling(ULTIMETER_handle_t* handle, ULTIMETER_adaptive_sampling_t* adaptive_sampling) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    // Check parameter.
+    if (handle == NULL) {
+        status = ULTIMETER_ERROR_NULL_PARAMETER;
+        goto errors;
+    }
+    // Disable policy and restore direction sampling.
+    handle->adaptive_sampling_enable_flag = 0;
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+    handle->wind_direction_enable_flag = 1;
+#endif
+    if (adaptive_sampling != NULL) {
+        // Check bounds.
+        if ((adaptive_sampling->wind_speed_sampling_time_seconds_min == 0) ||
+            (adaptive_sampling->wind_speed_sampling_time_seconds_max > ULTIMETER_WIND_SPEED_SAMPLING_TIME_SECONDS_MAX) ||
+            (adaptive_sampling->wind_speed_sampling_time_seconds_min > adaptive_sampling->wind_speed_sampling_time_seconds_max)) {
+            status = ULTIMETER_ERROR_SAMPLING_PERIOD;
+            goto errors;
+        }
+#ifdef ULTIMETER_DRIVER_DUTY_CYCLE
+        if (_ULTIMETER_duty_cycle_check_sampling_time(handle, adaptive_sampling->wind_speed_sampling_time_seconds_min) == 0) {
+            status = ULTIMETER_ERROR_DUTY_CYCLE;
+            goto errors;
         }
+#endif
+        // Store policy and start from the shortest window.
+        handle->adaptive_sampling = (*adaptive_sampling);
+        handle->adaptive_sampling_last_speed_mh = 0;
+        handle->adaptive_sampling_calm_count = 0;
+        handle->adaptive_sampling_active_count = 0;
+        handle->adaptive_sampling_gust_count = 0;
+        handle->wind_speed_sampling_time_seconds = (uint8_t) adaptive_sampling->wind_speed_sampling_time_seconds_min;
+        handle->adaptive_sampling_enable_flag = 1;
     }
+    // The pending alarm is not reprogrammed in tickless mode, since the windows are only credited with its delay when it expires.
+errors:
+    return status;
 }
+#endif
 
-/*** ULTIMETER functions ***/
+/*******************************************************************/
+ULTIMETER_status_t ULTIMETER_get_next_deadline(ULTIMETER_handle_t* handle, uint32_t* delay_seconds) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    // Check parameters.
+    if ((handle == NULL) || (delay_seconds == NULL)) {
+        status = ULTIMETER_ERROR_NULL_PARAMETER;
+        goto errors;
+    }
+    (*delay_seconds) = _ULTIMETER_get_next_deadline_seconds(handle);
+errors:
+    return status;
+}
 
+#ifdef ULTIMETER_DRIVER_SLIDING_WINDOW_LONG_SAMPLES
 /*******************************************************************/
-ULTIMETER_status_t ULTIMETER_init(ULTIMETER_process_cb_t process_callback) {
+ULTIMETER_status_t ULTIMETER_get_sliding_window_wind_speed(ULTIMETER_handle_t* handle, ULTIMETER_sliding_window_t window, int32_t* average_speed_mh) {
     // Local variables.
     ULTIMETER_status_t status = ULTIMETER_SUCCESS;
-    ULTIMETER_HW_configuration_t hw_config;
-    // Reset data.
-    ULTIMETER_reset_measurements();
-    // Check parameter.
-    if (process_callback == NULL) {
+    ULTIMETER_accumulators_t accumulators;
+    // Check parameters.
+    if ((handle == NULL) || (average_speed_mh == NULL)) {
         status = ULTIMETER_ERROR_NULL_PARAMETER;
         goto errors;
     }
-    // Init context.
-    ultimeter_ctx.wind_measurement_enable_flag = 0;
-    ultimeter_ctx.process_callback = process_callback;
-    // Init hardware interface.
-    hw_config.wind_speed_edge_irq_callback = &_ULTIMETER_wind_speed_edge_callback;
-    hw_config.wind_direction_edge_irq_callback = &_ULTIMETER_wind_direction_edge_callback;
-    hw_config.tick_second_irq_callback = &_ULTIMETER_tick_second_callback;
-    status = ULTIMETER_HW_init(&hw_config);
+    _ULTIMETER_get_accumulators(handle, &accumulators);
+    status = _ULTIMETER_compute_sliding_window_wind_speed(&accumulators, window, average_speed_mh);
     if (status != ULTIMETER_SUCCESS) goto errors;
 errors:
     return status;
 }
 
 /*******************************************************************/
-ULTIMETER_status_t ULTIMETER_de_init(void) {
+ULTIMETER_status_t ULTIMETER_get_sliding_window_wind_direction(ULTIMETER_handle_t* handle, ULTIMETER_sliding_window_t window, int32_t* average_direction_degrees, ULTIMETER_wind_direction_status_t* direction_status) {
     // Local variables.
     ULTIMETER_status_t status = ULTIMETER_SUCCESS;
-    // Release hardware interface.
-    status = ULTIMETER_HW_de_init();
+    ULTIMETER_accumulators_t accumulators;
+    // Check parameters.
+    if ((handle == NULL) || (average_direction_degrees == NULL) || (direction_status == NULL)) {
+        status = ULTIMETER_ERROR_NULL_PARAMETER;
+        goto errors;
+    }
+    _ULTIMETER_get_accumulators(handle, &accumulators);
+    status = _ULTIMETER_compute_sliding_window_wind_direction(&accumulators, window, average_direction_degrees, direction_status);
     if (status != ULTIMETER_SUCCESS) goto errors;
 errors:
     return status;
 }
 
 /*******************************************************************/
-ULTIMETER_status_t ULTIMETER_set_wind_measurement(uint8_t enable) {
+ULTIMETER_status_t ULTIMETER_get_sliding_window_gust(ULTIMETER_handle_t* handle, int32_t* gust_speed_mh) {
     // Local variables.
     ULTIMETER_status_t status = ULTIMETER_SUCCESS;
-    // Update local enable flag.
-    ultimeter_ctx.wind_measurement_enable_flag = enable;
-    // Check enable bit.
-    if (enable == 0) {
-        // Stop timer.
-        ULTIMETER_HW_timer_stop();
-        // Reset second counters.
-        ultimeter_ctx.wind_speed_seconds_count = 0;
-        ultimeter_ctx.wind_direction_seconds_count = 0;
-        ultimeter_ctx.tick_second_flag = 0;
-    }
-    else {
-        status = ULTIMETER_HW_timer_start();
-        if (status != ULTIMETER_SUCCESS) goto errors;
+    ULTIMETER_accumulators_t accumulators;
+    // Check parameters.
+    if ((handle == NULL) || (gust_speed_mh == NULL)) {
+        status = ULTIMETER_ERROR_NULL_PARAMETER;
+        goto errors;
     }
-    // Set interrupt state.
-    status = ULTIMETER_HW_set_wind_speed_direction_interrupts(enable);
-    if (status != ULTIMETER_SUCCESS) goto errors;
+    _ULTIMETER_get_accumulators(handle, &accumulators);
+    (*gust_speed_mh) = (int32_t) (accumulators.sliding_window_gust_speed_sum_max / ULTIMETER_DRIVER_SLIDING_WINDOW_GUST_SAMPLES);
 errors:
     return status;
 }
+#endif
 
+#ifdef ULTIMETER_DRIVER_WIND_ROSE_SECTORS
 /*******************************************************************/
-ULTIMETER_status_t ULTIMETER_process(void) {
+ULTIMETER_status_t ULTIMETER_get_wind_rose(ULTIMETER_handle_t* handle, uint8_t bits_per_counter, uint8_t* buffer, uint32_t buffer_size_bytes, uint32_t* data_size_bytes, uint16_t* full_scale_count) {
     // Local variables.
     ULTIMETER_status_t status = ULTIMETER_SUCCESS;
-    uint32_t wind_speed_mh = 0;
-    // Check flag.
-    if (ultimeter_ctx.tick_second_flag == 0) goto errors;
-    // Clear flag.
-    ultimeter_ctx.tick_second_flag = 0;
-    // Update wind speed if period is reached.
-    if (ultimeter_ctx.wind_speed_seconds_count >= ULTIMETER_DRIVER_WIND_SPEED_SAMPLING_TIME_SECONDS) {
-        // Reset seconds counter.
-        ultimeter_ctx.wind_speed_seconds_count = 0;
-        // Compute new value.
-        wind_speed_mh = (ultimeter_ctx.wind_speed_edge_count * ULTIMETER_WIND_SPEED_1HZ_TO_MH) / (ULTIMETER_DRIVER_WIND_SPEED_SAMPLING_TIME_SECONDS);
-        ultimeter_ctx.wind_speed_edge_count = 0;
-        // Update peak value if required.
-        if (wind_speed_mh > ultimeter_ctx.wind_speed_mh_peak) {
-            ultimeter_ctx.wind_speed_mh_peak = wind_speed_mh;
-        }
-        // Update average value.
-        MATH_rolling_mean(ultimeter_ctx.wind_speed_mh_average, ultimeter_ctx.wind_speed_data_count, wind_speed_mh, uint32_t);
-        // Compute direction only if there is wind.
-        if (((wind_speed_mh / 1000) > 0) && (ultimeter_ctx.wind_direction_degrees != ULTIMETER_WIND_DIRECTION_ERROR_VALUE)) {
-            // Add new wind direction vector weighted by speed.
-            ultimeter_ctx.wind_direction_trend_point_x += ((int32_t) (wind_speed_mh / 1000)) * ((int32_t) MATH_COS_TABLE[ultimeter_ctx.wind_direction_degrees]);
-            ultimeter_ctx.wind_direction_trend_point_y += ((int32_t) (wind_speed_mh / 1000)) * ((int32_t) MATH_SIN_TABLE[ultimeter_ctx.wind_direction_degrees]);
+    uint32_t bit_index = 0;
+    uint32_t sector = 0;
+    uint32_t bin = 0;
+    uint32_t idx = 0;
+    // Check parameters.
+    if ((handle == NULL) || (buffer == NULL) || (data_size_bytes == NULL) || (full_scale_count == NULL)) {
+        status = ULTIMETER_ERROR_NULL_PARAMETER;
+        goto errors;
+    }
+    if ((bits_per_counter == 0) || (bits_per_counter > ULTIMETER_WIND_ROSE_BITS_PER_COUNTER_MAX)) {
+        status = ULTIMETER_ERROR_WIND_ROSE_BITS;
+        goto errors;
+    }
+    (*data_size_bytes) = (((1 + (ULTIMETER_DRIVER_WIND_ROSE_SECTORS * ULTIMETER_DRIVER_WIND_ROSE_SPEED_BINS)) * ((uint32_t) bits_per_counter)) + 7) / 8;
+    if (buffer_size_bytes < (*data_size_bytes)) {
+        status = ULTIMETER_ERROR_WIND_ROSE_BUFFER_SIZE;
+        goto errors;
+    }
+    // Full scale is the maximum counter value, or the maximum exported value if counters are not saturating it.
+    (*full_scale_count) = (uint16_t) ((((uint32_t) 1) << bits_per_counter) - 1);
+    if (handle->wind_rose_calm_count > (*full_scale_count)) {
+        (*full_scale_count) = handle->wind_rose_calm_count;
+    }
+    for (sector = 0; sector < ULTIMETER_DRIVER_WIND_ROSE_SECTORS; sector++) {
+        for (bin = 0; bin < ULTIMETER_DRIVER_WIND_ROSE_SPEED_BINS; bin++) {
+            if (handle->wind_rose_count[sector][bin] > (*full_scale_count)) {
+                (*full_scale_count) = handle->wind_rose_count[sector][bin];
+            }
         }
     }
-    // Update wind direction if period is reached.
-    if (ultimeter_ctx.wind_direction_seconds_count >= ULTIMETER_DRIVER_WIND_DIRECTION_SAMPLING_PERIOD_SECONDS) {
-        // Reset seconds counter.
-        ultimeter_ctx.wind_direction_seconds_count = 0;
-        // Compute direction only if there is wind.
-        if (((wind_speed_mh / 1000) > 0) && (ultimeter_ctx.wind_direction_degrees != ULTIMETER_WIND_DIRECTION_ERROR_VALUE)) {
-            // Add new wind direction vector weighted by speed.
-            ultimeter_ctx.wind_direction_trend_point_x += ((int32_t) (wind_speed_mh / 1000)) * ((int32_t) MATH_COS_TABLE[ultimeter_ctx.wind_direction_degrees]);
-            ultimeter_ctx.wind_direction_trend_point_y += ((int32_t) (wind_speed_mh / 1000)) * ((int32_t) MATH_SIN_TABLE[ultimeter_ctx.wind_direction_degrees]);
+    // Pack counters.
+    for (idx = 0; idx < (*data_size_bytes); idx++) {
+        buffer[idx] = 0;
+    }
+    _ULTIMETER_wind_rose_pack(handle->wind_rose_calm_count, (*full_scale_count), bits_per_counter, buffer, &bit_index);
+    for (sector = 0; sector < ULTIMETER_DRIVER_WIND_ROSE_SECTORS; sector++) {
+        for (bin = 0; bin < ULTIMETER_DRIVER_WIND_ROSE_SPEED_BINS; bin++) {
+            _ULTIMETER_wind_rose_pack(handle->wind_rose_count[sector][bin], (*full_scale_count), bits_per_counter, buffer, &bit_index);
+        }
+    }
+errors:
+    return status;
+}
+
+/*******************************************************************/
+ULTIMETER_status_t ULTIMETER_reset_wind_rose(ULTIMETER_handle_t* handle) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    uint32_t sector = 0;
+    uint32_t bin = 0;
+    // Check parameter.
+    if (handle == NULL) {
+        status = ULTIMETER_ERROR_NULL_PARAMETER;
+        goto errors;
+    }
+    for (sector = 0; sector < ULTIMETER_DRIVER_WIND_ROSE_SECTORS; sector++) {
+        for (bin = 0; bin < ULTIMETER_DRIVER_WIND_ROSE_SPEED_BINS; bin++) {
+            handle->wind_rose_count[sector][bin] = 0;
         }
     }
+    handle->wind_rose_calm_count = 0;
+errors:
+    return status;
+}
+#endif
+
+#ifdef ULTIMETER_DRIVER_RECORDER
+/*******************************************************************/
+ULTIMETER_status_t ULTIMETER_set_recorder(ULTIMETER_handle_t* handle, ULTIMETER_RECORDER_t* recorder) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    // Check parameter.
+    if (handle == NULL) {
+        status = ULTIMETER_ERROR_NULL_PARAMETER;
+        goto errors;
+    }
+    handle->recorder = recorder;
 errors:
     return status;
 }
+#endif
 
+#ifdef ULTIMETER_DRIVER_DEBOUNCE_WIND_SPEED_MAX_MH
 /*******************************************************************/
-ULTIMETER_status_t ULTIMETER_get_wind_speed(int32_t* average_speed_mh, int32_t* peak_speed_mh) {
+ULTIMETER_status_t ULTIMETER_get_rejected_edge_count(ULTIMETER_handle_t* handle, uint32_t* rejected_edge_count, uint32_t* storm_count) {
     // Local variables.
     ULTIMETER_status_t status = ULTIMETER_SUCCESS;
     // Check parameters.
-    if ((average_speed_mh == NULL) || (peak_speed_mh == NULL)) {
+    if ((handle == NULL) || (rejected_edge_count == NULL) || (storm_count == NULL)) {
         status = ULTIMETER_ERROR_NULL_PARAMETER;
         goto errors;
     }
-    (*average_speed_mh) = (int32_t) (ultimeter_ctx.wind_speed_mh_average);
-    (*peak_speed_mh) = (int32_t) (ultimeter_ctx.wind_speed_mh_peak);
+    (*rejected_edge_count) = handle->debounce_rejected_edge_count;
+#ifdef ULTIMETER_DRIVER_DEBOUNCE_STORM_EDGES
+    (*storm_count) = handle->debounce_storm_count;
+#else
+    (*storm_count) = 0;
+#endif
 errors:
     return status;
 }
+#endif
 
+#ifdef ULTIMETER_DRIVER_DIAGNOSTICS
 /*******************************************************************/
-ULTIMETER_status_t ULTIMETER_get_wind_direction(int32_t* average_direction_degrees, ULTIMETER_wind_direction_status_t* direction_status) {
+ULTIMETER_status_t ULTIMETER_get_diagnostics(ULTIMETER_handle_t* handle, ULTIMETER_diagnostics_t* diagnostics) {
     // Local variables.
     ULTIMETER_status_t status = ULTIMETER_SUCCESS;
-    MATH_status_t math_status = MATH_SUCCESS;
     // Check parameters.
-    if ((average_direction_degrees == NULL) || (direction_status == NULL)) {
+    if ((handle == NULL) || (diagnostics == NULL)) {
+        status = ULTIMETER_ERROR_NULL_PARAMETER;
+        goto errors;
+    }
+    // Counters.
+    diagnostics->wind_speed_edge_irq_count = handle->diagnostics_wind_speed_edge_irq_count;
+    diagnostics->wind_direction_edge_irq_count = handle->diagnostics_wind_direction_edge_irq_count;
+    diagnostics->tick_irq_count = handle->diagnostics_tick_irq_count;
+    diagnostics->process_count = handle->diagnostics_process_count;
+    diagnostics->wind_direction_missing_count = handle->diagnostics_wind_direction_missing_count;
+    diagnostics->wind_direction_rejected_count = handle->diagnostics_wind_direction_rejected_count;
+    diagnostics->missed_tick_count = handle->diagnostics_missed_tick_count;
+    // Execution times.
+    _ULTIMETER_diagnostics_get_cycles_statistics(&(handle->diagnostics_wind_speed_edge_irq_cycles), &(diagnostics->wind_speed_edge_irq_cycles));
+    _ULTIMETER_diagnostics_get_cycles_statistics(&(handle->diagnostics_wind_direction_edge_irq_cycles), &(diagnostics->wind_direction_edge_irq_cycles));
+    _ULTIMETER_diagnostics_get_cycles_statistics(&(handle->diagnostics_tick_irq_cycles), &(diagnostics->tick_irq_cycles));
+    _ULTIMETER_diagnostics_get_cycles_statistics(&(handle->diagnostics_process_cycles), &(diagnostics->process_cycles));
+errors:
+    return status;
+}
+#endif
+
+#ifdef ULTIMETER_DRIVER_DUTY_CYCLE
+/*******************************************************************/
+ULTIMETER_status_t ULTIMETER_set_duty_cycle(ULTIMETER_handle_t* handle, uint32_t burst_seconds, uint32_t period_seconds) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    // Check parameters.
+    if (handle == NULL) {
+        status = ULTIMETER_ERROR_NULL_PARAMETER;
+        goto errors;
+    }
+    // Bursts must contain complete windows.
+    if ((period_seconds != 0) && ((burst_seconds == 0) || (burst_seconds > period_seconds) || ((burst_seconds % handle->wind_speed_sampling_time_seconds) != 0))) {
+        status = ULTIMETER_ERROR_DUTY_CYCLE;
+        goto errors;
+    }
+    // Update schedule.
+    handle->duty_cycle_burst_seconds = burst_seconds;
+    handle->duty_cycle_period_seconds = period_seconds;
+    // Restart schedule and current windows, the capture is started by the next process if needed.
+    handle->duty_cycle_seconds_count = 0;
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+    handle->wind_direction_seconds_count = 0;
+#endif
+    _ULTIMETER_discard_edges(handle);
+errors:
+    return status;
+}
+#endif
+
+#ifdef ULTIMETER_DRIVER_STATE
+/*******************************************************************/
+ULTIMETER_status_t ULTIMETER_save_state(ULTIMETER_handle_t* handle, uint8_t* state, uint32_t state_size_bytes) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    uint32_t idx = 0;
+#ifdef ULTIMETER_DRIVER_WIND_ROSE_SECTORS
+    uint32_t sector = 0;
+    uint32_t bin = 0;
+#endif
+    // Check parameters.
+    if ((handle == NULL) || (state == NULL)) {
         status = ULTIMETER_ERROR_NULL_PARAMETER;
         goto errors;
     }
-    // Reset output status.
-    (*direction_status) = ULTIMETER_WIND_DIRECTION_STATUS_UNDEFINED;
-    // Check trend point coordinates.
-    if ((ultimeter_ctx.wind_direction_trend_point_x != 0) || (ultimeter_ctx.wind_direction_trend_point_y != 0)) {
-        // Compute trend point angle.
-        math_status = MATH_atan2(ultimeter_ctx.wind_direction_trend_point_x, ultimeter_ctx.wind_direction_trend_point_y, average_direction_degrees);
-        MATH_exit_error(ULTIMETER_ERROR_BASE_MATH);
-        // Update output status.
-        (*direction_status) = ULTIMETER_WIND_DIRECTION_STATUS_AVAILABLE;
+    if (state_size_bytes < ULTIMETER_STATE_SIZE_BYTES) {
+        status = ULTIMETER_ERROR_STATE_SIZE;
+        goto errors;
+    }
+    // Header.
+    _ULTIMETER_state_write(state, &idx, ULTIMETER_STATE_VERSION, 1);
+    _ULTIMETER_state_write(state, &idx, ULTIMETER_STATE_OPTIONS, 1);
+    _ULTIMETER_state_write(state, &idx, ULTIMETER_STATE_WIND_ROSE_SECTORS, 1);
+    _ULTIMETER_state_write(state, &idx, ULTIMETER_STATE_WIND_ROSE_SPEED_BINS, 1);
+    // Wind speed.
+    _ULTIMETER_state_write(state, &idx, handle->wind_speed_data_count, 4);
+    _ULTIMETER_state_write(state, &idx, handle->wind_speed_sum, 8);
+    _ULTIMETER_state_write(state, &idx, handle->wind_speed_seconds_sum, 4);
+    _ULTIMETER_state_write(state, &idx, handle->wind_speed_peak_sum, 4);
+    _ULTIMETER_state_write(state, &idx, handle->wind_speed_peak_seconds, 4);
+#ifdef ULTIMETER_DRIVER_WIND_SPEED_RECIPROCAL
+    _ULTIMETER_state_write(state, &idx, handle->wind_speed_mh_gust, 4);
+#endif
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+    // Wind direction.
+    _ULTIMETER_state_write(state, &idx, (uint64_t) handle->wind_direction_trend_point_x, 8);
+    _ULTIMETER_state_write(state, &idx, (uint64_t) handle->wind_direction_trend_point_y, 8);
+    _ULTIMETER_state_write(state, &idx, handle->wind_direction_weight_sum, 8);
+    _ULTIMETER_state_write(state, &idx, handle->wind_direction_data_count, 4);
+#endif
+#ifdef ULTIMETER_DRIVER_WIND_ROSE_SECTORS
+    // Wind rose.
+    for (sector = 0; sector < ULTIMETER_DRIVER_WIND_ROSE_SECTORS; sector++) {
+        for (bin = 0; bin < ULTIMETER_DRIVER_WIND_ROSE_SPEED_BINS; bin++) {
+            _ULTIMETER_state_write(state, &idx, handle->wind_rose_count[sector][bin], 2);
+        }
     }
+    _ULTIMETER_state_write(state, &idx, handle->wind_rose_calm_count, 2);
+#endif
+    // Integrity.
+    _ULTIMETER_state_write(state, &idx, _ULTIMETER_state_compute_crc16(state, idx), 2);
 errors:
     return status;
 }
 
 /*******************************************************************/
-void ULTIMETER_reset_measurements(void) {
+ULTIMETER_status_t ULTIMETER_restore_state(ULTIMETER_handle_t* handle, uint8_t* state, uint32_t state_size_bytes) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    uint32_t idx = 0;
+#ifdef ULTIMETER_DRIVER_WIND_ROSE_SECTORS
+    uint32_t sector = 0;
+    uint32_t bin = 0;
+#endif
+    // Check parameters.
+    if ((handle == NULL) || (state == NULL)) {
+        status = ULTIMETER_ERROR_NULL_PARAMETER;
+        goto errors;
+    }
+    if (state_size_bytes < ULTIMETER_STATE_SIZE_BYTES) {
+        status = ULTIMETER_ERROR_STATE_SIZE;
+        goto errors;
+    }
+    // Check integrity before any other field.
+    idx = (ULTIMETER_STATE_SIZE_BYTES - 2);
+    if (_ULTIMETER_state_read(state, &idx, 2) != _ULTIMETER_state_compute_crc16(state, (ULTIMETER_STATE_SIZE_BYTES - 2))) {
+        status = ULTIMETER_ERROR_STATE_CRC;
+        goto errors;
+    }
+    // Check header.
+    idx = 0;
+    if ((_ULTIMETER_state_read(state, &idx, 1) != ULTIMETER_STATE_VERSION) || (_ULTIMETER_state_read(state, &idx, 1) != ULTIMETER_STATE_OPTIONS)) {
+        status = ULTIMETER_ERROR_STATE_VERSION;
+        goto errors;
+    }
+    // The wind rose layout depends on the build configuration.
+    if ((_ULTIMETER_state_read(state, &idx, 1) != ULTIMETER_STATE_WIND_ROSE_SECTORS) || (_ULTIMETER_state_read(state, &idx, 1) != ULTIMETER_STATE_WIND_ROSE_SPEED_BINS)) {
+        status = ULTIMETER_ERROR_STATE_VERSION;
+        goto errors;
+    }
     // Wind speed.
-    ultimeter_ctx.wind_speed_counter_start = 0;
-    ultimeter_ctx.wind_speed_counter_stop = 0;
-    ultimeter_ctx.wind_speed_seconds_count = 0;
-    ultimeter_ctx.wind_speed_edge_count = 0;
-    ultimeter_ctx.wind_speed_data_count = 0;
-    ultimeter_ctx.wind_speed_mh_average = 0;
-    ultimeter_ctx.wind_speed_mh_peak = 0;
+    handle->wind_speed_data_count = (uint32_t) _ULTIMETER_state_read(state, &idx, 4);
+    handle->wind_speed_sum = _ULTIMETER_state_read(state, &idx, 8);
+    handle->wind_speed_seconds_sum = (uint32_t) _ULTIMETER_state_read(state, &idx, 4);
+    handle->wind_speed_peak_sum = (uint32_t) _ULTIMETER_state_read(state, &idx, 4);
+    handle->wind_speed_peak_seconds = (uint32_t) _ULTIMETER_state_read(state, &idx, 4);
+#ifdef ULTIMETER_DRIVER_WIND_SPEED_RECIPROCAL
+    handle->wind_speed_mh_gust = (uint32_t) _ULTIMETER_state_read(state, &idx, 4);
+#endif
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
     // Wind direction.
-    ultimeter_ctx.wind_direction_irq_flag = 0;
-    ultimeter_ctx.wind_direction_counter = 0;
-    ultimeter_ctx.wind_direction_degrees = 0;
-    ultimeter_ctx.wind_direction_seconds_count = 0;
-    ultimeter_ctx.wind_direction_trend_point_x = 0;
-    ultimeter_ctx.wind_direction_trend_point_y = 0;
+    handle->wind_direction_trend_point_x = (int64_t) _ULTIMETER_state_read(state, &idx, 8);
+    handle->wind_direction_trend_point_y = (int64_t) _ULTIMETER_state_read(state, &idx, 8);
+    handle->wind_direction_weight_sum = _ULTIMETER_state_read(state, &idx, 8);
+    handle->wind_direction_data_count = (uint32_t) _ULTIMETER_state_read(state, &idx, 4);
+#ifdef ULTIMETER_DRIVER_SINK_BATCH_RECORDS
+    // Direction records only average the vectors added after the restore.
+    handle->sink_trend_point_x_last = handle->wind_direction_trend_point_x;
+    handle->sink_trend_point_y_last = handle->wind_direction_trend_point_y;
+#endif
+#endif
+#ifdef ULTIMETER_DRIVER_WIND_ROSE_SECTORS
+    // Wind rose.
+    for (sector = 0; sector < ULTIMETER_DRIVER_WIND_ROSE_SECTORS; sector++) {
+        for (bin = 0; bin < ULTIMETER_DRIVER_WIND_ROSE_SPEED_BINS; bin++) {
+            handle->wind_rose_count[sector][bin] = (uint16_t) _ULTIMETER_state_read(state, &idx, 2);
+        }
+    }
+    handle->wind_rose_calm_count = (uint16_t) _ULTIMETER_state_read(state, &idx, 2);
+#endif
+    // Publish restored values.
+    _ULTIMETER_publish_snapshot(handle);
+errors:
+    return status;
+}
+#endif
+
+#ifdef ULTIMETER_DRIVER_SINK_BATCH_RECORDS
+/*******************************************************************/
+ULTIMETER_status_t ULTIMETER_flush_sink(ULTIMETER_handle_t* handle) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    // Check parameter.
+    if (handle == NULL) {
+        status = ULTIMETER_ERROR_NULL_PARAMETER;
+        goto errors;
+    }
+    // Deliver pending records.
+    _ULTIMETER_sink_flush(handle);
+errors:
+    return status;
 }
+#endif
 
 #endif /* ULTIMETER_DRIVER_DISABLE */
@@ -0,0 +1,216 @@
+/*
+ * ultimeter_batch.c
+ *
+ *  Created on: 17 oct. 2026
+ *      Author: Ludo
+ */
+
+#include "ultimeter_batch.h"
+
+#ifndef ULTIMETER_DRIVER_DISABLE_FLAGS_FILE
+#include "ultimeter_driver_flags.h"
+#endif
+#include "ultimeter.h"
+#include "ultimeter_math.h"
+#include "types.h"
+
+#ifndef ULTIMETER_DRIVER_DISABLE
+#ifdef ULTIMETER_DRIVER_BATCH
+
+/*** ULTIMETER BATCH local functions ***/
+
+/*******************************************************************/
+static uint32_t _ULTIMETER_BATCH_lower_bound(uint32_t* timestamps, uint32_t count, uint32_t start_counter, uint32_t offset) {
+    // Local variables.
+    uint32_t base = 0;
+    uint32_t half = 0;
+    uint32_t index = 0;
+    // Branchless binary search of the first timestamp which is not before the given offset.
+    if (count != 0) {
+        while (count > 1) {
+            half = (count >> 1);
+            base = ((timestamps[base + half] - start_counter) < offset) ? (base + half) : base;
+            count -= half;
+        }
+        index = (base + (((timestamps[base] - start_counter) < offset) ? 1 : 0));
+    }
+    return index;
+}
+
+/*******************************************************************/
+static void _ULTIMETER_BATCH_get_periods(uint32_t* timestamps, uint32_t first, uint32_t last, uint32_t* period_count, uint32_t* period_sum, uint32_t* period_min) {
+    // Local variables.
+    uint32_t null_period_count = 0;
+    uint32_t sum = 0;
+    uint32_t min = 0xFFFFFFFF;
+    uint32_t period = 0;
+    uint32_t idx = 0;
+    // Branchless reductions on consecutive timestamps so that the loop can be vectorized.
+    for (idx = first; idx < last; idx++) {
+        period = (timestamps[idx] - timestamps[idx - 1]);
+        sum += period;
+        // Null periods are ignored by the driver: count them and map them on the highest value for the minimum.
+        null_period_count += ((period == 0) ? 1 : 0);
+        min = ((period - 1) < min) ? (period - 1) : min;
+    }
+    (*period_count) = (last > first) ? (last - first - null_period_count) : 0;
+    (*period_sum) = sum;
+    (*period_min) = (min + 1);
+}
+
+/*******************************************************************/
+static uint32_t _ULTIMETER_BATCH_get_wind_direction_angle(ULTIMETER_BATCH_input_t* input, uint32_t edge_index) {
+    // Local variables.
+    uint32_t wind_direction_angle = ULTIMETER_WIND_DIRECTION_ERROR_VALUE;
+    uint32_t rotation_start_offset = (input->wind_speed_edge_timestamps[edge_index - 1] - input->start_counter);
+    uint32_t rotation_stop_offset = (input->wind_speed_edge_timestamps[edge_index] - input->start_counter);
+    uint32_t direction_offset = 0;
+    uint32_t direction_index = 0;
+    // Last direction edge of the rotation, like the driver which keeps the last captured counter.
+    direction_index = _ULTIMETER_BATCH_lower_bound(input->wind_direction_edge_timestamps, input->wind_direction_edge_count, input->start_counter, (rotation_stop_offset + 1));
+    if (direction_index != 0) {
+        direction_offset = (input->wind_direction_edge_timestamps[direction_index - 1] - input->start_counter);
+        // Check that the direction edge belongs to the rotation.
+        if ((direction_offset > rotation_start_offset) && (rotation_stop_offset != rotation_start_offset)) {
+            wind_direction_angle = ULTIMETER_MATH_compute_wind_direction_angle((direction_offset - rotation_start_offset), (rotation_stop_offset - rotation_start_offset));
+        }
+    }
+    return wind_direction_angle;
+}
+
+#ifdef ULTIMETER_DRIVER_WIND_DIRECTION_PER_ROTATION
+/*******************************************************************/
+static void _ULTIMETER_BATCH_get_rotation_vectors(ULTIMETER_BATCH_input_t* input, uint32_t first, uint32_t last, int64_t* trend_point_x, int64_t* trend_point_y) {
+    // Local variables.
+    uint32_t wind_direction_angle = 0;
+    int32_t wind_direction_degrees = 0;
+    uint32_t idx = 0;
+    // Same unit vectors as the edges callback.
+    for (idx = first; idx < last; idx++) {
+        wind_direction_angle = _ULTIMETER_BATCH_get_wind_direction_angle(input, idx);
+        if (wind_direction_angle != ULTIMETER_WIND_DIRECTION_ERROR_VALUE) {
+            wind_direction_degrees = ULTIMETER_MATH_get_wind_direction_degrees(wind_direction_angle);
+            (*trend_point_x) += (int64_t) MATH_COS_TABLE[wind_direction_degrees];
+            (*trend_point_y) += (int64_t) MATH_SIN_TABLE[wind_direction_degrees];
+        }
+    }
+}
+#endif
+
+/*** ULTIMETER BATCH functions ***/
+
+/*******************************************************************/
+ULTIMETER_status_t ULTIMETER_BATCH_process(ULTIMETER_BATCH_input_t* input, ULTIMETER_BATCH_output_t* output, uint32_t window_count) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    uint64_t window_ticks = 0;
+    uint32_t first = 0;
+    uint32_t last = 0;
+    uint32_t period_count = 0;
+    uint32_t period_sum = 0;
+    uint32_t period_min = 0;
+    uint32_t wind_speed_mh = 0;
+    uint32_t wind_speed_mh_peak = 0;
+    uint32_t wind_direction_angle = 0;
+#ifndef ULTIMETER_DRIVER_WIND_DIRECTION_PER_ROTATION
+    int64_t weight = 0;
+    int32_t x = 0;
+    int32_t y = 0;
+#endif
+    uint32_t idx = 0;
+    // Check parameters.
+    if ((input == NULL) || (output == NULL)) {
+        status = ULTIMETER_ERROR_NULL_PARAMETER;
+        goto errors;
+    }
+    if (((input->wind_speed_edge_timestamps == NULL) && (input->wind_speed_edge_count != 0)) || ((input->wind_direction_edge_timestamps == NULL) && (input->wind_direction_edge_count != 0))) {
+        status = ULTIMETER_ERROR_NULL_PARAMETER;
+        goto errors;
+    }
+    if ((output->wind_speed_mh == NULL) || (output->peak_wind_speed_mh == NULL) || (output->wind_direction_degrees == NULL) || (output->direction_status == NULL) || (output->trend_point_x == NULL) || (output->trend_point_y == NULL)) {
+        status = ULTIMETER_ERROR_NULL_PARAMETER;
+        goto errors;
+    }
+    if ((input->wind_speed_sampling_time_seconds == 0) || (input->wind_direction_sampling_period_seconds == 0)) {
+        status = ULTIMETER_ERROR_SAMPLING_PERIOD;
+        goto errors;
+    }
+    if (input->timer_frequency_hz == 0) {
+        status = ULTIMETER_ERROR_TIMER_FREQUENCY;
+        goto errors;
+    }
+    // Check that all windows ends can be expressed relatively to the trace start.
+    window_ticks = ((uint64_t) input->wind_speed_sampling_time_seconds) * ((uint64_t) input->timer_frequency_hz);
+    if ((window_count != 0) && ((window_ticks * ((uint64_t) window_count)) > ((uint64_t) 0xFFFFFFFF))) {
+        status = ULTIMETER_ERROR_BATCH_LENGTH;
+        goto errors;
+    }
+    for (idx = 0; idx < window_count; idx++) {
+        // Wind speed edges of the window.
+        last = first + _ULTIMETER_BATCH_lower_bound(&(input->wind_speed_edge_timestamps[first]), (input->wind_speed_edge_count - first), input->start_counter, (uint32_t) (window_ticks * ((uint64_t) (idx + 1))));
+        // The first edge of the trace does not close any rotation.
+        _ULTIMETER_BATCH_get_periods(input->wind_speed_edge_timestamps, ((first != 0) ? first : 1), last, &period_count, &period_sum, &period_min);
+        // Same computation as the driver.
+        ULTIMETER_MATH_compute_window_speed_mh((last - first), input->wind_speed_sampling_time_seconds, period_count, (uint64_t) period_sum, period_min, input->timer_frequency_hz, &wind_speed_mh, &wind_speed_mh_peak);
+        output->wind_speed_mh[idx] = wind_speed_mh;
+        output->peak_wind_speed_mh[idx] = wind_speed_mh_peak;
+        // Direction of the last rotation of the window.
+        wind_direction_angle = ULTIMETER_WIND_DIRECTION_ERROR_VALUE;
+        if ((last > first) && (last >= 2)) {
+            wind_direction_angle = _ULTIMETER_BATCH_get_wind_direction_angle(input, (last - 1));
+        }
+        output->wind_direction_degrees[idx] = 0;
+        output->direction_status[idx] = ULTIMETER_WIND_DIRECTION_STATUS_UNDEFINED;
+        output->trend_point_x[idx] = 0;
+        output->trend_point_y[idx] = 0;
+        // Direction is only relevant if there is wind.
+        if (((wind_speed_mh / 1000) > 0) && (wind_direction_angle != ULTIMETER_WIND_DIRECTION_ERROR_VALUE)) {
+            output->wind_direction_degrees[idx] = ULTIMETER_MATH_get_wind_direction_degrees(wind_direction_angle);
+            output->direction_status[idx] = ULTIMETER_WIND_DIRECTION_STATUS_AVAILABLE;
+#ifndef ULTIMETER_DRIVER_WIND_DIRECTION_PER_ROTATION
+            // Weighted by the number of rotations of the window.
+            weight = (int64_t) (last - first);
+            ULTIMETER_MATH_get_unit_vector(wind_direction_angle, &x, &y);
+            output->trend_point_x[idx] = weight * ((int64_t) x);
+            output->trend_point_y[idx] = weight * ((int64_t) y);
+#endif
+        }
+#ifdef ULTIMETER_DRIVER_WIND_DIRECTION_PER_ROTATION
+        // All rotations of the window whatever the wind speed.
+        _ULTIMETER_BATCH_get_rotation_vectors(input, ((first != 0) ? first : 1), last, &(output->trend_point_x[idx]), &(output->trend_point_y[idx]));
+#endif
+        first = last;
+    }
+errors:
+    return status;
+}
+
+/*******************************************************************/
+ULTIMETER_status_t ULTIMETER_BATCH_get_wind_direction(ULTIMETER_BATCH_output_t* output, uint32_t window_count, int32_t* average_direction_degrees, ULTIMETER_wind_direction_status_t* direction_status) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    int64_t trend_point_x = 0;
+    int64_t trend_point_y = 0;
+    uint32_t idx = 0;
+    // Check parameters.
+    if ((output == NULL) || (average_direction_degrees == NULL) || (direction_status == NULL)) {
+        status = ULTIMETER_ERROR_NULL_PARAMETER;
+        goto errors;
+    }
+    if ((output->trend_point_x == NULL) || (output->trend_point_y == NULL)) {
+        status = ULTIMETER_ERROR_NULL_PARAMETER;
+        goto errors;
+    }
+    // Sum wind vectors.
+    for (idx = 0; idx < window_count; idx++) {
+        trend_point_x += output->trend_point_x[idx];
+        trend_point_y += output->trend_point_y[idx];
+    }
+    status = ULTIMETER_MATH_compute_trend_point_angle(trend_point_x, trend_point_y, average_direction_degrees, direction_status);
+    if (status != ULTIMETER_SUCCESS) goto errors;
+errors:
+    return status;
+}
+
+#endif /* ULTIMETER_DRIVER_BATCH */
+#endif /* ULTIMETER_DRIVER_DISABLE */
@@ -18,50 +18,103 @@
 /*** ULTIMETER HW functions ***/
 
 /*******************************************************************/
-ULTIMETER_status_t __attribute__((weak)) ULTIMETER_HW_init(ULTIMETER_HW_configuration_t* configuration) {
+ULTIMETER_status_t __attribute__((weak)) ULTIMETER_HW_init(uint8_t instance, ULTIMETER_HW_configuration_t* configuration) {
     // Local variables.
     ULTIMETER_status_t status = ULTIMETER_SUCCESS;
     /* To be implemented */
+    UNUSED(instance);
     UNUSED(configuration);
     return status;
 }
 
 /*******************************************************************/
-ULTIMETER_status_t __attribute__((weak)) ULTIMETER_HW_de_init(void) {
+ULTIMETER_status_t __attribute__((weak)) ULTIMETER_HW_de_init(uint8_t instance) {
     // Local variables.
     ULTIMETER_status_t status = ULTIMETER_SUCCESS;
     /* To be implemented */
+    UNUSED(instance);
     return status;
 }
 
 /*******************************************************************/
-ULTIMETER_status_t __attribute__((weak)) ULTIMETER_HW_set_wind_speed_direction_interrupts(uint8_t enable) {
+ULTIMETER_status_t __attribute__((weak)) ULTIMETER_HW_set_wind_speed_direction_interrupts(uint8_t instance, uint8_t enable) {
     // Local variables.
     ULTIMETER_status_t status = ULTIMETER_SUCCESS;
     /* To be implemented */
+    UNUSED(instance);
     UNUSED(enable);
     return status;
 }
 
 /*******************************************************************/
-ULTIMETER_status_t __attribute__((weak)) ULTIMETER_HW_timer_start(void) {
+ULTIMETER_status_t __attribute__((weak)) ULTIMETER_HW_timer_start(uint8_t instance) {
     // Local variables.
     ULTIMETER_status_t status = ULTIMETER_SUCCESS;
     /* To be implemented */
+    UNUSED(instance);
     return status;
 }
 
 /*******************************************************************/
-ULTIMETER_status_t __attribute__((weak)) ULTIMETER_HW_timer_stop(void) {
+ULTIMETER_status_t __attribute__((weak)) ULTIMETER_HW_timer_stop(uint8_t instance) {
     // Local variables.
     ULTIMETER_status_t status = ULTIMETER_SUCCESS;
     /* To be implemented */
+    UNUSED(instance);
     return status;
 }
 /*******************************************************************/
-uint32_t __attribute__((weak)) ULTIMETER_HW_timer_get_counter(void) {
+uint32_t __attribute__((weak)) ULTIMETER_HW_timer_get_counter(uint8_t instance) {
     /* To be implemented */
+    UNUSED(instance);
     return 0;
 }
 
+/*******************************************************************/
+uint8_t __attribute__((weak)) ULTIMETER_HW_timer_get_counter_width(uint8_t instance) {
+    /* To be implemented */
+    UNUSED(instance);
+    return 32;
+}
+
+/*******************************************************************/
+uint32_t __attribute__((weak)) ULTIMETER_HW_timer_get_frequency_hz(uint8_t instance) {
+    /* To be implemented */
+    UNUSED(instance);
+    return 0;
+}
+
+/*******************************************************************/
+void __attribute__((weak)) ULTIMETER_HW_enter_critical(uint8_t instance) {
+    /* To be implemented */
+    UNUSED(instance);
+}
+
+/*******************************************************************/
+void __attribute__((weak)) ULTIMETER_HW_exit_critical(uint8_t instance) {
+    /* To be implemented */
+    UNUSED(instance);
+}
+
+#ifdef ULTIMETER_DRIVER_TICKLESS
+/*******************************************************************/
+ULTIMETER_status_t __attribute__((weak)) ULTIMETER_HW_set_alarm(uint8_t instance, uint32_t delay_seconds) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    /* To be implemented */
+    UNUSED(instance);
+    UNUSED(delay_seconds);
+    return status;
+}
+#endif
+
+#ifdef ULTIMETER_DRIVER_DIAGNOSTICS
+/*******************************************************************/
+uint32_t __attribute__((weak)) ULTIMETER_HW_get_cycle_counter(uint8_t instance) {
+    /* To be implemented */
+    UNUSED(instance);
+    return 0;
+}
+#endif
+
 #endif /* ULTIMETER_DRIVER_DISABLE */
@@ -0,0 +1,211 @@
+/*
+ * ultimeter_math.c
+ *
+ *  Created on: 17 oct. 2026
+ *      Author: Ludo
+ */
+
+#include "ultimeter_math.h"
+
+#ifndef ULTIMETER_DRIVER_DISABLE_FLAGS_FILE
+#include "ultimeter_driver_flags.h"
+#endif
+#include "error.h"
+#include "maths.h"
+#include "ultimeter.h"
+#include "types.h"
+
+#ifndef ULTIMETER_DRIVER_DISABLE
+
+/*** ULTIMETER MATH local macros ***/
+
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+#define ULTIMETER_TREND_POINT_COORDINATE_MAX    0x3FFFFFFF
+#endif
+#ifdef ULTIMETER_DRIVER_WIND_DIRECTION_RECIPROCAL
+#define ULTIMETER_RECIPROCAL_SEED               0xAAAAAAAB
+#define ULTIMETER_RECIPROCAL_ITERATIONS_MAX     8
+#define ULTIMETER_RECIPROCAL_ERROR_CONVERGENCE  (((int64_t) 1) << 31)
+#define ULTIMETER_RECIPROCAL_ERROR_MAX          ((((uint64_t) 1) << 31) / ULTIMETER_WIND_DIRECTION_FULL_TURN)
+#define ULTIMETER_RECIPROCAL_CORRECTION_MAX     4
+#endif
+
+/*** ULTIMETER MATH functions ***/
+
+/*******************************************************************/
+uint32_t ULTIMETER_MATH_compute_wind_speed_mh(uint32_t edge_count, uint32_t sampling_time_seconds) {
+    // One rotation per second is 5.4 km/h.
+    return ((edge_count * ULTIMETER_WIND_SPEED_1HZ_TO_MH) / (sampling_time_seconds));
+}
+
+/*******************************************************************/
+uint32_t ULTIMETER_MATH_compute_rotation_speed_mh(uint32_t period_count, uint64_t period_sum, uint32_t timer_frequency_hz) {
+    // Average rotation frequency is the number of periods divided by their total duration.
+    return (uint32_t) ((((uint64_t) period_count) * ((uint64_t) ULTIMETER_WIND_SPEED_1HZ_TO_MH) * ((uint64_t) timer_frequency_hz)) / period_sum);
+}
+
+/*******************************************************************/
+void ULTIMETER_MATH_compute_window_speed_mh(uint32_t edge_count, uint32_t sampling_time_seconds, uint32_t period_count, uint64_t period_sum, uint32_t period_min, uint32_t timer_frequency_hz, uint32_t* wind_speed_mh, uint32_t* peak_wind_speed_mh) {
+#ifdef ULTIMETER_DRIVER_WIND_SPEED_RECIPROCAL
+    // Local variables.
+    uint32_t wind_speed_mh_gust = 0;
+    // Use reciprocal measurement as soon as a rotation is complete, mixing both estimators would underestimate slow rotations which only complete 1 or 2 periods per window.
+    if ((period_count != 0) && (period_sum != 0)) {
+        (*wind_speed_mh) = ULTIMETER_MATH_compute_rotation_speed_mh(period_count, period_sum, timer_frequency_hz);
+    }
+    else {
+        (*wind_speed_mh) = ULTIMETER_MATH_compute_wind_speed_mh(edge_count, sampling_time_seconds);
+    }
+    // Window peak is the fastest rotation when available.
+    if ((period_count != 0) && (period_min != 0)) {
+        wind_speed_mh_gust = ULTIMETER_MATH_compute_rotation_speed_mh(1, period_min, timer_frequency_hz);
+    }
+    (*peak_wind_speed_mh) = (wind_speed_mh_gust > (*wind_speed_mh)) ? wind_speed_mh_gust : (*wind_speed_mh);
+#else
+    // Rotation periods are not measured, the peak is the window speed.
+    UNUSED(period_count);
+    UNUSED(period_sum);
+    UNUSED(period_min);
+    UNUSED(timer_frequency_hz);
+    (*wind_speed_mh) = ULTIMETER_MATH_compute_wind_speed_mh(edge_count, sampling_time_seconds);
+    (*peak_wind_speed_mh) = (*wind_speed_mh);
+#endif
+}
+
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+/*******************************************************************/
+uint32_t ULTIMETER_MATH_compute_wind_direction_angle(uint32_t wind_direction_duty_cycle, uint32_t wind_direction_period) {
+    // Local variables.
+    uint32_t wind_direction_angle = 0;
+    // Direction is proportional to the duty cycle, use 64-bits arithmetic only for long periods.
+    if (wind_direction_duty_cycle <= (0xFFFFFFFF / ULTIMETER_WIND_DIRECTION_FULL_TURN)) {
+        wind_direction_angle = ((wind_direction_duty_cycle * ULTIMETER_WIND_DIRECTION_FULL_TURN) / (wind_direction_period));
+    }
+    else {
+        wind_direction_angle = (uint32_t) ((((uint64_t) wind_direction_duty_cycle) * ((uint64_t) ULTIMETER_WIND_DIRECTION_FULL_TURN)) / ((uint64_t) wind_direction_period));
+    }
+    return (wind_direction_angle % ULTIMETER_WIND_DIRECTION_FULL_TURN);
+}
+
+#ifdef ULTIMETER_DRIVER_WIND_DIRECTION_RECIPROCAL
+/*******************************************************************/
+void ULTIMETER_MATH_refine_wind_direction_reciprocal(uint32_t wind_direction_period, uint32_t* reciprocal, uint8_t* shift) {
+    // Local variables.
+    uint8_t period_shift = (uint8_t) __builtin_clz(wind_direction_period);
+    uint32_t normalized_period = (wind_direction_period << period_shift);
+    int64_t period_reciprocal = (int64_t) (*reciprocal);
+    int64_t error = 0;
+    uint8_t idx = 0;
+    // Reuse the previous reciprocal as seed, the rotation period does not change much from one tick to the next.
+    if ((period_shift != (*shift)) || (period_reciprocal == 0)) {
+        period_reciprocal = ULTIMETER_RECIPROCAL_SEED;
+    }
+    // Refine reciprocal (2^63 / normalized_period) with Newton-Raphson iterations, which only require multiplications.
+    for (idx = 0; idx < ULTIMETER_RECIPROCAL_ITERATIONS_MAX; idx++) {
+        // Relative error with 32 fractional bits.
+        error = ((int64_t) ((((uint64_t) 1) << 63) - (((uint64_t) normalized_period) * ((uint64_t) period_reciprocal)))) >> 31;
+        if ((error >= 0) && (error <= (int64_t) ULTIMETER_RECIPROCAL_ERROR_MAX)) break;
+        // Restart from the fixed seed if the previous reciprocal is too far to converge.
+        if ((error <= (-ULTIMETER_RECIPROCAL_ERROR_CONVERGENCE)) || (error >= ULTIMETER_RECIPROCAL_ERROR_CONVERGENCE)) {
+            period_reciprocal = ULTIMETER_RECIPROCAL_SEED;
+            continue;
+        }
+        period_reciprocal += ((period_reciprocal * error) >> 32);
+        if (period_reciprocal > 0xFFFFFFFF) {
+            period_reciprocal = 0xFFFFFFFF;
+        }
+    }
+    (*reciprocal) = (uint32_t) period_reciprocal;
+    (*shift) = period_shift;
+}
+
+/*******************************************************************/
+uint32_t ULTIMETER_MATH_compute_wind_direction_angle_reciprocal(uint32_t wind_direction_duty_cycle, uint32_t wind_direction_period, uint32_t reciprocal, uint8_t shift) {
+    // Local variables.
+    uint32_t normalized_period = (wind_direction_period << shift);
+    uint64_t duty_cycle_turn = (((uint64_t) wind_direction_duty_cycle) * ((uint64_t) ULTIMETER_WIND_DIRECTION_FULL_TURN));
+    uint64_t ratio = 0;
+    uint32_t wind_direction_angle = 0;
+    uint8_t idx = ULTIMETER_RECIPROCAL_CORRECTION_MAX;
+    // The refined reciprocal can only be used if the period has the same magnitude.
+    if ((reciprocal != 0) && ((normalized_period >> shift) == wind_direction_period) && ((normalized_period >> 31) != 0)) {
+        // Duty cycle ratio with 31 fractional bits.
+        ratio = ((((uint64_t) wind_direction_duty_cycle) * ((uint64_t) reciprocal)) >> (32 - shift));
+        wind_direction_angle = (uint32_t) ((ratio * ULTIMETER_WIND_DIRECTION_FULL_TURN) >> 31);
+        // The reciprocal may come from a slightly different period, correct the quotient with multiplications only.
+        for (idx = 0; idx < ULTIMETER_RECIPROCAL_CORRECTION_MAX; idx++) {
+            if ((((uint64_t) (wind_direction_angle + 1)) * ((uint64_t) wind_direction_period)) <= duty_cycle_turn) {
+                wind_direction_angle++;
+            }
+            else if ((((uint64_t) wind_direction_angle) * ((uint64_t) wind_direction_period)) > duty_cycle_turn) {
+                wind_direction_angle--;
+            }
+            else {
+                break;
+            }
+        }
+    }
+    // Use the division when the period changed too much since the last refinement.
+    if (idx >= ULTIMETER_RECIPROCAL_CORRECTION_MAX) {
+        wind_direction_angle = ULTIMETER_MATH_compute_wind_direction_angle(wind_direction_duty_cycle, wind_direction_period);
+    }
+    if (wind_direction_angle >= ULTIMETER_WIND_DIRECTION_FULL_TURN) {
+        wind_direction_angle -= ULTIMETER_WIND_DIRECTION_FULL_TURN;
+    }
+    return wind_direction_angle;
+}
+#endif
+
+/*******************************************************************/
+int32_t ULTIMETER_MATH_get_wind_direction_degrees(uint32_t wind_direction_angle) {
+    // Round to the closest degree.
+    return (int32_t) (((wind_direction_angle + (ULTIMETER_DRIVER_WIND_DIRECTION_RESOLUTION / 2)) / ULTIMETER_DRIVER_WIND_DIRECTION_RESOLUTION) % MATH_2_PI_DEGREES);
+}
+
+/*******************************************************************/
+void ULTIMETER_MATH_get_unit_vector(uint32_t wind_direction_angle, int32_t* x, int32_t* y) {
+    // Local variables.
+    uint32_t index = (wind_direction_angle / ULTIMETER_DRIVER_WIND_DIRECTION_RESOLUTION);
+    uint32_t fraction = (wind_direction_angle % ULTIMETER_DRIVER_WIND_DIRECTION_RESOLUTION);
+    uint32_t next_index = (((index + 1) < MATH_2_PI_DEGREES) ? (index + 1) : 0);
+    // Linear interpolation between the 1 degree trigonometric tables entries.
+    (*x) = ((((int32_t) MATH_COS_TABLE[index]) * ((int32_t) (ULTIMETER_DRIVER_WIND_DIRECTION_RESOLUTION - fraction))) + (((int32_t) MATH_COS_TABLE[next_index]) * ((int32_t) fraction))) / ((int32_t) ULTIMETER_DRIVER_WIND_DIRECTION_RESOLUTION);
+    (*y) = ((((int32_t) MATH_SIN_TABLE[index]) * ((int32_t) (ULTIMETER_DRIVER_WIND_DIRECTION_RESOLUTION - fraction))) + (((int32_t) MATH_SIN_TABLE[next_index]) * ((int32_t) fraction))) / ((int32_t) ULTIMETER_DRIVER_WIND_DIRECTION_RESOLUTION);
+}
+
+/*******************************************************************/
+uint8_t ULTIMETER_MATH_scale_trend_point(int64_t* trend_point_x, int64_t* trend_point_y) {
+    // Local variables.
+    uint8_t shift = 0;
+    // Shift coordinates until both fit in 31 bits, the angle is not affected.
+    while ((((*trend_point_x) > ULTIMETER_TREND_POINT_COORDINATE_MAX) || ((*trend_point_x) < (-ULTIMETER_TREND_POINT_COORDINATE_MAX))) ||
+           (((*trend_point_y) > ULTIMETER_TREND_POINT_COORDINATE_MAX) || ((*trend_point_y) < (-ULTIMETER_TREND_POINT_COORDINATE_MAX)))) {
+        (*trend_point_x) /= 2;
+        (*trend_point_y) /= 2;
+        shift++;
+    }
+    return shift;
+}
+
+/*******************************************************************/
+ULTIMETER_status_t ULTIMETER_MATH_compute_trend_point_angle(int64_t trend_point_x, int64_t trend_point_y, int32_t* average_direction_degrees, ULTIMETER_wind_direction_status_t* direction_status) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    MATH_status_t math_status = MATH_SUCCESS;
+    // Reset output status.
+    (*direction_status) = ULTIMETER_WIND_DIRECTION_STATUS_UNDEFINED;
+    // Check trend point coordinates.
+    if ((trend_point_x != 0) || (trend_point_y != 0)) {
+        // Compute trend point angle.
+        ULTIMETER_MATH_scale_trend_point(&trend_point_x, &trend_point_y);
+        math_status = MATH_atan2((int32_t) trend_point_x, (int32_t) trend_point_y, average_direction_degrees);
+        MATH_exit_error(ULTIMETER_ERROR_BASE_MATH);
+        // Update output status.
+        (*direction_status) = ULTIMETER_WIND_DIRECTION_STATUS_AVAILABLE;
+    }
+errors:
+    return status;
+}
+#endif
+
+#endif /* ULTIMETER_DRIVER_DISABLE */
@@ -0,0 +1,329 @@
+/*
+ * ultimeter_recorder.c
+ *
+ *  Created on: 17 oct. 2026
+ *      Author: Ludo
+ */
+
+#include "ultimeter_recorder.h"
+
+#ifndef ULTIMETER_DRIVER_DISABLE_FLAGS_FILE
+#include "ultimeter_driver_flags.h"
+#endif
+#include "maths.h"
+#include "ultimeter.h"
+#include "types.h"
+
+#ifndef ULTIMETER_DRIVER_DISABLE
+#ifdef ULTIMETER_DRIVER_RECORDER
+
+/*** ULTIMETER RECORDER local macros ***/
+
+#define ULTIMETER_RECORDER_WIND_SPEED_STEP_MH       100
+
+#define ULTIMETER_RECORDER_EXP_GOLOMB_PREFIX_MAX    31
+
+/*** ULTIMETER RECORDER local functions ***/
+
+/*******************************************************************/
+static uint32_t _ULTIMETER_RECORDER_zigzag_encode(int32_t value) {
+    // Map signed values on unsigned ones (0, -1, 1, -2, 2...).
+    return ((value < 0) ? ((((uint32_t) (-(value + 1))) << 1) + 1) : (((uint32_t) value) << 1));
+}
+
+/*******************************************************************/
+static int32_t _ULTIMETER_RECORDER_zigzag_decode(uint32_t value) {
+    // Inverse mapping.
+    return (((value & 0x01) != 0) ? (-((int32_t) (value >> 1)) - 1) : ((int32_t) (value >> 1)));
+}
+
+/*******************************************************************/
+static uint8_t _ULTIMETER_RECORDER_get_bit_length(uint32_t value) {
+    // Local variables.
+    uint8_t bit_length = 0;
+    // Count significant bits.
+    while (value != 0) {
+        value >>= 1;
+        bit_length++;
+    }
+    return bit_length;
+}
+
+/*******************************************************************/
+static uint32_t _ULTIMETER_RECORDER_get_exp_golomb_size(uint32_t value) {
+    // Order 0 code: (n - 1) zeros followed by the n bits of (value + 1).
+    return ((((uint32_t) _ULTIMETER_RECORDER_get_bit_length(value + 1)) << 1) - 1);
+}
+
+/*******************************************************************/
+static void _ULTIMETER_RECORDER_write_bit(ULTIMETER_RECORDER_t* recorder, uint8_t bit) {
+    // Local variables.
+    uint8_t mask = (uint8_t) (0x80 >> (recorder->bit_index & 0x07));
+    // Write bit MSB first.
+    if (bit != 0) {
+        recorder->buffer[recorder->bit_index >> 3] |= mask;
+    }
+    else {
+        recorder->buffer[recorder->bit_index >> 3] &= (uint8_t) (~mask);
+    }
+    recorder->bit_index++;
+}
+
+/*******************************************************************/
+static void _ULTIMETER_RECORDER_write_exp_golomb(ULTIMETER_RECORDER_t* recorder, uint32_t value) {
+    // Local variables.
+    uint8_t bit_length = _ULTIMETER_RECORDER_get_bit_length(value + 1);
+    uint8_t idx = 0;
+    // Prefix.
+    for (idx = 1; idx < bit_length; idx++) {
+        _ULTIMETER_RECORDER_write_bit(recorder, 0);
+    }
+    // Value.
+    for (idx = 0; idx < bit_length; idx++) {
+        _ULTIMETER_RECORDER_write_bit(recorder, (uint8_t) (((value + 1) >> (bit_length - 1 - idx)) & 0x01));
+    }
+}
+
+/*******************************************************************/
+static ULTIMETER_status_t _ULTIMETER_RECORDER_read_bit(ULTIMETER_RECORDER_t* recorder, uint8_t* bit) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    // Check remaining data.
+    if (recorder->bit_index >= recorder->size_bits) {
+        status = ULTIMETER_ERROR_RECORDER_DATA;
+        goto errors;
+    }
+    (*bit) = (uint8_t) ((recorder->buffer[recorder->bit_index >> 3] >> (7 - (recorder->bit_index & 0x07))) & 0x01);
+    recorder->bit_index++;
+errors:
+    return status;
+}
+
+/*******************************************************************/
+static ULTIMETER_status_t _ULTIMETER_RECORDER_read_exp_golomb(ULTIMETER_RECORDER_t* recorder, uint32_t* value) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    uint8_t bit = 0;
+    uint8_t prefix_length = 0;
+    uint8_t idx = 0;
+    uint32_t code = 1;
+    // Prefix.
+    while (1) {
+        status = _ULTIMETER_RECORDER_read_bit(recorder, &bit);
+        if (status != ULTIMETER_SUCCESS) goto errors;
+        if (bit != 0) break;
+        prefix_length++;
+        if (prefix_length > ULTIMETER_RECORDER_EXP_GOLOMB_PREFIX_MAX) {
+            status = ULTIMETER_ERROR_RECORDER_DATA;
+            goto errors;
+        }
+    }
+    // Value.
+    for (idx = 0; idx < prefix_length; idx++) {
+        status = _ULTIMETER_RECORDER_read_bit(recorder, &bit);
+        if (status != ULTIMETER_SUCCESS) goto errors;
+        code = ((code << 1) | bit);
+    }
+    (*value) = (code - 1);
+errors:
+    return status;
+}
+
+/*******************************************************************/
+static uint8_t _ULTIMETER_RECORDER_is_end(ULTIMETER_RECORDER_t* recorder) {
+    // Local variables.
+    uint32_t bit_index = recorder->bit_index;
+    uint8_t end_flag = 1;
+    // Each sample contains at least one bit set, so trailing zero bits are only padding.
+    while (bit_index < recorder->size_bits) {
+        if (((recorder->buffer[bit_index >> 3] >> (7 - (bit_index & 0x07))) & 0x01) != 0) {
+            end_flag = 0;
+            break;
+        }
+        bit_index++;
+    }
+    return end_flag;
+}
+
+/*** ULTIMETER RECORDER functions ***/
+
+/*******************************************************************/
+ULTIMETER_status_t ULTIMETER_RECORDER_init(ULTIMETER_RECORDER_t* recorder, uint8_t* buffer, uint32_t buffer_size_bytes) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    // Check parameters.
+    if ((recorder == NULL) || (buffer == NULL)) {
+        status = ULTIMETER_ERROR_NULL_PARAMETER;
+        goto errors;
+    }
+    // Init context.
+    recorder->buffer = buffer;
+    recorder->size_bits = (buffer_size_bytes << 3);
+    recorder->bit_index = 0;
+    recorder->sample_count = 0;
+    recorder->overflow_count = 0;
+    recorder->wind_speed_last = 0;
+    recorder->wind_direction_degrees_last = 0;
+errors:
+    return status;
+}
+
+/*******************************************************************/
+ULTIMETER_status_t ULTIMETER_RECORDER_append(ULTIMETER_RECORDER_t* recorder, ULTIMETER_RECORDER_sample_t* sample) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    uint32_t wind_speed = 0;
+    uint32_t peak_wind_speed = 0;
+    uint32_t wind_direction_degrees = 0;
+    uint32_t wind_speed_delta = 0;
+    uint32_t wind_direction_delta = 0;
+    int32_t delta = 0;
+    uint32_t sample_size_bits = 0;
+    // Check parameters.
+    if ((recorder == NULL) || (sample == NULL)) {
+        status = ULTIMETER_ERROR_NULL_PARAMETER;
+        goto errors;
+    }
+    if (recorder->buffer == NULL) {
+        status = ULTIMETER_ERROR_NULL_PARAMETER;
+        goto errors;
+    }
+    // Quantize speeds.
+    wind_speed = ((sample->wind_speed_mh + (ULTIMETER_RECORDER_WIND_SPEED_STEP_MH / 2)) / ULTIMETER_RECORDER_WIND_SPEED_STEP_MH);
+    peak_wind_speed = ((sample->peak_wind_speed_mh + (ULTIMETER_RECORDER_WIND_SPEED_STEP_MH / 2)) / ULTIMETER_RECORDER_WIND_SPEED_STEP_MH);
+    if (peak_wind_speed < wind_speed) {
+        peak_wind_speed = wind_speed;
+    }
+    wind_speed_delta = _ULTIMETER_RECORDER_zigzag_encode((int32_t) (wind_speed - recorder->wind_speed_last));
+    sample_size_bits = _ULTIMETER_RECORDER_get_exp_golomb_size(wind_speed_delta) + _ULTIMETER_RECORDER_get_exp_golomb_size(peak_wind_speed - wind_speed) + 1;
+    // Direction difference is wrapped to the shortest rotation.
+    if (sample->direction_status == ULTIMETER_WIND_DIRECTION_STATUS_AVAILABLE) {
+        wind_direction_degrees = (((uint32_t) sample->wind_direction_degrees) % MATH_2_PI_DEGREES);
+        delta = ((int32_t) wind_direction_degrees) - ((int32_t) recorder->wind_direction_degrees_last);
+        if (delta > (MATH_2_PI_DEGREES / 2)) {
+            delta -= MATH_2_PI_DEGREES;
+        }
+        if (delta <= (-(MATH_2_PI_DEGREES / 2))) {
+            delta += MATH_2_PI_DEGREES;
+        }
+        wind_direction_delta = _ULTIMETER_RECORDER_zigzag_encode(delta);
+        sample_size_bits += _ULTIMETER_RECORDER_get_exp_golomb_size(wind_direction_delta);
+    }
+    // Check remaining space.
+    if ((recorder->size_bits - recorder->bit_index) < sample_size_bits) {
+        recorder->overflow_count++;
+        status = ULTIMETER_ERROR_RECORDER_FULL;
+        goto errors;
+    }
+    // Encode sample.
+    _ULTIMETER_RECORDER_write_exp_golomb(recorder, wind_speed_delta);
+    _ULTIMETER_RECORDER_write_exp_golomb(recorder, (peak_wind_speed - wind_speed));
+    if (sample->direction_status == ULTIMETER_WIND_DIRECTION_STATUS_AVAILABLE) {
+        _ULTIMETER_RECORDER_write_bit(recorder, 1);
+        _ULTIMETER_RECORDER_write_exp_golomb(recorder, wind_direction_delta);
+        recorder->wind_direction_degrees_last = wind_direction_degrees;
+    }
+    else {
+        _ULTIMETER_RECORDER_write_bit(recorder, 0);
+    }
+    recorder->wind_speed_last = wind_speed;
+    recorder->sample_count++;
+errors:
+    return status;
+}
+
+/*******************************************************************/
+ULTIMETER_status_t ULTIMETER_RECORDER_get_data_size(ULTIMETER_RECORDER_t* recorder, uint32_t* data_size_bits, uint32_t* sample_count, uint32_t* overflow_count) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    // Check parameters.
+    if ((recorder == NULL) || (data_size_bits == NULL) || (sample_count == NULL) || (overflow_count == NULL)) {
+        status = ULTIMETER_ERROR_NULL_PARAMETER;
+        goto errors;
+    }
+    (*data_size_bits) = recorder->bit_index;
+    (*sample_count) = recorder->sample_count;
+    (*overflow_count) = recorder->overflow_count;
+errors:
+    return status;
+}
+
+/*******************************************************************/
+ULTIMETER_status_t ULTIMETER_RECORDER_open(ULTIMETER_RECORDER_t* recorder, uint8_t* buffer, uint32_t data_size_bits) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    // Check parameters.
+    if ((recorder == NULL) || (buffer == NULL)) {
+        status = ULTIMETER_ERROR_NULL_PARAMETER;
+        goto errors;
+    }
+    // Init context.
+    recorder->buffer = buffer;
+    recorder->size_bits = data_size_bits;
+    recorder->bit_index = 0;
+    recorder->sample_count = 0;
+    recorder->overflow_count = 0;
+    recorder->wind_speed_last = 0;
+    recorder->wind_direction_degrees_last = 0;
+errors:
+    return status;
+}
+
+/*******************************************************************/
+ULTIMETER_status_t ULTIMETER_RECORDER_read(ULTIMETER_RECORDER_t* recorder, ULTIMETER_RECORDER_sample_t* sample) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    uint32_t value = 0;
+    uint32_t wind_speed = 0;
+    int32_t wind_direction_degrees = 0;
+    uint8_t bit = 0;
+    // Check parameters.
+    if ((recorder == NULL) || (sample == NULL)) {
+        status = ULTIMETER_ERROR_NULL_PARAMETER;
+        goto errors;
+    }
+    if (recorder->buffer == NULL) {
+        status = ULTIMETER_ERROR_NULL_PARAMETER;
+        goto errors;
+    }
+    // Check end of record.
+    if (_ULTIMETER_RECORDER_is_end(recorder) != 0) {
+        status = ULTIMETER_ERROR_RECORDER_END;
+        goto errors;
+    }
+    // Speed.
+    status = _ULTIMETER_RECORDER_read_exp_golomb(recorder, &value);
+    if (status != ULTIMETER_SUCCESS) goto errors;
+    wind_speed = (uint32_t) (((int32_t) recorder->wind_speed_last) + _ULTIMETER_RECORDER_zigzag_decode(value));
+    // Peak.
+    status = _ULTIMETER_RECORDER_read_exp_golomb(recorder, &value);
+    if (status != ULTIMETER_SUCCESS) goto errors;
+    sample->wind_speed_mh = (wind_speed * ULTIMETER_RECORDER_WIND_SPEED_STEP_MH);
+    sample->peak_wind_speed_mh = ((wind_speed + value) * ULTIMETER_RECORDER_WIND_SPEED_STEP_MH);
+    // Direction.
+    status = _ULTIMETER_RECORDER_read_bit(recorder, &bit);
+    if (status != ULTIMETER_SUCCESS) goto errors;
+    sample->wind_direction_degrees = 0;
+    sample->direction_status = ULTIMETER_WIND_DIRECTION_STATUS_UNDEFINED;
+    if (bit != 0) {
+        status = _ULTIMETER_RECORDER_read_exp_golomb(recorder, &value);
+        if (status != ULTIMETER_SUCCESS) goto errors;
+        wind_direction_degrees = ((int32_t) recorder->wind_direction_degrees_last) + _ULTIMETER_RECORDER_zigzag_decode(value);
+        if (wind_direction_degrees < 0) {
+            wind_direction_degrees += MATH_2_PI_DEGREES;
+        }
+        if (wind_direction_degrees >= MATH_2_PI_DEGREES) {
+            wind_direction_degrees -= MATH_2_PI_DEGREES;
+        }
+        recorder->wind_direction_degrees_last = (uint32_t) wind_direction_degrees;
+        sample->wind_direction_degrees = wind_direction_degrees;
+        sample->direction_status = ULTIMETER_WIND_DIRECTION_STATUS_AVAILABLE;
+    }
+    recorder->wind_speed_last = wind_speed;
+    recorder->sample_count++;
+errors:
+    return status;
+}
+
+#endif /* ULTIMETER_DRIVER_RECORDER */
+#endif /* ULTIMETER_DRIVER_DISABLE */
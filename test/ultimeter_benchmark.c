@@ -0,0 +1,507 @@
+/*
+ * ultimeter_benchmark.c
+ *
+ *  Created on: 17 oct. 2026
+ *      Author: Ludo
+ */
+
+#ifndef ULTIMETER_DRIVER_DISABLE_FLAGS_FILE
+#include "ultimeter_driver_flags.h"
+#endif
+#include "ultimeter.h"
+#include "ultimeter_hw_sim.h"
+#include "ultimeter_trace.h"
+#ifdef ULTIMETER_DRIVER_WIND_DIRECTION_RECIPROCAL
+#include "ultimeter_math.h"
+#endif
+#ifdef ULTIMETER_DRIVER_BATCH
+#include "ultimeter_batch.h"
+#endif
+#include "types.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*** ULTIMETER BENCHMARK local macros ***/
+
+#define ULTIMETER_BENCHMARK_DURATION_SECONDS_DEFAULT    200000
+#define ULTIMETER_BENCHMARK_REPORT_PERIOD_SECONDS       600
+#define ULTIMETER_BENCHMARK_CALIBRATION_LOOPS           100000
+#define ULTIMETER_BENCHMARK_INSTANCES_DURATION_MIN      60
+#ifdef ULTIMETER_DRIVER_BATCH
+#define ULTIMETER_BENCHMARK_BATCH_DURATION_SECONDS      3600
+#define ULTIMETER_BENCHMARK_BATCH_EDGES_MAX             (ULTIMETER_BENCHMARK_BATCH_DURATION_SECONDS * 16)
+#define ULTIMETER_BENCHMARK_BATCH_WINDOW_COUNT          (ULTIMETER_BENCHMARK_BATCH_DURATION_SECONDS / ULTIMETER_DRIVER_WIND_SPEED_SAMPLING_TIME_SECONDS)
+#endif
+#ifdef ULTIMETER_DRIVER_WIND_DIRECTION_RECIPROCAL
+#define ULTIMETER_BENCHMARK_RECIPROCAL_DURATION_SECONDS 3600
+#define ULTIMETER_BENCHMARK_RECIPROCAL_ROTATIONS_MAX    (ULTIMETER_BENCHMARK_RECIPROCAL_DURATION_SECONDS * 16)
+#endif
+
+/*** ULTIMETER BENCHMARK local structures ***/
+
+/*******************************************************************/
+typedef struct {
+    char* name;
+    ULTIMETER_HW_SIM_configuration_t hw_configuration;
+    ULTIMETER_TRACE_profile_t profile;
+} ULTIMETER_BENCHMARK_scenario_t;
+
+/*******************************************************************/
+typedef struct {
+    uint64_t count;
+    uint64_t duration_ns;
+} ULTIMETER_BENCHMARK_timing_t;
+
+/*******************************************************************/
+typedef struct {
+    uint32_t report_count;
+    double speed_error_percent_sum;
+    double speed_error_percent_max;
+    double direction_error_degrees_sum;
+    double direction_error_degrees_max;
+    uint64_t rotation_count;
+} ULTIMETER_BENCHMARK_accuracy_t;
+
+/*** ULTIMETER BENCHMARK local global variables ***/
+
+static ULTIMETER_BENCHMARK_scenario_t ultimeter_benchmark_scenarios[] = {
+    { "steady", { 1000000, 32, 0 }, { 10000, 0, 0, 90, 0, 0, 0, 1 } },
+    { "gusty", { 1000000, 32, 0 }, { 8000, 4000, 60, 200, 20, 90, 100, 2 } },
+    { "narrow_counter", { 32768, 16, 0xFF00 }, { 7000, 2000, 45, 250, 10, 75, 50, 3 } },
+    { "north_sweep", { 1000000, 32, 0 }, { 6000, 0, 0, 0, 40, 120, 50, 4 } },
+};
+
+static uint8_t ultimeter_benchmark_instances_number[] = { 1, 2, 4, 8, 16, ULTIMETER_HW_SIM_INSTANCES_MAX };
+
+static ULTIMETER_handle_t ultimeter_benchmark_handle[ULTIMETER_HW_SIM_INSTANCES_MAX];
+static ULTIMETER_TRACE_t ultimeter_benchmark_trace[ULTIMETER_HW_SIM_INSTANCES_MAX];
+
+#ifdef ULTIMETER_DRIVER_BATCH
+static uint32_t ultimeter_benchmark_batch_wind_speed_edges[ULTIMETER_BENCHMARK_BATCH_EDGES_MAX];
+static uint32_t ultimeter_benchmark_batch_wind_direction_edges[ULTIMETER_BENCHMARK_BATCH_EDGES_MAX];
+static uint32_t ultimeter_benchmark_batch_wind_speed_mh[ULTIMETER_BENCHMARK_BATCH_WINDOW_COUNT];
+static uint32_t ultimeter_benchmark_batch_peak_wind_speed_mh[ULTIMETER_BENCHMARK_BATCH_WINDOW_COUNT];
+static int32_t ultimeter_benchmark_batch_wind_direction_degrees[ULTIMETER_BENCHMARK_BATCH_WINDOW_COUNT];
+static ULTIMETER_wind_direction_status_t ultimeter_benchmark_batch_direction_status[ULTIMETER_BENCHMARK_BATCH_WINDOW_COUNT];
+static int64_t ultimeter_benchmark_batch_trend_point_x[ULTIMETER_BENCHMARK_BATCH_WINDOW_COUNT];
+static int64_t ultimeter_benchmark_batch_trend_point_y[ULTIMETER_BENCHMARK_BATCH_WINDOW_COUNT];
+#endif
+
+#ifdef ULTIMETER_DRIVER_WIND_DIRECTION_RECIPROCAL
+static uint32_t ultimeter_benchmark_reciprocal_duty_cycle[ULTIMETER_BENCHMARK_RECIPROCAL_ROTATIONS_MAX];
+static uint32_t ultimeter_benchmark_reciprocal_period[ULTIMETER_BENCHMARK_RECIPROCAL_ROTATIONS_MAX];
+static uint32_t ultimeter_benchmark_reciprocal_tick_index[ULTIMETER_BENCHMARK_RECIPROCAL_ROTATIONS_MAX];
+static uint32_t ultimeter_benchmark_reciprocal_tick_period[ULTIMETER_BENCHMARK_RECIPROCAL_DURATION_SECONDS];
+static uint32_t ultimeter_benchmark_reciprocal_value[ULTIMETER_BENCHMARK_RECIPROCAL_DURATION_SECONDS + 1];
+static uint8_t ultimeter_benchmark_reciprocal_shift[ULTIMETER_BENCHMARK_RECIPROCAL_DURATION_SECONDS + 1];
+static volatile uint32_t ultimeter_benchmark_reciprocal_sink = 0;
+#endif
+
+/*** ULTIMETER BENCHMARK local functions ***/
+
+/*******************************************************************/
+static uint64_t _ULTIMETER_BENCHMARK_get_time_ns(void) {
+    // Local variables.
+    struct timespec now;
+    // Host monotonic clock.
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((((uint64_t) now.tv_sec) * 1000000000ULL) + ((uint64_t) now.tv_nsec));
+}
+
+/*******************************************************************/
+static uint64_t _ULTIMETER_BENCHMARK_calibrate(void) {
+    // Local variables.
+    uint64_t start_ns = 0;
+    uint64_t sum_ns = 0;
+    uint32_t idx = 0;
+    // Cost of an empty measurement, subtracted from each event.
+    for (idx = 0; idx < ULTIMETER_BENCHMARK_CALIBRATION_LOOPS; idx++) {
+        start_ns = _ULTIMETER_BENCHMARK_get_time_ns();
+        sum_ns += (_ULTIMETER_BENCHMARK_get_time_ns() - start_ns);
+    }
+    return (sum_ns / ULTIMETER_BENCHMARK_CALIBRATION_LOOPS);
+}
+
+/*******************************************************************/
+static void _ULTIMETER_BENCHMARK_process_callback(ULTIMETER_handle_t* handle) {
+    UNUSED(handle);
+}
+
+/*******************************************************************/
+static void _ULTIMETER_BENCHMARK_start(uint8_t instance, ULTIMETER_HW_SIM_configuration_t* hw_configuration, ULTIMETER_TRACE_profile_t* profile) {
+    // Local variables.
+    ULTIMETER_configuration_t configuration;
+    // Init simulated timer, instance and trace.
+    memset(&configuration, 0, sizeof(ULTIMETER_configuration_t));
+    configuration.instance = instance;
+    configuration.process_callback = &_ULTIMETER_BENCHMARK_process_callback;
+    ULTIMETER_HW_SIM_configure(instance, hw_configuration);
+    ULTIMETER_init(&(ultimeter_benchmark_handle[instance]), &configuration);
+    ULTIMETER_set_wind_measurement(&(ultimeter_benchmark_handle[instance]), 1);
+    ULTIMETER_TRACE_init(&(ultimeter_benchmark_trace[instance]), instance, (hw_configuration->timer_frequency_hz), profile);
+}
+
+/*******************************************************************/
+static void _ULTIMETER_BENCHMARK_measure(uint8_t instance, uint64_t end_ticks, uint64_t overhead_ns, ULTIMETER_BENCHMARK_timing_t* timing) {
+    // Local variables.
+    ULTIMETER_TRACE_event_t event = ULTIMETER_TRACE_step(&(ultimeter_benchmark_trace[instance]), end_ticks);
+    uint64_t start_ns = 0;
+    uint64_t duration_ns = 0;
+    // Measure the event alone.
+    if (event != ULTIMETER_TRACE_EVENT_END) {
+        start_ns = _ULTIMETER_BENCHMARK_get_time_ns();
+        ULTIMETER_TRACE_dispatch(&(ultimeter_benchmark_trace[instance]), &(ultimeter_benchmark_handle[instance]), event);
+        duration_ns = (_ULTIMETER_BENCHMARK_get_time_ns() - start_ns);
+        timing[event].count++;
+        timing[event].duration_ns += (duration_ns > overhead_ns) ? (duration_ns - overhead_ns) : 0;
+    }
+}
+
+/*******************************************************************/
+static void _ULTIMETER_BENCHMARK_print_timing(ULTIMETER_BENCHMARK_timing_t* timing) {
+    // Local variables.
+    uint32_t idx = 0;
+    // Mean duration of each event type.
+    for (idx = 0; idx < ULTIMETER_TRACE_EVENT_END; idx++) {
+        printf(" %10.1f", (timing[idx].count == 0) ? 0.0 : (((double) timing[idx].duration_ns) / ((double) timing[idx].count)));
+    }
+}
+
+/*******************************************************************/
+static void _ULTIMETER_BENCHMARK_update_accuracy(ULTIMETER_BENCHMARK_accuracy_t* accuracy) {
+    // Local variables.
+    int32_t average_speed_mh = 0;
+    int32_t peak_speed_mh = 0;
+    double truth_speed_mh = 0.0;
+    double truth_direction_degrees = 0.0;
+    double error = 0.0;
+    uint32_t truth_rotation_count = 0;
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+    int32_t average_direction_degrees = 0;
+    ULTIMETER_wind_direction_status_t direction_status = ULTIMETER_WIND_DIRECTION_STATUS_UNDEFINED;
+#endif
+    // Compare the driver outputs with the ground truth of the report period.
+    ULTIMETER_TRACE_get_truth(&(ultimeter_benchmark_trace[0]), &truth_speed_mh, &truth_direction_degrees, &truth_rotation_count);
+    ULTIMETER_get_wind_speed(&(ultimeter_benchmark_handle[0]), &average_speed_mh, &peak_speed_mh);
+    if (truth_speed_mh > 0.0) {
+        error = (fabs(((double) average_speed_mh) - truth_speed_mh) * 100.0) / truth_speed_mh;
+        accuracy->speed_error_percent_sum += error;
+        accuracy->speed_error_percent_max = (error > (accuracy->speed_error_percent_max)) ? error : (accuracy->speed_error_percent_max);
+    }
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+    ULTIMETER_get_wind_direction(&(ultimeter_benchmark_handle[0]), &average_direction_degrees, &direction_status);
+    if (direction_status == ULTIMETER_WIND_DIRECTION_STATUS_AVAILABLE) {
+        error = ULTIMETER_TRACE_get_direction_error((double) average_direction_degrees, truth_direction_degrees);
+        accuracy->direction_error_degrees_sum += error;
+        accuracy->direction_error_degrees_max = (error > (accuracy->direction_error_degrees_max)) ? error : (accuracy->direction_error_degrees_max);
+    }
+#endif
+    accuracy->rotation_count += truth_rotation_count;
+    accuracy->report_count++;
+    // Start next report period.
+    ULTIMETER_reset_measurements(&(ultimeter_benchmark_handle[0]));
+    ULTIMETER_TRACE_reset_truth(&(ultimeter_benchmark_trace[0]));
+}
+
+/*******************************************************************/
+static void _ULTIMETER_BENCHMARK_run(ULTIMETER_BENCHMARK_scenario_t* scenario, uint32_t duration_seconds, uint64_t overhead_ns) {
+    // Local variables.
+    ULTIMETER_BENCHMARK_timing_t timing[ULTIMETER_TRACE_EVENT_END];
+    ULTIMETER_BENCHMARK_accuracy_t accuracy;
+    uint64_t period_end_ticks = 0;
+    uint32_t idx = 0;
+    // Init instance and trace.
+    memset(timing, 0, sizeof(timing));
+    memset(&accuracy, 0, sizeof(ULTIMETER_BENCHMARK_accuracy_t));
+    _ULTIMETER_BENCHMARK_start(0, &(scenario->hw_configuration), &(scenario->profile));
+    // Report periods.
+    for (idx = 0; idx < (duration_seconds / ULTIMETER_BENCHMARK_REPORT_PERIOD_SECONDS); idx++) {
+        period_end_ticks = (ultimeter_benchmark_trace[0].time_ticks) + (((uint64_t) ULTIMETER_BENCHMARK_REPORT_PERIOD_SECONDS) * ((uint64_t) scenario->hw_configuration.timer_frequency_hz));
+        while (ULTIMETER_TRACE_get_next_time(&(ultimeter_benchmark_trace[0])) <= period_end_ticks) {
+            _ULTIMETER_BENCHMARK_measure(0, period_end_ticks, overhead_ns, timing);
+        }
+        ULTIMETER_TRACE_step(&(ultimeter_benchmark_trace[0]), period_end_ticks);
+        _ULTIMETER_BENCHMARK_update_accuracy(&accuracy);
+    }
+    ULTIMETER_de_init(&(ultimeter_benchmark_handle[0]));
+    // Print results.
+    printf("%-16s %10llu", scenario->name, (unsigned long long) accuracy.rotation_count);
+    _ULTIMETER_BENCHMARK_print_timing(timing);
+    printf(" %8.3f %8.3f", (accuracy.report_count == 0) ? 0.0 : (accuracy.speed_error_percent_sum / ((double) accuracy.report_count)), accuracy.speed_error_percent_max);
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+    printf(" %8.2f %8.2f", (accuracy.report_count == 0) ? 0.0 : (accuracy.direction_error_degrees_sum / ((double) accuracy.report_count)), accuracy.direction_error_degrees_max);
+#endif
+    printf("\r\n");
+}
+
+/*******************************************************************/
+static void _ULTIMETER_BENCHMARK_run_instances(uint8_t instances_number, uint32_t duration_seconds, uint64_t overhead_ns) {
+    // Local variables.
+    ULTIMETER_HW_SIM_configuration_t hw_configuration = { 1000000, 32, 0 };
+    ULTIMETER_TRACE_profile_t profile = { 0, 2000, 60, 0, 20, 90, 50, 0 };
+    ULTIMETER_BENCHMARK_timing_t timing[ULTIMETER_TRACE_EVENT_END];
+    uint64_t end_ticks = (((uint64_t) duration_seconds) * ((uint64_t) hw_configuration.timer_frequency_hz));
+    uint64_t next_ticks = 0;
+    uint8_t instance = 0;
+    uint8_t idx = 0;
+    // Same wind intensity on all sensors with different phases, so that the number of events is proportional to the number of sensors.
+    memset(timing, 0, sizeof(timing));
+    for (idx = 0; idx < instances_number; idx++) {
+        profile.rotation_frequency_mhz = (7000 + ((idx % 4) * 500));
+        profile.direction_degrees = ((idx * 37) % 360);
+        profile.seed = (100 + idx);
+        hw_configuration.timer_counter_start = (((uint32_t) idx) * 0x08000000);
+        _ULTIMETER_BENCHMARK_start(idx, &hw_configuration, &profile);
+    }
+    // Interleave the events of all sensors in time order.
+    while (1) {
+        next_ticks = ULTIMETER_HW_SIM_TIME_NONE;
+        for (idx = 0; idx < instances_number; idx++) {
+            if (ULTIMETER_TRACE_get_next_time(&(ultimeter_benchmark_trace[idx])) < next_ticks) {
+                next_ticks = ULTIMETER_TRACE_get_next_time(&(ultimeter_benchmark_trace[idx]));
+                instance = idx;
+            }
+        }
+        if (next_ticks > end_ticks) break;
+        _ULTIMETER_BENCHMARK_measure(instance, end_ticks, overhead_ns, timing);
+    }
+    for (idx = 0; idx < instances_number; idx++) {
+        ULTIMETER_de_init(&(ultimeter_benchmark_handle[idx]));
+    }
+    // Print results.
+    printf("%-9u %10u %10u", (unsigned int) instances_number, (unsigned int) (instances_number * sizeof(ULTIMETER_handle_t)), (unsigned int) sizeof(ULTIMETER_handle_t));
+    _ULTIMETER_BENCHMARK_print_timing(timing);
+    printf("\r\n");
+}
+
+#ifdef ULTIMETER_DRIVER_BATCH
+/*******************************************************************/
+static void _ULTIMETER_BENCHMARK_run_batch(ULTIMETER_BENCHMARK_scenario_t* scenario, uint32_t loop_count) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    ULTIMETER_HW_SIM_configuration_t hw_configuration = { (scenario->hw_configuration.timer_frequency_hz), 32, 0 };
+    ULTIMETER_BATCH_input_t input;
+    ULTIMETER_BATCH_output_t output;
+    ULTIMETER_TRACE_event_t event = ULTIMETER_TRACE_EVENT_END;
+    uint64_t end_ticks = (((uint64_t) ULTIMETER_BENCHMARK_BATCH_DURATION_SECONDS) * ((uint64_t) hw_configuration.timer_frequency_hz));
+    uint64_t start_ns = 0;
+    uint64_t duration_ns = 0;
+    uint64_t edge_count = 0;
+    double truth_speed_mh = 0.0;
+    double truth_direction_degrees = 0.0;
+    double batch_speed_mh = 0.0;
+    uint32_t truth_rotation_count = 0;
+    uint32_t idx = 0;
+    // Record the edges timestamps of the trace (32-bits counter, the batch API works on raw captures).
+    memset(&input, 0, sizeof(ULTIMETER_BATCH_input_t));
+    ULTIMETER_HW_SIM_configure(0, &hw_configuration);
+    ULTIMETER_TRACE_init(&(ultimeter_benchmark_trace[0]), 0, hw_configuration.timer_frequency_hz, &(scenario->profile));
+    do {
+        event = ULTIMETER_TRACE_step(&(ultimeter_benchmark_trace[0]), end_ticks);
+        if ((event == ULTIMETER_TRACE_EVENT_WIND_SPEED_EDGE) && (input.wind_speed_edge_count < ULTIMETER_BENCHMARK_BATCH_EDGES_MAX)) {
+            ultimeter_benchmark_batch_wind_speed_edges[input.wind_speed_edge_count++] = ULTIMETER_HW_timer_get_counter(0);
+        }
+        if ((event == ULTIMETER_TRACE_EVENT_WIND_DIRECTION_EDGE) && (input.wind_direction_edge_count < ULTIMETER_BENCHMARK_BATCH_EDGES_MAX)) {
+            ultimeter_benchmark_batch_wind_direction_edges[input.wind_direction_edge_count++] = ULTIMETER_HW_timer_get_counter(0);
+        }
+        // No driver is attached, the tick only schedules the next one.
+        if (event == ULTIMETER_TRACE_EVENT_TICK) {
+            ULTIMETER_HW_SIM_tick(0);
+        }
+    }
+    while (event != ULTIMETER_TRACE_EVENT_END);
+    input.wind_speed_edge_timestamps = ultimeter_benchmark_batch_wind_speed_edges;
+    input.wind_direction_edge_timestamps = ultimeter_benchmark_batch_wind_direction_edges;
+    input.start_counter = 0;
+    input.timer_frequency_hz = hw_configuration.timer_frequency_hz;
+    input.wind_speed_sampling_time_seconds = ULTIMETER_DRIVER_WIND_SPEED_SAMPLING_TIME_SECONDS;
+    input.wind_direction_sampling_period_seconds = ULTIMETER_DRIVER_WIND_DIRECTION_SAMPLING_PERIOD_SECONDS;
+    output.wind_speed_mh = ultimeter_benchmark_batch_wind_speed_mh;
+    output.peak_wind_speed_mh = ultimeter_benchmark_batch_peak_wind_speed_mh;
+    output.wind_direction_degrees = ultimeter_benchmark_batch_wind_direction_degrees;
+    output.direction_status = ultimeter_benchmark_batch_direction_status;
+    output.trend_point_x = ultimeter_benchmark_batch_trend_point_x;
+    output.trend_point_y = ultimeter_benchmark_batch_trend_point_y;
+    // Process the whole trace several times.
+    start_ns = _ULTIMETER_BENCHMARK_get_time_ns();
+    for (idx = 0; idx < loop_count; idx++) {
+        status = ULTIMETER_BATCH_process(&input, &output, ULTIMETER_BENCHMARK_BATCH_WINDOW_COUNT);
+        if (status != ULTIMETER_SUCCESS) break;
+    }
+    duration_ns = (_ULTIMETER_BENCHMARK_get_time_ns() - start_ns);
+    // Average of the windows speeds against the ground truth.
+    ULTIMETER_TRACE_get_truth(&(ultimeter_benchmark_trace[0]), &truth_speed_mh, &truth_direction_degrees, &truth_rotation_count);
+    for (idx = 0; idx < ULTIMETER_BENCHMARK_BATCH_WINDOW_COUNT; idx++) {
+        batch_speed_mh += ((double) ultimeter_benchmark_batch_wind_speed_mh[idx]);
+    }
+    batch_speed_mh /= ((double) ULTIMETER_BENCHMARK_BATCH_WINDOW_COUNT);
+    edge_count = (((uint64_t) (input.wind_speed_edge_count + input.wind_direction_edge_count)) * ((uint64_t) loop_count));
+    // Print results.
+    printf("\r\nBatch processing of the %s scenario: status %d, %u windows of %u speed and %u direction edges processed %u times\r\n", scenario->name, (int) status, (unsigned int) ULTIMETER_BENCHMARK_BATCH_WINDOW_COUNT, (unsigned int) input.wind_speed_edge_count, (unsigned int) input.wind_direction_edge_count, (unsigned int) loop_count);
+    printf("%.1f ns per window, %.2f Medges/s, average speed %.1f m/h (truth %.1f)\r\n", ((double) duration_ns) / (((double) ULTIMETER_BENCHMARK_BATCH_WINDOW_COUNT) * ((double) loop_count)), (duration_ns == 0) ? 0.0 : ((((double) edge_count) * 1000.0) / ((double) duration_ns)), batch_speed_mh, truth_speed_mh);
+}
+#endif
+
+#ifdef ULTIMETER_DRIVER_WIND_DIRECTION_RECIPROCAL
+/*******************************************************************/
+static uint32_t _ULTIMETER_BENCHMARK_run_reciprocal(ULTIMETER_BENCHMARK_scenario_t* scenario, uint32_t loop_count) {
+    // Local variables.
+    ULTIMETER_HW_SIM_configuration_t hw_configuration = { (scenario->hw_configuration.timer_frequency_hz), 32, 0 };
+    ULTIMETER_TRACE_event_t event = ULTIMETER_TRACE_EVENT_END;
+    uint64_t end_ticks = (((uint64_t) ULTIMETER_BENCHMARK_RECIPROCAL_DURATION_SECONDS) * ((uint64_t) hw_configuration.timer_frequency_hz));
+    uint64_t rotation_start_ticks = 0;
+    uint64_t direction_ticks = ULTIMETER_HW_SIM_TIME_NONE;
+    uint64_t start_ns = 0;
+    uint64_t refine_ns = 0;
+    uint64_t reciprocal_ns = 0;
+    uint64_t division_ns = 0;
+    uint32_t rotation_count = 0;
+    uint32_t tick_count = 0;
+    uint32_t last_period = 0;
+    uint32_t angle = 0;
+    uint32_t reference_angle = 0;
+    uint32_t error = 0;
+    uint32_t error_max = 0;
+    uint32_t error_count = 0;
+    uint32_t sum = 0;
+    uint32_t loop_idx = 0;
+    uint32_t idx = 0;
+    // Record the duty cycle and period of each rotation, and the last rotation period of each tick.
+    ULTIMETER_HW_SIM_configure(0, &hw_configuration);
+    ULTIMETER_TRACE_init(&(ultimeter_benchmark_trace[0]), 0, hw_configuration.timer_frequency_hz, &(scenario->profile));
+    do {
+        event = ULTIMETER_TRACE_step(&(ultimeter_benchmark_trace[0]), end_ticks);
+        if (event == ULTIMETER_TRACE_EVENT_WIND_DIRECTION_EDGE) {
+            direction_ticks = ultimeter_benchmark_trace[0].time_ticks;
+        }
+        if (event == ULTIMETER_TRACE_EVENT_WIND_SPEED_EDGE) {
+            // The first rotation start is unknown, like in the driver.
+            if ((rotation_start_ticks != 0) && (direction_ticks != ULTIMETER_HW_SIM_TIME_NONE) && (rotation_count < ULTIMETER_BENCHMARK_RECIPROCAL_ROTATIONS_MAX)) {
+                last_period = (uint32_t) ((ultimeter_benchmark_trace[0].time_ticks) - rotation_start_ticks);
+                ultimeter_benchmark_reciprocal_duty_cycle[rotation_count] = (uint32_t) (direction_ticks - rotation_start_ticks);
+                ultimeter_benchmark_reciprocal_period[rotation_count] = last_period;
+                ultimeter_benchmark_reciprocal_tick_index[rotation_count] = tick_count;
+                rotation_count++;
+            }
+            rotation_start_ticks = ultimeter_benchmark_trace[0].time_ticks;
+            direction_ticks = ULTIMETER_HW_SIM_TIME_NONE;
+        }
+        // No driver is attached, the tick only schedules the next one.
+        if (event == ULTIMETER_TRACE_EVENT_TICK) {
+            ULTIMETER_HW_SIM_tick(0);
+            if ((last_period != 0) && (tick_count < ULTIMETER_BENCHMARK_RECIPROCAL_DURATION_SECONDS)) {
+                ultimeter_benchmark_reciprocal_tick_period[tick_count++] = last_period;
+            }
+        }
+    }
+    while (event != ULTIMETER_TRACE_EVENT_END);
+    // Refinement of ULTIMETER_process(), seeded by the reciprocal of the previous tick (rotations before the first tick use the division).
+    start_ns = _ULTIMETER_BENCHMARK_get_time_ns();
+    for (loop_idx = 0; loop_idx < loop_count; loop_idx++) {
+        ultimeter_benchmark_reciprocal_value[0] = 0;
+        ultimeter_benchmark_reciprocal_shift[0] = 0;
+        for (idx = 0; idx < tick_count; idx++) {
+            ultimeter_benchmark_reciprocal_value[idx + 1] = ultimeter_benchmark_reciprocal_value[idx];
+            ultimeter_benchmark_reciprocal_shift[idx + 1] = ultimeter_benchmark_reciprocal_shift[idx];
+            ULTIMETER_MATH_refine_wind_direction_reciprocal(ultimeter_benchmark_reciprocal_tick_period[idx], &(ultimeter_benchmark_reciprocal_value[idx + 1]), &(ultimeter_benchmark_reciprocal_shift[idx + 1]));
+        }
+    }
+    refine_ns = (_ULTIMETER_BENCHMARK_get_time_ns() - start_ns);
+    // Direction of each rotation in the speed edge interrupt, with the reciprocal of the last tick (worst case of ULTIMETER_DRIVER_WIND_DIRECTION_PER_ROTATION).
+    start_ns = _ULTIMETER_BENCHMARK_get_time_ns();
+    for (loop_idx = 0; loop_idx < loop_count; loop_idx++) {
+        for (idx = 0; idx < rotation_count; idx++) {
+            sum += ULTIMETER_MATH_compute_wind_direction_angle_reciprocal(ultimeter_benchmark_reciprocal_duty_cycle[idx], ultimeter_benchmark_reciprocal_period[idx], ultimeter_benchmark_reciprocal_value[ultimeter_benchmark_reciprocal_tick_index[idx]], ultimeter_benchmark_reciprocal_shift[ultimeter_benchmark_reciprocal_tick_index[idx]]);
+        }
+    }
+    reciprocal_ns = (_ULTIMETER_BENCHMARK_get_time_ns() - start_ns);
+    start_ns = _ULTIMETER_BENCHMARK_get_time_ns();
+    for (loop_idx = 0; loop_idx < loop_count; loop_idx++) {
+        for (idx = 0; idx < rotation_count; idx++) {
+            sum += ULTIMETER_MATH_compute_wind_direction_angle(ultimeter_benchmark_reciprocal_duty_cycle[idx], ultimeter_benchmark_reciprocal_period[idx]);
+        }
+    }
+    division_ns = (_ULTIMETER_BENCHMARK_get_time_ns() - start_ns);
+    ultimeter_benchmark_reciprocal_sink = sum;
+    // Error bound against the division.
+    for (idx = 0; idx < rotation_count; idx++) {
+        angle = ULTIMETER_MATH_compute_wind_direction_angle_reciprocal(ultimeter_benchmark_reciprocal_duty_cycle[idx], ultimeter_benchmark_reciprocal_period[idx], ultimeter_benchmark_reciprocal_value[ultimeter_benchmark_reciprocal_tick_index[idx]], ultimeter_benchmark_reciprocal_shift[ultimeter_benchmark_reciprocal_tick_index[idx]]);
+        reference_angle = ULTIMETER_MATH_compute_wind_direction_angle(ultimeter_benchmark_reciprocal_duty_cycle[idx], ultimeter_benchmark_reciprocal_period[idx]);
+        error = (angle > reference_angle) ? (angle - reference_angle) : (reference_angle - angle);
+        if (error > (ULTIMETER_WIND_DIRECTION_FULL_TURN / 2)) {
+            error = (ULTIMETER_WIND_DIRECTION_FULL_TURN - error);
+        }
+        if (error != 0) {
+            error_count++;
+        }
+        error_max = (error > error_max) ? error : error_max;
+    }
+    // Print results.
+    printf("%-16s %10u %10.1f %10.1f %10.1f %10.1f %10u %10u\r\n", scenario->name, (unsigned int) rotation_count,
+        (rotation_count == 0) ? 0.0 : (((double) division_ns) / (((double) rotation_count) * ((double) loop_count))),
+        (rotation_count == 0) ? 0.0 : (((double) reciprocal_ns) / (((double) rotation_count) * ((double) loop_count))),
+        (tick_count == 0) ? 0.0 : (((double) refine_ns) / (((double) tick_count) * ((double) loop_count))),
+        (rotation_count == 0) ? 0.0 : ((((double) division_ns) - ((double) reciprocal_ns) - ((double) refine_ns)) / (((double) rotation_count) * ((double) loop_count))),
+        (unsigned int) error_count, (unsigned int) error_max);
+    return error_count;
+}
+#endif
+
+/*** ULTIMETER BENCHMARK functions ***/
+
+/*******************************************************************/
+int main(int argc, char** argv) {
+    // Local variables.
+    uint32_t duration_seconds = ULTIMETER_BENCHMARK_DURATION_SECONDS_DEFAULT;
+    uint32_t instances_duration_seconds = 0;
+    uint64_t overhead_ns = 0;
+    int result = 0;
+    uint32_t idx = 0;
+    // Simulated duration of each scenario.
+    if (argc > 1) {
+        duration_seconds = (uint32_t) strtoul(argv[1], NULL, 10);
+    }
+    if (duration_seconds < ULTIMETER_BENCHMARK_REPORT_PERIOD_SECONDS) {
+        duration_seconds = ULTIMETER_BENCHMARK_REPORT_PERIOD_SECONDS;
+    }
+    overhead_ns = _ULTIMETER_BENCHMARK_calibrate();
+    printf("Instance context: %u bytes, simulated duration: %u s per scenario, timer read overhead: %llu ns\r\n", (unsigned int) sizeof(ULTIMETER_handle_t), (unsigned int) duration_seconds, (unsigned long long) overhead_ns);
+    printf("Accuracy is computed against the ground truth of each %u s report period.\r\n", (unsigned int) ULTIMETER_BENCHMARK_REPORT_PERIOD_SECONDS);
+    printf("%-16s %10s %10s %10s %10s %8s %8s", "scenario", "rotations", "speed ns", "dir ns", "tick ns", "spd avg%", "spd max%");
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+    printf(" %8s %8s", "dir avg", "dir max");
+#endif
+    printf("\r\n");
+    // Run all scenarios.
+    for (idx = 0; idx < (sizeof(ultimeter_benchmark_scenarios) / sizeof(ULTIMETER_BENCHMARK_scenario_t)); idx++) {
+        _ULTIMETER_BENCHMARK_run(&(ultimeter_benchmark_scenarios[idx]), duration_seconds, overhead_ns);
+    }
+    // Run the same total number of events with an increasing number of sensors (the driver has no static context).
+    printf("\r\n%-9s %10s %10s %10s %10s %10s\r\n", "sensors", "RAM bytes", "per sensor", "speed ns", "dir ns", "tick ns");
+    for (idx = 0; idx < sizeof(ultimeter_benchmark_instances_number); idx++) {
+        instances_duration_seconds = (duration_seconds / ultimeter_benchmark_instances_number[idx]);
+        if (instances_duration_seconds < ULTIMETER_BENCHMARK_INSTANCES_DURATION_MIN) {
+            instances_duration_seconds = ULTIMETER_BENCHMARK_INSTANCES_DURATION_MIN;
+        }
+        _ULTIMETER_BENCHMARK_run_instances(ultimeter_benchmark_instances_number[idx], instances_duration_seconds, overhead_ns);
+    }
+#ifdef ULTIMETER_DRIVER_BATCH
+    // Process the recorded edges of the gusty scenario offline, as many times as needed to cover the simulated duration.
+    _ULTIMETER_BENCHMARK_run_batch(&(ultimeter_benchmark_scenarios[1]), ((duration_seconds + ULTIMETER_BENCHMARK_BATCH_DURATION_SECONDS - 1) / ULTIMETER_BENCHMARK_BATCH_DURATION_SECONDS));
+#endif
+#ifdef ULTIMETER_DRIVER_WIND_DIRECTION_RECIPROCAL
+    // Compare the reciprocal direction with the division on the recorded rotations of each scenario (the benchmark fails if any direction differs).
+    printf("\r\nDirection reciprocal against division (ns per rotation, refinement in ns per tick, savings per rotation include the refinement):\r\n");
+    printf("%-16s %10s %10s %10s %10s %10s %10s %10s\r\n", "scenario", "rotations", "div ns", "recip ns", "refine ns", "saved ns", "errors", "error max");
+    for (idx = 0; idx < (sizeof(ultimeter_benchmark_scenarios) / sizeof(ULTIMETER_BENCHMARK_scenario_t)); idx++) {
+        if (_ULTIMETER_BENCHMARK_run_reciprocal(&(ultimeter_benchmark_scenarios[idx]), ((duration_seconds + ULTIMETER_BENCHMARK_RECIPROCAL_DURATION_SECONDS - 1) / ULTIMETER_BENCHMARK_RECIPROCAL_DURATION_SECONDS)) != 0) {
+            result = 1;
+        }
+    }
+#endif
+    return result;
+}
@@ -0,0 +1,248 @@
+/*
+ * ultimeter_hw_sim.c
+ *
+ *  Created on: 17 oct. 2026
+ *      Author: Ludo
+ */
+
+#include "ultimeter_hw_sim.h"
+
+#ifndef ULTIMETER_DRIVER_DISABLE_FLAGS_FILE
+#include "ultimeter_driver_flags.h"
+#endif
+#include "ultimeter.h"
+#include "ultimeter_hw.h"
+#include "types.h"
+
+#ifdef ULTIMETER_DRIVER_DIAGNOSTICS
+#include <time.h>
+#endif
+
+/*** ULTIMETER HW SIM local structures ***/
+
+/*******************************************************************/
+typedef struct {
+    ULTIMETER_HW_configuration_t configuration;
+    uint32_t timer_frequency_hz;
+    uint8_t timer_counter_width;
+    uint32_t timer_counter_start;
+    uint32_t timer_counter_mask;
+    uint64_t time_ticks;
+    uint64_t tick_time_ticks;
+    uint8_t init_flag;
+    uint8_t timer_running_flag;
+    uint8_t interrupts_enable_flag;
+    uint8_t critical_flag;
+    ULTIMETER_HW_SIM_status_t status;
+} ULTIMETER_HW_SIM_context_t;
+
+/*** ULTIMETER HW SIM local global variables ***/
+
+static ULTIMETER_HW_SIM_context_t ultimeter_hw_sim_ctx[ULTIMETER_HW_SIM_INSTANCES_MAX];
+
+/*** ULTIMETER HW SIM functions ***/
+
+/*******************************************************************/
+void ULTIMETER_HW_SIM_configure(uint8_t instance, ULTIMETER_HW_SIM_configuration_t* configuration) {
+    // Local variables.
+    ULTIMETER_HW_SIM_context_t* context = &(ultimeter_hw_sim_ctx[instance]);
+    // Timer parameters.
+    context->timer_frequency_hz = (configuration->timer_frequency_hz);
+    context->timer_counter_width = (configuration->timer_counter_width);
+    context->timer_counter_start = (configuration->timer_counter_start);
+    context->timer_counter_mask = ((configuration->timer_counter_width) >= 32) ? 0xFFFFFFFF : ((((uint32_t) 1) << (configuration->timer_counter_width)) - 1);
+    // Reset time, the first tick occurs after 1 second.
+    context->time_ticks = 0;
+#ifdef ULTIMETER_DRIVER_TICKLESS
+    context->tick_time_ticks = ULTIMETER_HW_SIM_TIME_NONE;
+#else
+    context->tick_time_ticks = (uint64_t) (context->timer_frequency_hz);
+#endif
+    context->init_flag = 0;
+    context->timer_running_flag = 0;
+    context->interrupts_enable_flag = 0;
+    context->critical_flag = 0;
+    context->status.nested_critical_count = 0;
+    context->status.masked_edge_count = 0;
+    context->status.alarm_count = 0;
+}
+
+/*******************************************************************/
+void ULTIMETER_HW_SIM_set_time(uint8_t instance, uint64_t time_ticks) {
+    // Time only moves forward.
+    if (time_ticks > ultimeter_hw_sim_ctx[instance].time_ticks) {
+        ultimeter_hw_sim_ctx[instance].time_ticks = time_ticks;
+    }
+}
+
+/*******************************************************************/
+uint64_t ULTIMETER_HW_SIM_get_tick_time(uint8_t instance) {
+    return (ultimeter_hw_sim_ctx[instance].tick_time_ticks);
+}
+
+/*******************************************************************/
+void ULTIMETER_HW_SIM_wind_speed_edge(uint8_t instance) {
+    // Local variables.
+    ULTIMETER_HW_SIM_context_t* context = &(ultimeter_hw_sim_ctx[instance]);
+    // Call driver if the interrupt is enabled.
+    if ((context->init_flag == 0) || (context->interrupts_enable_flag == 0)) {
+        context->status.masked_edge_count++;
+    }
+    else if (context->configuration.wind_speed_edge_irq_callback != NULL) {
+        context->configuration.wind_speed_edge_irq_callback(context->configuration.handle);
+    }
+}
+
+/*******************************************************************/
+void ULTIMETER_HW_SIM_wind_direction_edge(uint8_t instance) {
+    // Local variables.
+    ULTIMETER_HW_SIM_context_t* context = &(ultimeter_hw_sim_ctx[instance]);
+    // Call driver if the interrupt is enabled (the callback is NULL when the direction is not measured).
+    if ((context->init_flag == 0) || (context->interrupts_enable_flag == 0)) {
+        context->status.masked_edge_count++;
+    }
+    else if (context->configuration.wind_direction_edge_irq_callback != NULL) {
+        context->configuration.wind_direction_edge_irq_callback(context->configuration.handle);
+    }
+}
+
+/*******************************************************************/
+void ULTIMETER_HW_SIM_tick(uint8_t instance) {
+    // Local variables.
+    ULTIMETER_HW_SIM_context_t* context = &(ultimeter_hw_sim_ctx[instance]);
+    // Schedule next tick, the alarm is one-shot.
+#ifdef ULTIMETER_DRIVER_TICKLESS
+    context->tick_time_ticks = ULTIMETER_HW_SIM_TIME_NONE;
+#else
+    context->tick_time_ticks += (uint64_t) (context->timer_frequency_hz);
+#endif
+    // Call driver.
+#ifdef ULTIMETER_DRIVER_TICKLESS
+    // The alarm does not depend on the timer, which is stopped between the duty cycle bursts.
+    if ((context->init_flag != 0) && (context->configuration.tick_second_irq_callback != NULL)) {
+#else
+    if ((context->init_flag != 0) && (context->timer_running_flag != 0) && (context->configuration.tick_second_irq_callback != NULL)) {
+#endif
+        context->configuration.tick_second_irq_callback(context->configuration.handle);
+    }
+}
+
+/*******************************************************************/
+void ULTIMETER_HW_SIM_get_status(uint8_t instance, ULTIMETER_HW_SIM_status_t* status) {
+    (*status) = ultimeter_hw_sim_ctx[instance].status;
+}
+
+/*** ULTIMETER HW functions ***/
+
+/*******************************************************************/
+ULTIMETER_status_t ULTIMETER_HW_init(uint8_t instance, ULTIMETER_HW_configuration_t* configuration) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    // Check instance.
+    if (instance >= ULTIMETER_HW_SIM_INSTANCES_MAX) {
+        status = ULTIMETER_ERROR_BASE_TIMER;
+        goto errors;
+    }
+    // Store callbacks.
+    ultimeter_hw_sim_ctx[instance].configuration = (*configuration);
+    ultimeter_hw_sim_ctx[instance].init_flag = 1;
+errors:
+    return status;
+}
+
+/*******************************************************************/
+ULTIMETER_status_t ULTIMETER_HW_de_init(uint8_t instance) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    // Release callbacks.
+    ultimeter_hw_sim_ctx[instance].init_flag = 0;
+    ultimeter_hw_sim_ctx[instance].interrupts_enable_flag = 0;
+    ultimeter_hw_sim_ctx[instance].timer_running_flag = 0;
+    return status;
+}
+
+/*******************************************************************/
+ULTIMETER_status_t ULTIMETER_HW_set_wind_speed_direction_interrupts(uint8_t instance, uint8_t enable) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    // Update mask.
+    ultimeter_hw_sim_ctx[instance].interrupts_enable_flag = (enable != 0) ? 1 : 0;
+    return status;
+}
+
+/*******************************************************************/
+ULTIMETER_status_t ULTIMETER_HW_timer_start(uint8_t instance) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    // The counter always runs, only the tick callback is gated.
+    ultimeter_hw_sim_ctx[instance].timer_running_flag = 1;
+    return status;
+}
+
+/*******************************************************************/
+ULTIMETER_status_t ULTIMETER_HW_timer_stop(uint8_t instance) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    // Gate tick callback.
+    ultimeter_hw_sim_ctx[instance].timer_running_flag = 0;
+    return status;
+}
+
+/*******************************************************************/
+uint32_t ULTIMETER_HW_timer_get_counter(uint8_t instance) {
+    // Local variables.
+    ULTIMETER_HW_SIM_context_t* context = &(ultimeter_hw_sim_ctx[instance]);
+    // Counter value at the current time.
+    return ((context->timer_counter_start + ((uint32_t) context->time_ticks)) & context->timer_counter_mask);
+}
+
+/*******************************************************************/
+uint8_t ULTIMETER_HW_timer_get_counter_width(uint8_t instance) {
+    return (ultimeter_hw_sim_ctx[instance].timer_counter_width);
+}
+
+/*******************************************************************/
+uint32_t ULTIMETER_HW_timer_get_frequency_hz(uint8_t instance) {
+    return (ultimeter_hw_sim_ctx[instance].timer_frequency_hz);
+}
+
+/*******************************************************************/
+void ULTIMETER_HW_enter_critical(uint8_t instance) {
+    // Local variables.
+    ULTIMETER_HW_SIM_context_t* context = &(ultimeter_hw_sim_ctx[instance]);
+    // The driver must never nest critical sections.
+    if (context->critical_flag != 0) {
+        context->status.nested_critical_count++;
+    }
+    context->critical_flag = 1;
+}
+
+/*******************************************************************/
+void ULTIMETER_HW_exit_critical(uint8_t instance) {
+    ultimeter_hw_sim_ctx[instance].critical_flag = 0;
+}
+
+#ifdef ULTIMETER_DRIVER_TICKLESS
+/*******************************************************************/
+ULTIMETER_status_t ULTIMETER_HW_set_alarm(uint8_t instance, uint32_t delay_seconds) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    ULTIMETER_HW_SIM_context_t* context = &(ultimeter_hw_sim_ctx[instance]);
+    // Program or cancel one-shot alarm.
+    context->tick_time_ticks = (delay_seconds == 0) ? ULTIMETER_HW_SIM_TIME_NONE : (context->time_ticks + (((uint64_t) delay_seconds) * ((uint64_t) context->timer_frequency_hz)));
+    context->status.alarm_count++;
+    return status;
+}
+#endif
+
+#ifdef ULTIMETER_DRIVER_DIAGNOSTICS
+/*******************************************************************/
+uint32_t ULTIMETER_HW_get_cycle_counter(uint8_t instance) {
+    // Local variables.
+    struct timespec now;
+    UNUSED(instance);
+    // Host nanoseconds are used as cycles.
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint32_t) ((((uint64_t) now.tv_sec) * 1000000000ULL) + ((uint64_t) now.tv_nsec)));
+}
+#endif
@@ -0,0 +1,116 @@
+/*
+ * ultimeter_hw_sim.h
+ *
+ *  Created on: 17 oct. 2026
+ *      Author: Ludo
+ */
+
+#ifndef __ULTIMETER_HW_SIM_H__
+#define __ULTIMETER_HW_SIM_H__
+
+#ifndef ULTIMETER_DRIVER_DISABLE_FLAGS_FILE
+#include "ultimeter_driver_flags.h"
+#endif
+#include "ultimeter_hw.h"
+#include "types.h"
+
+/*** ULTIMETER HW SIM macros ***/
+
+#define ULTIMETER_HW_SIM_INSTANCES_MAX      32
+
+#define ULTIMETER_HW_SIM_TIME_NONE          0xFFFFFFFFFFFFFFFF
+
+/*** ULTIMETER HW SIM structures ***/
+
+/*!******************************************************************
+ * \struct ULTIMETER_HW_SIM_configuration_t
+ * \brief Simulated timer of one instance.
+ * \note   The counter is equal to timer_counter_start at time 0 and wraps according to timer_counter_width.
+ *******************************************************************/
+typedef struct {
+    uint32_t timer_frequency_hz;
+    uint8_t timer_counter_width;
+    uint32_t timer_counter_start;
+} ULTIMETER_HW_SIM_configuration_t;
+
+/*!******************************************************************
+ * \struct ULTIMETER_HW_SIM_status_t
+ * \brief Simulated hardware interface checks.
+ *******************************************************************/
+typedef struct {
+    uint32_t nested_critical_count;
+    uint32_t masked_edge_count;
+    uint32_t alarm_count;
+} ULTIMETER_HW_SIM_status_t;
+
+/*** ULTIMETER HW SIM functions ***/
+
+/*!******************************************************************
+ * \fn void ULTIMETER_HW_SIM_configure(uint8_t instance, ULTIMETER_HW_SIM_configuration_t* configuration)
+ * \brief Configure the simulated timer of an instance and reset its time.
+ * \param[in]   instance: Instance to configure.
+ * \param[in]   configuration: Pointer to the simulated timer parameters.
+ * \param[out]  none
+ * \retval      none
+ * \note   This function must be called before ULTIMETER_init().
+ *******************************************************************/
+void ULTIMETER_HW_SIM_configure(uint8_t instance, ULTIMETER_HW_SIM_configuration_t* configuration);
+
+/*!******************************************************************
+ * \fn void ULTIMETER_HW_SIM_set_time(uint8_t instance, uint64_t time_ticks)
+ * \brief Move the simulated time of an instance.
+ * \param[in]   instance: Instance to update.
+ * \param[in]   time_ticks: New time in timer ticks since configuration.
+ * \param[out]  none
+ * \retval      none
+ *******************************************************************/
+void ULTIMETER_HW_SIM_set_time(uint8_t instance, uint64_t time_ticks);
+
+/*!******************************************************************
+ * \fn uint64_t ULTIMETER_HW_SIM_get_tick_time(uint8_t instance)
+ * \brief Get the time of the next tick callback.
+ * \param[in]   instance: Instance to read.
+ * \param[out]  none
+ * \retval      Time of the next 1 second tick (or alarm in tickless mode) in timer ticks, ULTIMETER_HW_SIM_TIME_NONE if none is pending.
+ *******************************************************************/
+uint64_t ULTIMETER_HW_SIM_get_tick_time(uint8_t instance);
+
+/*!******************************************************************
+ * \fn void ULTIMETER_HW_SIM_wind_speed_edge(uint8_t instance)
+ * \brief Simulate a wind speed edge at the current time.
+ * \param[in]   instance: Instance to drive.
+ * \param[out]  none
+ * \retval      none
+ * \note   The driver callback is not called when the edge interrupts are disabled.
+ *******************************************************************/
+void ULTIMETER_HW_SIM_wind_speed_edge(uint8_t instance);
+
+/*!******************************************************************
+ * \fn void ULTIMETER_HW_SIM_wind_direction_edge(uint8_t instance)
+ * \brief Simulate a wind direction edge at the current time.
+ * \param[in]   instance: Instance to drive.
+ * \param[out]  none
+ * \retval      none
+ * \note   The driver callback is not called when the edge interrupts are disabled.
+ *******************************************************************/
+void ULTIMETER_HW_SIM_wind_direction_edge(uint8_t instance);
+
+/*!******************************************************************
+ * \fn void ULTIMETER_HW_SIM_tick(uint8_t instance)
+ * \brief Simulate the tick (or alarm) interrupt and schedule the next one.
+ * \param[in]   instance: Instance to drive.
+ * \param[out]  none
+ * \retval      none
+ *******************************************************************/
+void ULTIMETER_HW_SIM_tick(uint8_t instance);
+
+/*!******************************************************************
+ * \fn void ULTIMETER_HW_SIM_get_status(uint8_t instance, ULTIMETER_HW_SIM_status_t* status)
+ * \brief Read the simulated hardware interface checks.
+ * \param[in]   instance: Instance to read.
+ * \param[out]  status: Pointer to the structure that will contain the checks counters.
+ * \retval      none
+ *******************************************************************/
+void ULTIMETER_HW_SIM_get_status(uint8_t instance, ULTIMETER_HW_SIM_status_t* status);
+
+#endif /* __ULTIMETER_HW_SIM_H__ */
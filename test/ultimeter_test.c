@@ -0,0 +1,1083 @@
+/*
+ * ultimeter_test.c
+ *
+ *  Created on: 17 oct. 2026
+ *      Author: Ludo
+ */
+
+#ifndef ULTIMETER_DRIVER_DISABLE_FLAGS_FILE
+#include "ultimeter_driver_flags.h"
+#endif
+#include "ultimeter.h"
+#ifdef ULTIMETER_DRIVER_BATCH
+#include "ultimeter_batch.h"
+#endif
+#include "ultimeter_hw_sim.h"
+#ifdef ULTIMETER_DRIVER_RECORDER
+#include "ultimeter_recorder.h"
+#endif
+#include "ultimeter_trace.h"
+#include "types.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+/*** ULTIMETER TEST local macros ***/
+
+#define ULTIMETER_TEST_INSTANCES_NUMBER     4
+
+#ifdef ULTIMETER_DRIVER_SINK_BATCH_RECORDS
+#define ULTIMETER_TEST_SINK_RECORDS_MAX     256
+#endif
+#if ((defined ULTIMETER_DRIVER_BATCH) && (defined ULTIMETER_DRIVER_SINK_BATCH_RECORDS) && (!defined ULTIMETER_DRIVER_WIND_SPEED_ONLY))
+#define ULTIMETER_TEST_BATCH_WINDOW_COUNT   120
+#define ULTIMETER_TEST_BATCH_EDGES_MAX      2048
+#endif
+#if ((defined ULTIMETER_DRIVER_RECORDER) && (defined ULTIMETER_DRIVER_SINK_BATCH_RECORDS) && (!defined ULTIMETER_DRIVER_WIND_SPEED_ONLY))
+#define ULTIMETER_TEST_RECORDER_BUFFER_SIZE_BYTES   2048
+#define ULTIMETER_TEST_RECORDER_SPEED_STEP_MH       100
+#endif
+#if ((defined ULTIMETER_DRIVER_WIND_ROSE_SECTORS) && (!defined ULTIMETER_DRIVER_WIND_SPEED_ONLY))
+#define ULTIMETER_TEST_WIND_ROSE_COUNTERS           (1 + (ULTIMETER_DRIVER_WIND_ROSE_SECTORS * ULTIMETER_DRIVER_WIND_ROSE_SPEED_BINS))
+#define ULTIMETER_TEST_WIND_ROSE_SIZE_BYTES         (2 * ULTIMETER_TEST_WIND_ROSE_COUNTERS)
+#endif
+#ifdef ULTIMETER_DRIVER_DEBOUNCE_WIND_SPEED_MAX_MH
+#define ULTIMETER_TEST_BOUNCE_INTERVAL_TICKS        1000
+#endif
+#ifdef ULTIMETER_DRIVER_STATE
+#define ULTIMETER_TEST_STATE_CRC16_POLYNOMIAL       0x1021
+#define ULTIMETER_TEST_STATE_CRC16_INIT             0xFFFF
+#endif
+
+#define ULTIMETER_TEST_CHECK(condition) { if (!(condition)) { printf("%s:%d: check failed: %s\r\n", __FILE__, __LINE__, #condition); test_error_count++; } }
+
+/*** ULTIMETER TEST local structures ***/
+
+/*******************************************************************/
+typedef struct {
+    char* name;
+    void (*function)(void);
+} ULTIMETER_TEST_case_t;
+
+/*******************************************************************/
+typedef struct {
+    double speed_tolerance_percent;
+    double direction_tolerance_degrees;
+} ULTIMETER_TEST_tolerance_t;
+
+/*** ULTIMETER TEST local global variables ***/
+
+static ULTIMETER_handle_t ultimeter_test_handle[ULTIMETER_TEST_INSTANCES_NUMBER];
+static ULTIMETER_TRACE_t ultimeter_test_trace[ULTIMETER_TEST_INSTANCES_NUMBER];
+static uint32_t ultimeter_test_process_count[ULTIMETER_TEST_INSTANCES_NUMBER];
+static uint32_t test_error_count = 0;
+#ifdef ULTIMETER_DRIVER_SINK_BATCH_RECORDS
+static ULTIMETER_sink_record_t ultimeter_test_sink_records[ULTIMETER_TEST_SINK_RECORDS_MAX];
+static uint32_t ultimeter_test_sink_record_count = 0;
+#endif
+#if ((defined ULTIMETER_DRIVER_BATCH) && (defined ULTIMETER_DRIVER_SINK_BATCH_RECORDS) && (!defined ULTIMETER_DRIVER_WIND_SPEED_ONLY))
+static uint32_t ultimeter_test_batch_wind_speed_edges[ULTIMETER_TEST_BATCH_EDGES_MAX];
+static uint32_t ultimeter_test_batch_wind_direction_edges[ULTIMETER_TEST_BATCH_EDGES_MAX];
+static uint32_t ultimeter_test_batch_wind_speed_mh[ULTIMETER_TEST_BATCH_WINDOW_COUNT];
+static uint32_t ultimeter_test_batch_peak_wind_speed_mh[ULTIMETER_TEST_BATCH_WINDOW_COUNT];
+static int32_t ultimeter_test_batch_wind_direction_degrees[ULTIMETER_TEST_BATCH_WINDOW_COUNT];
+static ULTIMETER_wind_direction_status_t ultimeter_test_batch_direction_status[ULTIMETER_TEST_BATCH_WINDOW_COUNT];
+static int64_t ultimeter_test_batch_trend_point_x[ULTIMETER_TEST_BATCH_WINDOW_COUNT];
+static int64_t ultimeter_test_batch_trend_point_y[ULTIMETER_TEST_BATCH_WINDOW_COUNT];
+#endif
+#if ((defined ULTIMETER_DRIVER_RECORDER) && (defined ULTIMETER_DRIVER_SINK_BATCH_RECORDS) && (!defined ULTIMETER_DRIVER_WIND_SPEED_ONLY))
+static uint8_t ultimeter_test_recorder_buffer[ULTIMETER_TEST_RECORDER_BUFFER_SIZE_BYTES];
+#endif
+
+/*** ULTIMETER TEST local functions ***/
+
+/*******************************************************************/
+static void _ULTIMETER_TEST_process_callback(ULTIMETER_handle_t* handle) {
+    ultimeter_test_process_count[handle->instance]++;
+}
+
+#ifdef ULTIMETER_DRIVER_SINK_BATCH_RECORDS
+/*******************************************************************/
+static void _ULTIMETER_TEST_sink_callback(ULTIMETER_handle_t* handle, ULTIMETER_sink_record_t* records, uint32_t record_count) {
+    // Local variables.
+    uint32_t idx = 0;
+    // Keep the first records of the run.
+    UNUSED(handle);
+    for (idx = 0; idx < record_count; idx++) {
+        if (ultimeter_test_sink_record_count >= ULTIMETER_TEST_SINK_RECORDS_MAX) break;
+        ultimeter_test_sink_records[ultimeter_test_sink_record_count++] = records[idx];
+    }
+}
+#endif
+
+/*******************************************************************/
+static void _ULTIMETER_TEST_start(uint8_t instance, ULTIMETER_HW_SIM_configuration_t* hw_configuration, ULTIMETER_TRACE_profile_t* profile) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    ULTIMETER_configuration_t configuration;
+    // Simulated timer.
+    ULTIMETER_HW_SIM_configure(instance, hw_configuration);
+    // Driver.
+    memset(&configuration, 0, sizeof(ULTIMETER_configuration_t));
+    configuration.instance = instance;
+    configuration.process_callback = &_ULTIMETER_TEST_process_callback;
+#ifdef ULTIMETER_DRIVER_SINK_BATCH_RECORDS
+    configuration.sink_callback = &_ULTIMETER_TEST_sink_callback;
+    ultimeter_test_sink_record_count = 0;
+#endif
+    ultimeter_test_process_count[instance] = 0;
+    status = ULTIMETER_init(&(ultimeter_test_handle[instance]), &configuration);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    status = ULTIMETER_set_wind_measurement(&(ultimeter_test_handle[instance]), 1);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    // Trace.
+    ULTIMETER_TRACE_init(&(ultimeter_test_trace[instance]), instance, (hw_configuration->timer_frequency_hz), profile);
+}
+
+/*******************************************************************/
+static void _ULTIMETER_TEST_check(uint8_t instance, ULTIMETER_TEST_tolerance_t* tolerance) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    ULTIMETER_handle_t* handle = &(ultimeter_test_handle[instance]);
+    ULTIMETER_HW_SIM_status_t hw_status;
+    int32_t average_speed_mh = 0;
+    int32_t peak_speed_mh = 0;
+    double truth_speed_mh = 0.0;
+    double truth_direction_degrees = 0.0;
+    uint32_t truth_rotation_count = 0;
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+    int32_t average_direction_degrees = 0;
+    ULTIMETER_wind_direction_status_t direction_status = ULTIMETER_WIND_DIRECTION_STATUS_UNDEFINED;
+#endif
+#ifdef ULTIMETER_DRIVER_EDGE_BUFFER_SIZE
+    uint32_t overflow_count = 0;
+#endif
+    // Ground truth.
+    ULTIMETER_TRACE_get_truth(&(ultimeter_test_trace[instance]), &truth_speed_mh, &truth_direction_degrees, &truth_rotation_count);
+    // Wind speed.
+    status = ULTIMETER_get_wind_speed(handle, &average_speed_mh, &peak_speed_mh);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    printf("instance %d: speed %d m/h (truth %.1f) peak %d m/h", instance, (int) average_speed_mh, truth_speed_mh, (int) peak_speed_mh);
+    ULTIMETER_TEST_CHECK(fabs(((double) average_speed_mh) - truth_speed_mh) <= ((truth_speed_mh * (tolerance->speed_tolerance_percent) / 100.0) + 1.0));
+    ULTIMETER_TEST_CHECK(average_speed_mh <= peak_speed_mh);
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+    // Wind direction.
+    status = ULTIMETER_get_wind_direction(handle, &average_direction_degrees, &direction_status);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    printf(" direction %d deg (truth %.1f)", (int) average_direction_degrees, truth_direction_degrees);
+    if (truth_rotation_count == 0) {
+        ULTIMETER_TEST_CHECK(direction_status == ULTIMETER_WIND_DIRECTION_STATUS_UNDEFINED);
+    }
+    else {
+        ULTIMETER_TEST_CHECK(direction_status == ULTIMETER_WIND_DIRECTION_STATUS_AVAILABLE);
+        ULTIMETER_TEST_CHECK(ULTIMETER_TRACE_get_direction_error((double) average_direction_degrees, truth_direction_degrees) <= (tolerance->direction_tolerance_degrees));
+    }
+#endif
+    printf(" rotations %u\r\n", (unsigned int) truth_rotation_count);
+    // Hardware interface and main loop.
+    ULTIMETER_HW_SIM_get_status(instance, &hw_status);
+    ULTIMETER_TEST_CHECK(hw_status.nested_critical_count == 0);
+    ULTIMETER_TEST_CHECK(ultimeter_test_trace[instance].process_error_count == 0);
+    ULTIMETER_TEST_CHECK(ultimeter_test_process_count[instance] != 0);
+#ifdef ULTIMETER_DRIVER_EDGE_BUFFER_SIZE
+    status = ULTIMETER_get_edge_buffer_overflow_count(handle, &overflow_count);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    ULTIMETER_TEST_CHECK(overflow_count == 0);
+#endif
+}
+
+/*******************************************************************/
+static void _ULTIMETER_TEST_stop(uint8_t instance) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    // Release instance.
+    status = ULTIMETER_de_init(&(ultimeter_test_handle[instance]));
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+}
+
+/*******************************************************************/
+static void _ULTIMETER_TEST_run_single(ULTIMETER_HW_SIM_configuration_t* hw_configuration, ULTIMETER_TRACE_profile_t* profile, uint32_t duration_seconds, ULTIMETER_TEST_tolerance_t* tolerance) {
+    // Run trace on instance 0.
+    _ULTIMETER_TEST_start(0, hw_configuration, profile);
+    ULTIMETER_TRACE_run(&(ultimeter_test_trace[0]), &(ultimeter_test_handle[0]), duration_seconds);
+    _ULTIMETER_TEST_check(0, tolerance);
+    _ULTIMETER_TEST_stop(0);
+}
+
+/*******************************************************************/
+static void _ULTIMETER_TEST_constant_wind(void) {
+    // Local variables.
+    ULTIMETER_HW_SIM_configuration_t hw_configuration = { 1000000, 32, 0 };
+    ULTIMETER_TRACE_profile_t profile = { 10000, 0, 0, 90, 0, 0, 0, 1 };
+    ULTIMETER_TEST_tolerance_t tolerance = { 0.5, 2.0 };
+    // Steady rotation.
+    _ULTIMETER_TEST_run_single(&hw_configuration, &profile, 600, &tolerance);
+}
+
+/*******************************************************************/
+static void _ULTIMETER_TEST_counter_wrap_16_bits(void) {
+    // Local variables.
+    ULTIMETER_HW_SIM_configuration_t hw_configuration = { 32768, 16, 0xFF00 };
+    ULTIMETER_TRACE_profile_t profile = { 7000, 0, 0, 250, 0, 0, 20, 2 };
+    ULTIMETER_TEST_tolerance_t tolerance = { 1.0, 2.0 };
+    // The counter wraps every 2 seconds.
+    _ULTIMETER_TEST_run_single(&hw_configuration, &profile, 600, &tolerance);
+}
+
+/*******************************************************************/
+static void _ULTIMETER_TEST_counter_wrap_32_bits(void) {
+    // Local variables.
+    ULTIMETER_HW_SIM_configuration_t hw_configuration = { 1000000, 32, (0xFFFFFFFF - 5000000) };
+    ULTIMETER_TRACE_profile_t profile = { 5000, 0, 0, 30, 0, 0, 20, 3 };
+    ULTIMETER_TEST_tolerance_t tolerance = { 1.0, 2.0 };
+    // The counter wraps after 5 seconds.
+    _ULTIMETER_TEST_run_single(&hw_configuration, &profile, 600, &tolerance);
+}
+
+/*******************************************************************/
+static void _ULTIMETER_TEST_gusts_and_jitter(void) {
+    // Local variables.
+    ULTIMETER_HW_SIM_configuration_t hw_configuration = { 1000000, 32, 0 };
+    ULTIMETER_TRACE_profile_t profile = { 8000, 4000, 60, 200, 20, 90, 100, 4 };
+    ULTIMETER_TEST_tolerance_t tolerance = { 1.0, 3.0 };
+    // Rotation rate and direction variations over whole modulation periods.
+    _ULTIMETER_TEST_run_single(&hw_configuration, &profile, 1800, &tolerance);
+}
+
+/*******************************************************************/
+static void _ULTIMETER_TEST_north_sweep(void) {
+    // Local variables.
+    ULTIMETER_HW_SIM_configuration_t hw_configuration = { 1000000, 32, 0 };
+    ULTIMETER_TRACE_profile_t profile = { 6000, 0, 0, 0, 40, 120, 50, 5 };
+    ULTIMETER_TEST_tolerance_t tolerance = { 1.0, 3.0 };
+    // Direction crosses north twice per sweep period.
+    _ULTIMETER_TEST_run_single(&hw_configuration, &profile, 1200, &tolerance);
+}
+
+/*******************************************************************/
+static void _ULTIMETER_TEST_calm(void) {
+    // Local variables.
+    ULTIMETER_HW_SIM_configuration_t hw_configuration = { 1000000, 32, 0 };
+    ULTIMETER_TRACE_profile_t profile = { 0, 0, 0, 0, 0, 0, 0, 6 };
+    ULTIMETER_TEST_tolerance_t tolerance = { 0.0, 0.0 };
+    // No edge at all.
+    _ULTIMETER_TEST_run_single(&hw_configuration, &profile, 120, &tolerance);
+}
+
+/*******************************************************************/
+static void _ULTIMETER_TEST_sampling_periods_change(void) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    ULTIMETER_HW_SIM_configuration_t hw_configuration = { 1000000, 32, 0 };
+    ULTIMETER_TRACE_profile_t profile = { 1000, 0, 0, 90, 0, 0, 0, 7 };
+    ULTIMETER_TEST_tolerance_t tolerance = { 0.5, 2.0 };
+    uint32_t idx = 0;
+    // Change the windows in the middle of the pending ones (and of the pending alarm in tickless mode), the windows durations must stay exact.
+    // Windows are limited to 6 seconds so that the edges fit the smallest deferred buffer between two alarms.
+    _ULTIMETER_TEST_start(0, &hw_configuration, &profile);
+    for (idx = 0; idx < 40; idx++) {
+        status = ULTIMETER_set_sampling_periods(&(ultimeter_test_handle[0]), (1 + ((idx * 5) % 6)), (5 + ((idx * 3) % 20)));
+        ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+        ULTIMETER_TRACE_run(&(ultimeter_test_trace[0]), &(ultimeter_test_handle[0]), (2 + (idx % 5)));
+    }
+    ULTIMETER_TRACE_run(&(ultimeter_test_trace[0]), &(ultimeter_test_handle[0]), 60);
+    _ULTIMETER_TEST_check(0, &tolerance);
+    _ULTIMETER_TEST_stop(0);
+}
+
+/*******************************************************************/
+static void _ULTIMETER_TEST_snapshot(void) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    ULTIMETER_HW_SIM_configuration_t hw_configuration = { 1000000, 32, 0 };
+    ULTIMETER_TRACE_profile_t profile = { 1000, 0, 0, 135, 0, 0, 20, 9 };
+    ULTIMETER_TEST_tolerance_t tolerance = { 1.0, 2.0 };
+    ULTIMETER_snapshot_t snapshot;
+    ULTIMETER_snapshot_t snapshot_previous;
+    int32_t average_speed_mh = 0;
+    int32_t peak_speed_mh = 0;
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+    ULTIMETER_wind_direction_statistics_t direction_statistics;
+#endif
+    uint32_t sequence = 0;
+    // 2 seconds wind speed windows and 60 seconds direction windows, with a rotation rate which fits the smallest deferred buffer between two alarms.
+    _ULTIMETER_TEST_start(0, &hw_configuration, &profile);
+    status = ULTIMETER_set_sampling_periods(&(ultimeter_test_handle[0]), 2, 60);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    status = ULTIMETER_get_snapshot(&(ultimeter_test_handle[0]), &snapshot);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    ULTIMETER_TEST_CHECK(snapshot.wind_speed_sample_count == 0);
+    sequence = snapshot.sequence;
+    // One snapshot per window end, the direction window ends with the last wind speed window.
+    ULTIMETER_TRACE_run(&(ultimeter_test_trace[0]), &(ultimeter_test_handle[0]), 60);
+    status = ULTIMETER_get_snapshot(&(ultimeter_test_handle[0]), &snapshot);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    printf("sequence %u: %u windows speed %d m/h peak %d m/h\r\n", (unsigned int) snapshot.sequence, (unsigned int) snapshot.wind_speed_sample_count, (int) snapshot.average_speed_mh, (int) snapshot.peak_speed_mh);
+    ULTIMETER_TEST_CHECK(snapshot.sequence == (sequence + 30));
+    ULTIMETER_TEST_CHECK(snapshot.wind_speed_sample_count == 30);
+    // Snapshot must give the same values as the individual getters.
+    status = ULTIMETER_get_wind_speed(&(ultimeter_test_handle[0]), &average_speed_mh, &peak_speed_mh);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    ULTIMETER_TEST_CHECK(snapshot.average_speed_mh == average_speed_mh);
+    ULTIMETER_TEST_CHECK(snapshot.peak_speed_mh == peak_speed_mh);
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+    status = ULTIMETER_get_wind_direction_statistics(&(ultimeter_test_handle[0]), &direction_statistics);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    ULTIMETER_TEST_CHECK(snapshot.wind_direction_sample_count != 0);
+    ULTIMETER_TEST_CHECK(snapshot.direction_statistics.direction_status == ULTIMETER_WIND_DIRECTION_STATUS_AVAILABLE);
+    ULTIMETER_TEST_CHECK(snapshot.direction_statistics.direction_status == direction_statistics.direction_status);
+    ULTIMETER_TEST_CHECK(snapshot.direction_statistics.average_direction_degrees == direction_statistics.average_direction_degrees);
+    ULTIMETER_TEST_CHECK(snapshot.direction_statistics.steadiness_per_mille == direction_statistics.steadiness_per_mille);
+    ULTIMETER_TEST_CHECK(snapshot.direction_statistics.standard_deviation_degrees == direction_statistics.standard_deviation_degrees);
+#endif
+    _ULTIMETER_TEST_check(0, &tolerance);
+    // No new snapshot in the middle of a window.
+    snapshot_previous = snapshot;
+    ULTIMETER_TRACE_run(&(ultimeter_test_trace[0]), &(ultimeter_test_handle[0]), 1);
+    status = ULTIMETER_get_snapshot(&(ultimeter_test_handle[0]), &snapshot);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    ULTIMETER_TEST_CHECK(snapshot.sequence == snapshot_previous.sequence);
+    ULTIMETER_TEST_CHECK(snapshot.wind_speed_sample_count == snapshot_previous.wind_speed_sample_count);
+    ULTIMETER_TEST_CHECK(snapshot.average_speed_mh == snapshot_previous.average_speed_mh);
+    // The wind speed window ends alone.
+    ULTIMETER_TRACE_run(&(ultimeter_test_trace[0]), &(ultimeter_test_handle[0]), 1);
+    status = ULTIMETER_get_snapshot(&(ultimeter_test_handle[0]), &snapshot);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    ULTIMETER_TEST_CHECK(snapshot.sequence == (sequence + 31));
+    ULTIMETER_TEST_CHECK(snapshot.wind_speed_sample_count == 31);
+    // Reset publishes an empty snapshot.
+    status = ULTIMETER_reset_measurements(&(ultimeter_test_handle[0]));
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    status = ULTIMETER_get_snapshot(&(ultimeter_test_handle[0]), &snapshot);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    ULTIMETER_TEST_CHECK(snapshot.sequence == (sequence + 32));
+    ULTIMETER_TEST_CHECK(snapshot.wind_speed_sample_count == 0);
+    ULTIMETER_TEST_CHECK(snapshot.average_speed_mh == 0);
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+    ULTIMETER_TEST_CHECK(snapshot.wind_direction_sample_count == 0);
+    ULTIMETER_TEST_CHECK(snapshot.direction_statistics.direction_status == ULTIMETER_WIND_DIRECTION_STATUS_UNDEFINED);
+#endif
+    _ULTIMETER_TEST_stop(0);
+}
+
+#if ((defined ULTIMETER_DRIVER_BATCH) && (defined ULTIMETER_DRIVER_SINK_BATCH_RECORDS) && (!defined ULTIMETER_DRIVER_WIND_SPEED_ONLY))
+/*******************************************************************/
+static void _ULTIMETER_TEST_batch_matches_driver(void) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    ULTIMETER_HW_SIM_configuration_t hw_configuration = { 1000000, 32, 0 };
+    ULTIMETER_TRACE_profile_t profile = { 3700, 1500, 30, 200, 60, 45, 100, 8 };
+    ULTIMETER_TRACE_t* trace = &(ultimeter_test_trace[0]);
+    ULTIMETER_handle_t* handle = &(ultimeter_test_handle[0]);
+    ULTIMETER_TRACE_event_t event = ULTIMETER_TRACE_EVENT_END;
+    ULTIMETER_BATCH_input_t input;
+    ULTIMETER_BATCH_output_t output;
+    ULTIMETER_BATCH_output_t period_output;
+    ULTIMETER_sink_record_t* record = NULL;
+    uint64_t window_ticks = (((uint64_t) ULTIMETER_DRIVER_WIND_SPEED_SAMPLING_TIME_SECONDS) * ((uint64_t) hw_configuration.timer_frequency_hz));
+    uint64_t end_ticks = (((uint64_t) ULTIMETER_TEST_BATCH_WINDOW_COUNT) * window_ticks);
+    uint32_t period_windows = (ULTIMETER_DRIVER_WIND_DIRECTION_SAMPLING_PERIOD_SECONDS / ULTIMETER_DRIVER_WIND_SPEED_SAMPLING_TIME_SECONDS);
+    int32_t driver_direction_degrees[ULTIMETER_TEST_BATCH_WINDOW_COUNT];
+    ULTIMETER_wind_direction_status_t driver_direction_status[ULTIMETER_TEST_BATCH_WINDOW_COUNT];
+    int32_t batch_direction_degrees = 0;
+    ULTIMETER_wind_direction_status_t batch_direction_status = ULTIMETER_WIND_DIRECTION_STATUS_UNDEFINED;
+    uint32_t window_count = 0;
+    uint32_t idx = 0;
+    // Run the driver on a trace and record its edges timestamps at the same time.
+    memset(&input, 0, sizeof(ULTIMETER_BATCH_input_t));
+    _ULTIMETER_TEST_start(0, &hw_configuration, &profile);
+    do {
+        event = ULTIMETER_TRACE_step(trace, end_ticks);
+        if ((event == ULTIMETER_TRACE_EVENT_WIND_SPEED_EDGE) && (input.wind_speed_edge_count < ULTIMETER_TEST_BATCH_EDGES_MAX)) {
+            ultimeter_test_batch_wind_speed_edges[input.wind_speed_edge_count++] = ULTIMETER_HW_timer_get_counter(0);
+        }
+        if ((event == ULTIMETER_TRACE_EVENT_WIND_DIRECTION_EDGE) && (input.wind_direction_edge_count < ULTIMETER_TEST_BATCH_EDGES_MAX)) {
+            ultimeter_test_batch_wind_direction_edges[input.wind_direction_edge_count++] = ULTIMETER_HW_timer_get_counter(0);
+        }
+        ULTIMETER_TRACE_dispatch(trace, handle, event);
+        // Average direction of the driver at the end of each window.
+        if ((event == ULTIMETER_TRACE_EVENT_TICK) && (((trace->time_ticks) % window_ticks) == 0)) {
+            window_count = (uint32_t) ((trace->time_ticks) / window_ticks);
+            status = ULTIMETER_get_wind_direction(handle, &(driver_direction_degrees[window_count - 1]), &(driver_direction_status[window_count - 1]));
+            ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+        }
+    }
+    while (event != ULTIMETER_TRACE_EVENT_END);
+    status = ULTIMETER_flush_sink(handle);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    ULTIMETER_TEST_CHECK(input.wind_speed_edge_count < ULTIMETER_TEST_BATCH_EDGES_MAX);
+    ULTIMETER_TEST_CHECK(window_count == ULTIMETER_TEST_BATCH_WINDOW_COUNT);
+    // Same trace processed at once.
+    input.wind_speed_edge_timestamps = ultimeter_test_batch_wind_speed_edges;
+    input.wind_direction_edge_timestamps = ultimeter_test_batch_wind_direction_edges;
+    input.start_counter = hw_configuration.timer_counter_start;
+    input.timer_frequency_hz = hw_configuration.timer_frequency_hz;
+    input.wind_speed_sampling_time_seconds = ULTIMETER_DRIVER_WIND_SPEED_SAMPLING_TIME_SECONDS;
+    input.wind_direction_sampling_period_seconds = ULTIMETER_DRIVER_WIND_DIRECTION_SAMPLING_PERIOD_SECONDS;
+    output.wind_speed_mh = ultimeter_test_batch_wind_speed_mh;
+    output.peak_wind_speed_mh = ultimeter_test_batch_peak_wind_speed_mh;
+    output.wind_direction_degrees = ultimeter_test_batch_wind_direction_degrees;
+    output.direction_status = ultimeter_test_batch_direction_status;
+    output.trend_point_x = ultimeter_test_batch_trend_point_x;
+    output.trend_point_y = ultimeter_test_batch_trend_point_y;
+    status = ULTIMETER_BATCH_process(&input, &output, ULTIMETER_TEST_BATCH_WINDOW_COUNT);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    // Each wind speed window record must give the batch results of the window.
+    ULTIMETER_TEST_CHECK(ultimeter_test_sink_record_count == ULTIMETER_TEST_BATCH_WINDOW_COUNT);
+    for (idx = 0; idx < ultimeter_test_sink_record_count; idx++) {
+        record = &(ultimeter_test_sink_records[idx]);
+        ULTIMETER_TEST_CHECK(((record->window_flags) & ULTIMETER_SINK_WINDOW_WIND_SPEED) != 0);
+        ULTIMETER_TEST_CHECK(record->wind_speed_mh == ultimeter_test_batch_wind_speed_mh[idx]);
+        ULTIMETER_TEST_CHECK(record->peak_wind_speed_mh == ultimeter_test_batch_peak_wind_speed_mh[idx]);
+        if (((record->window_flags) & ULTIMETER_SINK_WINDOW_WIND_DIRECTION) == 0) {
+            ULTIMETER_TEST_CHECK(record->direction_status == ultimeter_test_batch_direction_status[idx]);
+            ULTIMETER_TEST_CHECK(((int32_t) record->wind_direction_degrees) == ultimeter_test_batch_wind_direction_degrees[idx]);
+        }
+        else {
+            // Direction window records give the average of the windows of the direction period.
+            ULTIMETER_TEST_CHECK(((idx + 1) % period_windows) == 0);
+            period_output = output;
+            period_output.trend_point_x = &(ultimeter_test_batch_trend_point_x[idx + 1 - period_windows]);
+            period_output.trend_point_y = &(ultimeter_test_batch_trend_point_y[idx + 1 - period_windows]);
+            status = ULTIMETER_BATCH_get_wind_direction(&period_output, period_windows, &batch_direction_degrees, &batch_direction_status);
+            ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+            ULTIMETER_TEST_CHECK(record->direction_status == batch_direction_status);
+            ULTIMETER_TEST_CHECK(((int32_t) record->wind_direction_degrees) == batch_direction_degrees);
+        }
+    }
+    // The windows trend points must give the driver average direction at the end of each direction period.
+    for (idx = period_windows; idx <= ULTIMETER_TEST_BATCH_WINDOW_COUNT; idx += period_windows) {
+        status = ULTIMETER_BATCH_get_wind_direction(&output, idx, &batch_direction_degrees, &batch_direction_status);
+        ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+        ULTIMETER_TEST_CHECK(batch_direction_status == driver_direction_status[idx - 1]);
+        ULTIMETER_TEST_CHECK(batch_direction_degrees == driver_direction_degrees[idx - 1]);
+    }
+    printf("%u windows, %u speed edges, %u direction edges\r\n", (unsigned int) ultimeter_test_sink_record_count, (unsigned int) input.wind_speed_edge_count, (unsigned int) input.wind_direction_edge_count);
+    _ULTIMETER_TEST_stop(0);
+}
+#endif
+
+#ifdef ULTIMETER_DRIVER_DUTY_CYCLE
+/*******************************************************************/
+static void _ULTIMETER_TEST_duty_cycle(void) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    ULTIMETER_HW_SIM_configuration_t hw_configuration = { 1000000, 32, 0 };
+    ULTIMETER_TRACE_profile_t profile = { 2370, 0, 0, 160, 0, 0, 20, 9 };
+    ULTIMETER_TEST_tolerance_t tolerance = { 2.0, 2.0 };
+    ULTIMETER_TRACE_t* trace = &(ultimeter_test_trace[0]);
+    ULTIMETER_handle_t* handle = &(ultimeter_test_handle[0]);
+    ULTIMETER_snapshot_t burst_end_snapshot;
+    ULTIMETER_snapshot_t snapshot;
+    uint32_t idx = 0;
+    // Bursts of 6 seconds every 20 seconds.
+    _ULTIMETER_TEST_start(0, &hw_configuration, &profile);
+    status = ULTIMETER_set_sampling_periods(handle, 2, 10);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    status = ULTIMETER_set_duty_cycle(handle, 6, 20);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    // Bursts must keep containing complete windows.
+    status = ULTIMETER_set_sampling_periods(handle, 4, 10);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_ERROR_DUTY_CYCLE);
+    status = ULTIMETER_set_sampling_periods(handle, 3, 10);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    status = ULTIMETER_set_sampling_periods(handle, 2, 10);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    for (idx = 0; idx < 10; idx++) {
+        // Windows are frozen between the bursts.
+        ULTIMETER_TRACE_run(trace, handle, 7);
+        status = ULTIMETER_get_snapshot(handle, &burst_end_snapshot);
+        ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+        ULTIMETER_TEST_CHECK(burst_end_snapshot.wind_speed_sample_count == (3 * (idx + 1)));
+        ULTIMETER_TRACE_run(trace, handle, 12);
+        status = ULTIMETER_get_snapshot(handle, &snapshot);
+        ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+        ULTIMETER_TEST_CHECK(snapshot.sequence == burst_end_snapshot.sequence);
+        ULTIMETER_TEST_CHECK(snapshot.wind_speed_sample_count == burst_end_snapshot.wind_speed_sample_count);
+        ULTIMETER_TRACE_run(trace, handle, 1);
+    }
+    // The average of the bursts is the one of the whole steady trace (within a few rotations when the speed is given by the number of edges).
+    _ULTIMETER_TEST_check(0, &tolerance);
+    _ULTIMETER_TEST_stop(0);
+}
+#endif
+
+#if ((defined ULTIMETER_DRIVER_SINK_BATCH_RECORDS) && (!defined ULTIMETER_DRIVER_WIND_SPEED_ONLY))
+/*******************************************************************/
+static void _ULTIMETER_TEST_sink_direction_records(void) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    ULTIMETER_HW_SIM_configuration_t hw_configuration = { 1000000, 32, 0 };
+    ULTIMETER_TRACE_profile_t profile = { 2100, 0, 0, 250, 0, 0, 20, 10 };
+    ULTIMETER_TEST_tolerance_t tolerance = { 1.0, 2.0 };
+    ULTIMETER_sink_record_t* record = NULL;
+    uint32_t direction_record_count = 0;
+    uint32_t idx = 0;
+    // Direction windows which do not end with a wind speed window.
+    _ULTIMETER_TEST_start(0, &hw_configuration, &profile);
+    status = ULTIMETER_set_sampling_periods(&(ultimeter_test_handle[0]), 3, 5);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    ULTIMETER_TRACE_run(&(ultimeter_test_trace[0]), &(ultimeter_test_handle[0]), 150);
+    status = ULTIMETER_flush_sink(&(ultimeter_test_handle[0]));
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    // 50 wind speed windows and 30 direction windows, closed together every 15 seconds.
+    ULTIMETER_TEST_CHECK(ultimeter_test_sink_record_count == 70);
+    for (idx = 0; idx < ultimeter_test_sink_record_count; idx++) {
+        record = &(ultimeter_test_sink_records[idx]);
+        ULTIMETER_TEST_CHECK(record->window_flags != 0);
+        if (((record->window_flags) & ULTIMETER_SINK_WINDOW_WIND_SPEED) == 0) {
+            ULTIMETER_TEST_CHECK(record->wind_speed_mh == 0);
+        }
+        if (((record->window_flags) & ULTIMETER_SINK_WINDOW_WIND_DIRECTION) != 0) {
+            direction_record_count++;
+        }
+        // Steady wind: every record gives the wind direction.
+        ULTIMETER_TEST_CHECK(record->direction_status == ULTIMETER_WIND_DIRECTION_STATUS_AVAILABLE);
+        ULTIMETER_TEST_CHECK(ULTIMETER_TRACE_get_direction_error((double) record->wind_direction_degrees, (double) profile.direction_degrees) <= tolerance.direction_tolerance_degrees);
+    }
+    ULTIMETER_TEST_CHECK(direction_record_count == 30);
+    _ULTIMETER_TEST_check(0, &tolerance);
+    _ULTIMETER_TEST_stop(0);
+}
+#endif
+
+#if ((defined ULTIMETER_DRIVER_RECORDER) && (defined ULTIMETER_DRIVER_SINK_BATCH_RECORDS) && (!defined ULTIMETER_DRIVER_WIND_SPEED_ONLY))
+/*******************************************************************/
+static uint32_t _ULTIMETER_TEST_recorder_quantize(uint32_t speed_mh) {
+    // Closest recorder step.
+    return (((speed_mh + (ULTIMETER_TEST_RECORDER_SPEED_STEP_MH / 2)) / ULTIMETER_TEST_RECORDER_SPEED_STEP_MH) * ULTIMETER_TEST_RECORDER_SPEED_STEP_MH);
+}
+
+/*******************************************************************/
+static void _ULTIMETER_TEST_recorder_round_trip(void) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    ULTIMETER_HW_SIM_configuration_t hw_configuration = { 1000000, 32, 0 };
+    ULTIMETER_TRACE_profile_t profile = { 4000, 2500, 20, 0, 40, 30, 100, 11 };
+    ULTIMETER_RECORDER_t recorder;
+    ULTIMETER_RECORDER_sample_t sample;
+    ULTIMETER_sink_record_t* record = NULL;
+    // Zigzag edge cases: largest speed jumps in both directions, unit steps and direction differences around north and half a turn.
+    ULTIMETER_RECORDER_sample_t samples[] = {
+        { 0, 0, 0, ULTIMETER_WIND_DIRECTION_STATUS_AVAILABLE },
+        { 200000000, 200000000, 359, ULTIMETER_WIND_DIRECTION_STATUS_AVAILABLE },
+        { 0, 100, 0, ULTIMETER_WIND_DIRECTION_STATUS_AVAILABLE },
+        { 100, 100, 180, ULTIMETER_WIND_DIRECTION_STATUS_AVAILABLE },
+        { 0, 0, 0, ULTIMETER_WIND_DIRECTION_STATUS_UNDEFINED },
+        { 0, 200000000, 359, ULTIMETER_WIND_DIRECTION_STATUS_AVAILABLE },
+        { 100, 200, 179, ULTIMETER_WIND_DIRECTION_STATUS_AVAILABLE },
+        { 0, 0, 0, ULTIMETER_WIND_DIRECTION_STATUS_AVAILABLE },
+    };
+    uint32_t sample_count = (sizeof(samples) / sizeof(ULTIMETER_RECORDER_sample_t));
+    uint32_t data_size_bits = 0;
+    uint32_t record_count = 0;
+    uint32_t overflow_count = 0;
+    uint32_t idx = 0;
+    // Record the windows of a gusty trace crossing north, without direction window so that each record gives the last rotation.
+    status = ULTIMETER_RECORDER_init(&recorder, ultimeter_test_recorder_buffer, ULTIMETER_TEST_RECORDER_BUFFER_SIZE_BYTES);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    _ULTIMETER_TEST_start(0, &hw_configuration, &profile);
+    status = ULTIMETER_set_sampling_periods(&(ultimeter_test_handle[0]), 1, 1000);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    status = ULTIMETER_set_recorder(&(ultimeter_test_handle[0]), &recorder);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    ULTIMETER_TRACE_run(&(ultimeter_test_trace[0]), &(ultimeter_test_handle[0]), 240);
+    status = ULTIMETER_flush_sink(&(ultimeter_test_handle[0]));
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    status = ULTIMETER_RECORDER_get_data_size(&recorder, &data_size_bits, &record_count, &overflow_count);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    ULTIMETER_TEST_CHECK(record_count == 240);
+    ULTIMETER_TEST_CHECK(record_count == ultimeter_test_sink_record_count);
+    ULTIMETER_TEST_CHECK(overflow_count == 0);
+    printf("%u windows recorded in %u bits\r\n", (unsigned int) record_count, (unsigned int) data_size_bits);
+    // Decoded samples must give the window records.
+    status = ULTIMETER_RECORDER_open(&recorder, ultimeter_test_recorder_buffer, data_size_bits);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    for (idx = 0; idx < ultimeter_test_sink_record_count; idx++) {
+        record = &(ultimeter_test_sink_records[idx]);
+        status = ULTIMETER_RECORDER_read(&recorder, &sample);
+        ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+        ULTIMETER_TEST_CHECK(sample.wind_speed_mh == _ULTIMETER_TEST_recorder_quantize(record->wind_speed_mh));
+        ULTIMETER_TEST_CHECK(sample.peak_wind_speed_mh == _ULTIMETER_TEST_recorder_quantize(record->peak_wind_speed_mh));
+        ULTIMETER_TEST_CHECK(sample.direction_status == record->direction_status);
+        ULTIMETER_TEST_CHECK(sample.wind_direction_degrees == ((int32_t) record->wind_direction_degrees));
+    }
+    status = ULTIMETER_RECORDER_read(&recorder, &sample);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_ERROR_RECORDER_END);
+    _ULTIMETER_TEST_stop(0);
+    // Edge cases round trip, decoded from the whole buffer to check that padding is ignored.
+    memset(ultimeter_test_recorder_buffer, 0, ULTIMETER_TEST_RECORDER_BUFFER_SIZE_BYTES);
+    status = ULTIMETER_RECORDER_init(&recorder, ultimeter_test_recorder_buffer, ULTIMETER_TEST_RECORDER_BUFFER_SIZE_BYTES);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    for (idx = 0; idx < sample_count; idx++) {
+        status = ULTIMETER_RECORDER_append(&recorder, &(samples[idx]));
+        ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    }
+    status = ULTIMETER_RECORDER_open(&recorder, ultimeter_test_recorder_buffer, (ULTIMETER_TEST_RECORDER_BUFFER_SIZE_BYTES * 8));
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    for (idx = 0; idx < sample_count; idx++) {
+        status = ULTIMETER_RECORDER_read(&recorder, &sample);
+        ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+        ULTIMETER_TEST_CHECK(sample.wind_speed_mh == samples[idx].wind_speed_mh);
+        ULTIMETER_TEST_CHECK(sample.peak_wind_speed_mh == samples[idx].peak_wind_speed_mh);
+        ULTIMETER_TEST_CHECK(sample.direction_status == samples[idx].direction_status);
+        ULTIMETER_TEST_CHECK(sample.wind_direction_degrees == samples[idx].wind_direction_degrees);
+    }
+    status = ULTIMETER_RECORDER_read(&recorder, &sample);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_ERROR_RECORDER_END);
+    // Full buffer: the samples which do not fit are dropped and the record stays readable.
+    memset(ultimeter_test_recorder_buffer, 0, ULTIMETER_TEST_RECORDER_BUFFER_SIZE_BYTES);
+    status = ULTIMETER_RECORDER_init(&recorder, ultimeter_test_recorder_buffer, 8);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    for (idx = 0; idx < sample_count; idx++) {
+        status = ULTIMETER_RECORDER_append(&recorder, &(samples[idx]));
+        ULTIMETER_TEST_CHECK((status == ULTIMETER_SUCCESS) || (status == ULTIMETER_ERROR_RECORDER_FULL));
+    }
+    status = ULTIMETER_RECORDER_get_data_size(&recorder, &data_size_bits, &record_count, &overflow_count);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    ULTIMETER_TEST_CHECK(data_size_bits <= 64);
+    ULTIMETER_TEST_CHECK(overflow_count != 0);
+    ULTIMETER_TEST_CHECK((record_count + overflow_count) == sample_count);
+    status = ULTIMETER_RECORDER_open(&recorder, ultimeter_test_recorder_buffer, 64);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    for (idx = 0; idx < record_count; idx++) {
+        status = ULTIMETER_RECORDER_read(&recorder, &sample);
+        ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    }
+    status = ULTIMETER_RECORDER_read(&recorder, &sample);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_ERROR_RECORDER_END);
+}
+#endif
+
+#ifdef ULTIMETER_DRIVER_STATE
+/*******************************************************************/
+static void _ULTIMETER_TEST_state_seal(uint8_t* state) {
+    // Local variables.
+    uint16_t crc = ULTIMETER_TEST_STATE_CRC16_INIT;
+    uint32_t idx = 0;
+    uint8_t bit_idx = 0;
+    // Update the CRC16-CCITT of a modified state so that only the header check can reject it.
+    for (idx = 0; idx < (ULTIMETER_STATE_SIZE_BYTES - 2); idx++) {
+        crc ^= (uint16_t) (((uint16_t) state[idx]) << 8);
+        for (bit_idx = 0; bit_idx < 8; bit_idx++) {
+            crc = ((crc & 0x8000) != 0) ? (uint16_t) ((crc << 1) ^ ULTIMETER_TEST_STATE_CRC16_POLYNOMIAL) : (uint16_t) (crc << 1);
+        }
+    }
+    state[ULTIMETER_STATE_SIZE_BYTES - 2] = (uint8_t) (crc >> 0);
+    state[ULTIMETER_STATE_SIZE_BYTES - 1] = (uint8_t) (crc >> 8);
+}
+
+/*******************************************************************/
+static void _ULTIMETER_TEST_state_save_restore(void) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    ULTIMETER_HW_SIM_configuration_t hw_configuration = { 1000000, 32, 0 };
+    ULTIMETER_TRACE_profile_t profile = { 3000, 1500, 20, 290, 60, 120, 50, 5 };
+    uint8_t state[ULTIMETER_STATE_SIZE_BYTES];
+    uint8_t state_empty[ULTIMETER_STATE_SIZE_BYTES];
+    uint8_t state_check[ULTIMETER_STATE_SIZE_BYTES];
+    uint8_t state_corrupted[ULTIMETER_STATE_SIZE_BYTES];
+    int32_t average_speed_mh = 0;
+    int32_t peak_speed_mh = 0;
+    int32_t restored_average_speed_mh = 0;
+    int32_t restored_peak_speed_mh = 0;
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+    int32_t average_direction_degrees = 0;
+    int32_t restored_average_direction_degrees = 0;
+    ULTIMETER_wind_direction_status_t direction_status = ULTIMETER_WIND_DIRECTION_STATUS_UNDEFINED;
+    ULTIMETER_wind_direction_status_t restored_direction_status = ULTIMETER_WIND_DIRECTION_STATUS_UNDEFINED;
+#endif
+    // Accumulate some measurements.
+    _ULTIMETER_TEST_start(0, &hw_configuration, &profile);
+    ULTIMETER_TRACE_run(&(ultimeter_test_trace[0]), &(ultimeter_test_handle[0]), 300);
+    status = ULTIMETER_get_wind_speed(&(ultimeter_test_handle[0]), &average_speed_mh, &peak_speed_mh);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    ULTIMETER_TEST_CHECK(average_speed_mh > 0);
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+    status = ULTIMETER_get_wind_direction(&(ultimeter_test_handle[0]), &average_direction_degrees, &direction_status);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    ULTIMETER_TEST_CHECK(direction_status == ULTIMETER_WIND_DIRECTION_STATUS_AVAILABLE);
+#endif
+    status = ULTIMETER_save_state(&(ultimeter_test_handle[0]), state, (ULTIMETER_STATE_SIZE_BYTES - 1));
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_ERROR_STATE_SIZE);
+    status = ULTIMETER_save_state(&(ultimeter_test_handle[0]), state, ULTIMETER_STATE_SIZE_BYTES);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    status = ULTIMETER_reset_measurements(&(ultimeter_test_handle[0]));
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    status = ULTIMETER_save_state(&(ultimeter_test_handle[0]), state_empty, ULTIMETER_STATE_SIZE_BYTES);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    // Truncated state.
+    status = ULTIMETER_restore_state(&(ultimeter_test_handle[0]), state, (ULTIMETER_STATE_SIZE_BYTES - 1));
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_ERROR_STATE_SIZE);
+    // Flipped byte.
+    memcpy(state_corrupted, state, ULTIMETER_STATE_SIZE_BYTES);
+    state_corrupted[ULTIMETER_STATE_SIZE_BYTES / 2] ^= 0x01;
+    status = ULTIMETER_restore_state(&(ultimeter_test_handle[0]), state_corrupted, ULTIMETER_STATE_SIZE_BYTES);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_ERROR_STATE_CRC);
+    // Other version, options or wind rose dimensions.
+    memcpy(state_corrupted, state, ULTIMETER_STATE_SIZE_BYTES);
+    state_corrupted[0] = (ULTIMETER_STATE_VERSION + 1);
+    _ULTIMETER_TEST_state_seal(state_corrupted);
+    status = ULTIMETER_restore_state(&(ultimeter_test_handle[0]), state_corrupted, ULTIMETER_STATE_SIZE_BYTES);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_ERROR_STATE_VERSION);
+    memcpy(state_corrupted, state, ULTIMETER_STATE_SIZE_BYTES);
+    state_corrupted[1] ^= 0x80;
+    _ULTIMETER_TEST_state_seal(state_corrupted);
+    status = ULTIMETER_restore_state(&(ultimeter_test_handle[0]), state_corrupted, ULTIMETER_STATE_SIZE_BYTES);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_ERROR_STATE_VERSION);
+    memcpy(state_corrupted, state, ULTIMETER_STATE_SIZE_BYTES);
+    state_corrupted[2]++;
+    _ULTIMETER_TEST_state_seal(state_corrupted);
+    status = ULTIMETER_restore_state(&(ultimeter_test_handle[0]), state_corrupted, ULTIMETER_STATE_SIZE_BYTES);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_ERROR_STATE_VERSION);
+    // Rejected states must not modify the accumulators.
+    status = ULTIMETER_save_state(&(ultimeter_test_handle[0]), state_check, ULTIMETER_STATE_SIZE_BYTES);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    ULTIMETER_TEST_CHECK(memcmp(state_check, state_empty, ULTIMETER_STATE_SIZE_BYTES) == 0);
+    // Valid state.
+    status = ULTIMETER_restore_state(&(ultimeter_test_handle[0]), state, ULTIMETER_STATE_SIZE_BYTES);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    status = ULTIMETER_save_state(&(ultimeter_test_handle[0]), state_check, ULTIMETER_STATE_SIZE_BYTES);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    ULTIMETER_TEST_CHECK(memcmp(state_check, state, ULTIMETER_STATE_SIZE_BYTES) == 0);
+    status = ULTIMETER_get_wind_speed(&(ultimeter_test_handle[0]), &restored_average_speed_mh, &restored_peak_speed_mh);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    ULTIMETER_TEST_CHECK(restored_average_speed_mh == average_speed_mh);
+    ULTIMETER_TEST_CHECK(restored_peak_speed_mh == peak_speed_mh);
+#ifndef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+    status = ULTIMETER_get_wind_direction(&(ultimeter_test_handle[0]), &restored_average_direction_degrees, &restored_direction_status);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    ULTIMETER_TEST_CHECK(restored_direction_status == direction_status);
+    ULTIMETER_TEST_CHECK(restored_average_direction_degrees == average_direction_degrees);
+#endif
+    printf("state %u bytes: speed %d m/h peak %d m/h restored\r\n", (unsigned int) ULTIMETER_STATE_SIZE_BYTES, (int) restored_average_speed_mh, (int) restored_peak_speed_mh);
+    _ULTIMETER_TEST_stop(0);
+}
+#endif
+
+#ifdef ULTIMETER_DRIVER_SLIDING_WINDOW_LONG_SAMPLES
+/*******************************************************************/
+static void _ULTIMETER_TEST_sliding_window_gust(void) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    ULTIMETER_HW_SIM_configuration_t hw_configuration = { 1000000, 32, 0 };
+    ULTIMETER_TRACE_profile_t profile = { 2000, 0, 0, 90, 0, 0, 0, 8 };
+    ULTIMETER_TEST_tolerance_t tolerance = { 1.0, 0.0 };
+    double base_speed_mh = 0.0;
+    double gust_speed_mh = 0.0;
+    double truth_direction_degrees = 0.0;
+    uint32_t truth_rotation_count = 0;
+    int32_t sliding_window_gust_mh = 0;
+#ifdef ULTIMETER_DRIVER_WIND_SPEED_RECIPROCAL
+    int32_t instantaneous_gust_mh = 0;
+#endif
+    // Steady wind: the gust is the average speed.
+    _ULTIMETER_TEST_start(0, &hw_configuration, &profile);
+    ULTIMETER_TRACE_run(&(ultimeter_test_trace[0]), &(ultimeter_test_handle[0]), 60);
+    ULTIMETER_TRACE_get_truth(&(ultimeter_test_trace[0]), &base_speed_mh, &truth_direction_degrees, &truth_rotation_count);
+    status = ULTIMETER_get_sliding_window_gust(&(ultimeter_test_handle[0]), &sliding_window_gust_mh);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    printf("steady %.1f m/h: gust %d m/h\r\n", base_speed_mh, (int) sliding_window_gust_mh);
+    ULTIMETER_TEST_CHECK(fabs(((double) sliding_window_gust_mh) - base_speed_mh) <= (base_speed_mh * tolerance.speed_tolerance_percent / 100.0));
+    // Synthetic gust over several gust windows at three times the steady rotation rate.
+    ultimeter_test_trace[0].profile.rotation_frequency_mhz = 6000;
+    ULTIMETER_TRACE_run(&(ultimeter_test_trace[0]), &(ultimeter_test_handle[0]), 2);
+    ULTIMETER_TRACE_reset_truth(&(ultimeter_test_trace[0]));
+    ULTIMETER_TRACE_run(&(ultimeter_test_trace[0]), &(ultimeter_test_handle[0]), 20);
+    ULTIMETER_TRACE_get_truth(&(ultimeter_test_trace[0]), &gust_speed_mh, &truth_direction_degrees, &truth_rotation_count);
+    ultimeter_test_trace[0].profile.rotation_frequency_mhz = 2000;
+    ULTIMETER_TRACE_run(&(ultimeter_test_trace[0]), &(ultimeter_test_handle[0]), 60);
+    status = ULTIMETER_get_sliding_window_gust(&(ultimeter_test_handle[0]), &sliding_window_gust_mh);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    printf("gust %.1f m/h: gust %d m/h\r\n", gust_speed_mh, (int) sliding_window_gust_mh);
+    ULTIMETER_TEST_CHECK(fabs(((double) sliding_window_gust_mh) - gust_speed_mh) <= (gust_speed_mh * tolerance.speed_tolerance_percent / 100.0));
+#ifdef ULTIMETER_DRIVER_WIND_SPEED_RECIPROCAL
+    status = ULTIMETER_get_instantaneous_wind_gust(&(ultimeter_test_handle[0]), &instantaneous_gust_mh);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    ULTIMETER_TEST_CHECK(fabs(((double) instantaneous_gust_mh) - gust_speed_mh) <= (gust_speed_mh * tolerance.speed_tolerance_percent / 100.0));
+#endif
+    // The gust leaves the long sliding window.
+    ULTIMETER_TRACE_run(&(ultimeter_test_trace[0]), &(ultimeter_test_handle[0]), ULTIMETER_DRIVER_SLIDING_WINDOW_LONG_SAMPLES);
+    status = ULTIMETER_get_sliding_window_gust(&(ultimeter_test_handle[0]), &sliding_window_gust_mh);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    printf("steady %.1f m/h: gust %d m/h\r\n", base_speed_mh, (int) sliding_window_gust_mh);
+    ULTIMETER_TEST_CHECK(fabs(((double) sliding_window_gust_mh) - base_speed_mh) <= (base_speed_mh * tolerance.speed_tolerance_percent / 100.0));
+    // A gust shorter than the gust window is averaged with the steady wind.
+    ultimeter_test_trace[0].profile.rotation_frequency_mhz = 6000;
+    ULTIMETER_TRACE_run(&(ultimeter_test_trace[0]), &(ultimeter_test_handle[0]), (ULTIMETER_DRIVER_SLIDING_WINDOW_GUST_SAMPLES - 1));
+    ultimeter_test_trace[0].profile.rotation_frequency_mhz = 2000;
+    ULTIMETER_TRACE_run(&(ultimeter_test_trace[0]), &(ultimeter_test_handle[0]), 60);
+    gust_speed_mh = ((gust_speed_mh * (ULTIMETER_DRIVER_SLIDING_WINDOW_GUST_SAMPLES - 1)) + base_speed_mh) / ULTIMETER_DRIVER_SLIDING_WINDOW_GUST_SAMPLES;
+    status = ULTIMETER_get_sliding_window_gust(&(ultimeter_test_handle[0]), &sliding_window_gust_mh);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    printf("short gust %.1f m/h: gust %d m/h\r\n", gust_speed_mh, (int) sliding_window_gust_mh);
+    // Reciprocal window speeds average the rotations which ended in the window, so part of the gust can be given to the next window.
+    ULTIMETER_TEST_CHECK(((double) sliding_window_gust_mh) <= (gust_speed_mh * (1.0 + (tolerance.speed_tolerance_percent / 100.0))));
+    ULTIMETER_TEST_CHECK(((double) sliding_window_gust_mh) >= (base_speed_mh + ((gust_speed_mh - base_speed_mh) * 0.8)));
+    _ULTIMETER_TEST_stop(0);
+}
+#endif
+
+#if ((defined ULTIMETER_DRIVER_WIND_ROSE_SECTORS) && (!defined ULTIMETER_DRIVER_WIND_SPEED_ONLY))
+/*******************************************************************/
+static void _ULTIMETER_TEST_wind_rose_read(uint8_t bits_per_counter, uint32_t* counters) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    uint8_t buffer[ULTIMETER_TEST_WIND_ROSE_SIZE_BYTES];
+    uint32_t data_size_bytes = 0;
+    uint16_t full_scale_count = 0;
+    uint32_t bit_index = 0;
+    uint32_t idx = 0;
+    uint8_t bit_idx = 0;
+    // Export and unpack the counters (MSB first).
+    status = ULTIMETER_get_wind_rose(&(ultimeter_test_handle[0]), bits_per_counter, buffer, ULTIMETER_TEST_WIND_ROSE_SIZE_BYTES, &data_size_bytes, &full_scale_count);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    ULTIMETER_TEST_CHECK(data_size_bytes == (((ULTIMETER_TEST_WIND_ROSE_COUNTERS * ((uint32_t) bits_per_counter)) + 7) / 8));
+    for (idx = 0; idx < ULTIMETER_TEST_WIND_ROSE_COUNTERS; idx++) {
+        counters[idx] = 0;
+        for (bit_idx = 0; bit_idx < bits_per_counter; bit_idx++) {
+            counters[idx] = ((counters[idx] << 1) | ((buffer[bit_index >> 3] >> (7 - (bit_index & 0x07))) & 0x01));
+            bit_index++;
+        }
+    }
+}
+
+/*******************************************************************/
+static void _ULTIMETER_TEST_wind_rose(void) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    ULTIMETER_HW_SIM_configuration_t hw_configuration = { 1000000, 32, 0 };
+    // 16200 m/h from 20 degrees, then 32400 m/h from 200 degrees.
+    ULTIMETER_TRACE_profile_t profile = { 3000, 0, 0, 20, 0, 0, 0, 10 };
+    uint32_t counters[ULTIMETER_TEST_WIND_ROSE_COUNTERS];
+    uint32_t counter_index = 0;
+    uint32_t count_sum = 0;
+    uint32_t idx = 0;
+    // Steady wind in a single sector and speed bin, then calm.
+    _ULTIMETER_TEST_start(0, &hw_configuration, &profile);
+    ULTIMETER_TRACE_run(&(ultimeter_test_trace[0]), &(ultimeter_test_handle[0]), 60);
+    ultimeter_test_trace[0].profile.rotation_frequency_mhz = 0;
+    ULTIMETER_TRACE_run(&(ultimeter_test_trace[0]), &(ultimeter_test_handle[0]), 30);
+    _ULTIMETER_TEST_wind_rose_read(16, counters);
+    counter_index = 1 + (((20 * ULTIMETER_DRIVER_WIND_ROSE_SECTORS + 180) / 360) * ULTIMETER_DRIVER_WIND_ROSE_SPEED_BINS) + (16200 / ULTIMETER_DRIVER_WIND_ROSE_SPEED_BIN_WIDTH_MH);
+    printf("calm %u sector counter %u: %u\r\n", (unsigned int) counters[0], (unsigned int) counter_index, (unsigned int) counters[counter_index]);
+    for (idx = 0; idx < ULTIMETER_TEST_WIND_ROSE_COUNTERS; idx++) {
+        count_sum += counters[idx];
+    }
+    // Only the window where the rotations stop can fall elsewhere.
+    ULTIMETER_TEST_CHECK(count_sum == 90);
+    ULTIMETER_TEST_CHECK(counters[counter_index] >= 59);
+    ULTIMETER_TEST_CHECK(counters[0] >= 29);
+    ULTIMETER_TEST_CHECK((counters[counter_index] + counters[0]) >= 89);
+    // The maximum counter gives the full scale of smaller exports.
+    _ULTIMETER_TEST_wind_rose_read(4, counters);
+    ULTIMETER_TEST_CHECK(counters[counter_index] == 15);
+    ULTIMETER_TEST_CHECK((counters[0] >= 7) && (counters[0] <= 8));
+    // Speeds above the last bin are counted in the last bin.
+    status = ULTIMETER_reset_wind_rose(&(ultimeter_test_handle[0]));
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    _ULTIMETER_TEST_wind_rose_read(16, counters);
+    for (idx = 0; idx < ULTIMETER_TEST_WIND_ROSE_COUNTERS; idx++) {
+        ULTIMETER_TEST_CHECK(counters[idx] == 0);
+    }
+    _ULTIMETER_TEST_stop(0);
+    profile.rotation_frequency_mhz = 6000;
+    profile.direction_degrees = 200;
+    _ULTIMETER_TEST_start(0, &hw_configuration, &profile);
+    ULTIMETER_TRACE_run(&(ultimeter_test_trace[0]), &(ultimeter_test_handle[0]), 60);
+    _ULTIMETER_TEST_wind_rose_read(16, counters);
+    counter_index = 1 + (((200 * ULTIMETER_DRIVER_WIND_ROSE_SECTORS + 180) / 360) * ULTIMETER_DRIVER_WIND_ROSE_SPEED_BINS) + (ULTIMETER_DRIVER_WIND_ROSE_SPEED_BINS - 1);
+    printf("calm %u sector counter %u: %u\r\n", (unsigned int) counters[0], (unsigned int) counter_index, (unsigned int) counters[counter_index]);
+    ULTIMETER_TEST_CHECK(counters[counter_index] == 60);
+    _ULTIMETER_TEST_stop(0);
+}
+#endif
+
+#ifdef ULTIMETER_DRIVER_DEBOUNCE_WIND_SPEED_MAX_MH
+/*******************************************************************/
+static uint32_t _ULTIMETER_TEST_run_bouncing(uint32_t duration_seconds, uint32_t bounce_count) {
+    // Local variables.
+    ULTIMETER_TRACE_t* trace = &(ultimeter_test_trace[0]);
+    ULTIMETER_TRACE_event_t event = ULTIMETER_TRACE_EVENT_END;
+    uint64_t end_ticks = (trace->time_ticks) + (((uint64_t) duration_seconds) * ((uint64_t) trace->timer_frequency_hz));
+    uint64_t bounce_end_ticks = 0;
+    uint32_t bounce_total = 0;
+    uint32_t idx = 0;
+    // Each wind speed edge is followed by bounces of the reed switch (except when another event occurs meanwhile).
+    do {
+        event = ULTIMETER_TRACE_step(trace, end_ticks);
+        ULTIMETER_TRACE_dispatch(trace, &(ultimeter_test_handle[0]), event);
+        bounce_end_ticks = (trace->time_ticks) + (((uint64_t) bounce_count) * ULTIMETER_TEST_BOUNCE_INTERVAL_TICKS);
+        if ((event != ULTIMETER_TRACE_EVENT_WIND_SPEED_EDGE) || (ULTIMETER_TRACE_get_next_time(trace) <= bounce_end_ticks)) continue;
+        for (idx = 1; idx <= bounce_count; idx++) {
+            ULTIMETER_HW_SIM_set_time(0, (trace->time_ticks) + (((uint64_t) idx) * ULTIMETER_TEST_BOUNCE_INTERVAL_TICKS));
+            ULTIMETER_HW_SIM_wind_speed_edge(0);
+            bounce_total++;
+        }
+    }
+    while (event != ULTIMETER_TRACE_EVENT_END);
+    return bounce_total;
+}
+
+/*******************************************************************/
+static void _ULTIMETER_TEST_debounce(void) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    ULTIMETER_HW_SIM_configuration_t hw_configuration = { 1000000, 32, 0 };
+    ULTIMETER_TRACE_profile_t profile = { 2300, 0, 0, 60, 0, 0, 0, 12 };
+    ULTIMETER_TEST_tolerance_t tolerance = { 2.0, 3.0 };
+    uint32_t bounce_total = 0;
+    uint32_t rejected_edge_count = 0;
+    uint32_t storm_count = 0;
+#ifdef ULTIMETER_DRIVER_DEBOUNCE_STORM_EDGES
+    ULTIMETER_HW_SIM_status_t hw_status;
+    uint32_t masked_edge_count = 0;
+    uint32_t storm_bounce_total = 0;
+#endif
+    // Two bounces after each rotation, less than the storm threshold per tick.
+    _ULTIMETER_TEST_start(0, &hw_configuration, &profile);
+    bounce_total = _ULTIMETER_TEST_run_bouncing(60, 2);
+    status = ULTIMETER_get_rejected_edge_count(&(ultimeter_test_handle[0]), &rejected_edge_count, &storm_count);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    printf("%u bounces: %u rejected edges %u storms\r\n", (unsigned int) bounce_total, (unsigned int) rejected_edge_count, (unsigned int) storm_count);
+    ULTIMETER_TEST_CHECK(bounce_total != 0);
+    ULTIMETER_TEST_CHECK(rejected_edge_count == bounce_total);
+    ULTIMETER_TEST_CHECK(storm_count == 0);
+    _ULTIMETER_TEST_check(0, &tolerance);
+#ifdef ULTIMETER_DRIVER_DEBOUNCE_STORM_EDGES
+    // Bounces above the threshold mask the edges until the next tick.
+    ULTIMETER_HW_SIM_get_status(0, &hw_status);
+    masked_edge_count = hw_status.masked_edge_count;
+    storm_bounce_total = _ULTIMETER_TEST_run_bouncing(1, (ULTIMETER_DRIVER_DEBOUNCE_STORM_EDGES + 4));
+    status = ULTIMETER_get_rejected_edge_count(&(ultimeter_test_handle[0]), &rejected_edge_count, &storm_count);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    ULTIMETER_HW_SIM_get_status(0, &hw_status);
+    printf("storm: %u rejected edges %u storms %u masked edges\r\n", (unsigned int) rejected_edge_count, (unsigned int) storm_count, (unsigned int) (hw_status.masked_edge_count - masked_edge_count));
+    ULTIMETER_TEST_CHECK(rejected_edge_count == (bounce_total + ULTIMETER_DRIVER_DEBOUNCE_STORM_EDGES));
+    ULTIMETER_TEST_CHECK(storm_count == 1);
+    ULTIMETER_TEST_CHECK((hw_status.masked_edge_count - masked_edge_count) >= (storm_bounce_total - ULTIMETER_DRIVER_DEBOUNCE_STORM_EDGES));
+    // Edges are accepted again after the tick.
+    ULTIMETER_TRACE_run(&(ultimeter_test_trace[0]), &(ultimeter_test_handle[0]), 60);
+    ULTIMETER_HW_SIM_get_status(0, &hw_status);
+    masked_edge_count = hw_status.masked_edge_count;
+    ULTIMETER_TRACE_run(&(ultimeter_test_trace[0]), &(ultimeter_test_handle[0]), 10);
+    ULTIMETER_HW_SIM_get_status(0, &hw_status);
+    ULTIMETER_TEST_CHECK(hw_status.masked_edge_count == masked_edge_count);
+    status = ULTIMETER_get_rejected_edge_count(&(ultimeter_test_handle[0]), &rejected_edge_count, &storm_count);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    ULTIMETER_TEST_CHECK(rejected_edge_count == (bounce_total + ULTIMETER_DRIVER_DEBOUNCE_STORM_EDGES));
+    ULTIMETER_TEST_CHECK(storm_count == 1);
+    _ULTIMETER_TEST_check(0, &tolerance);
+#endif
+    // Counters are cleared with the measurements.
+    status = ULTIMETER_reset_measurements(&(ultimeter_test_handle[0]));
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    status = ULTIMETER_get_rejected_edge_count(&(ultimeter_test_handle[0]), &rejected_edge_count, &storm_count);
+    ULTIMETER_TEST_CHECK(status == ULTIMETER_SUCCESS);
+    ULTIMETER_TEST_CHECK(rejected_edge_count == 0);
+    ULTIMETER_TEST_CHECK(storm_count == 0);
+    _ULTIMETER_TEST_stop(0);
+}
+#endif
+
+/*******************************************************************/
+static void _ULTIMETER_TEST_multiple_instances(void) {
+    // Local variables.
+    ULTIMETER_HW_SIM_configuration_t hw_configuration = { 1000000, 32, 0 };
+    ULTIMETER_TRACE_profile_t profile = { 0, 0, 0, 0, 0, 0, 50, 0 };
+    ULTIMETER_TEST_tolerance_t tolerance = { 1.0, 2.0 };
+    ULTIMETER_TRACE_event_t event = ULTIMETER_TRACE_EVENT_END;
+    uint64_t end_ticks = (600 * ((uint64_t) hw_configuration.timer_frequency_hz));
+    uint64_t next_ticks = 0;
+    uint8_t instance = 0;
+    uint8_t idx = 0;
+    // Different wind on each instance.
+    for (idx = 0; idx < ULTIMETER_TEST_INSTANCES_NUMBER; idx++) {
+        profile.rotation_frequency_mhz = (1500 + (idx * 500));
+        profile.direction_degrees = (45 + (idx * 90));
+        profile.seed = (10 + idx);
+        hw_configuration.timer_counter_start = (((uint32_t) idx) * 0x40000000);
+        _ULTIMETER_TEST_start(idx, &hw_configuration, &profile);
+    }
+    // Interleave the events of all instances in time order.
+    while (1) {
+        next_ticks = ULTIMETER_HW_SIM_TIME_NONE;
+        for (idx = 0; idx < ULTIMETER_TEST_INSTANCES_NUMBER; idx++) {
+            if (ULTIMETER_TRACE_get_next_time(&(ultimeter_test_trace[idx])) < next_ticks) {
+                next_ticks = ULTIMETER_TRACE_get_next_time(&(ultimeter_test_trace[idx]));
+                instance = idx;
+            }
+        }
+        if (next_ticks > end_ticks) break;
+        event = ULTIMETER_TRACE_step(&(ultimeter_test_trace[instance]), end_ticks);
+        ULTIMETER_TRACE_dispatch(&(ultimeter_test_trace[instance]), &(ultimeter_test_handle[instance]), event);
+    }
+    // Close all traces at the same time.
+    for (idx = 0; idx < ULTIMETER_TEST_INSTANCES_NUMBER; idx++) {
+        ULTIMETER_TRACE_step(&(ultimeter_test_trace[idx]), end_ticks);
+        _ULTIMETER_TEST_check(idx, &tolerance);
+        _ULTIMETER_TEST_stop(idx);
+    }
+}
+
+/*** ULTIMETER TEST local global variables ***/
+
+static ULTIMETER_TEST_case_t ultimeter_test_cases[] = {
+    { "constant_wind", &_ULTIMETER_TEST_constant_wind },
+    { "counter_wrap_16_bits", &_ULTIMETER_TEST_counter_wrap_16_bits },
+    { "counter_wrap_32_bits", &_ULTIMETER_TEST_counter_wrap_32_bits },
+    { "gusts_and_jitter", &_ULTIMETER_TEST_gusts_and_jitter },
+    { "north_sweep", &_ULTIMETER_TEST_north_sweep },
+    { "calm", &_ULTIMETER_TEST_calm },
+    { "multiple_instances", &_ULTIMETER_TEST_multiple_instances },
+    { "sampling_periods_change", &_ULTIMETER_TEST_sampling_periods_change },
+    { "snapshot", &_ULTIMETER_TEST_snapshot },
+#if ((defined ULTIMETER_DRIVER_BATCH) && (defined ULTIMETER_DRIVER_SINK_BATCH_RECORDS) && (!defined ULTIMETER_DRIVER_WIND_SPEED_ONLY))
+    { "batch_matches_driver", &_ULTIMETER_TEST_batch_matches_driver },
+#endif
+#ifdef ULTIMETER_DRIVER_DUTY_CYCLE
+    { "duty_cycle", &_ULTIMETER_TEST_duty_cycle },
+#endif
+#if ((defined ULTIMETER_DRIVER_SINK_BATCH_RECORDS) && (!defined ULTIMETER_DRIVER_WIND_SPEED_ONLY))
+    { "sink_direction_records", &_ULTIMETER_TEST_sink_direction_records },
+#endif
+#if ((defined ULTIMETER_DRIVER_RECORDER) && (defined ULTIMETER_DRIVER_SINK_BATCH_RECORDS) && (!defined ULTIMETER_DRIVER_WIND_SPEED_ONLY))
+    { "recorder_round_trip", &_ULTIMETER_TEST_recorder_round_trip },
+#endif
+#ifdef ULTIMETER_DRIVER_STATE
+    { "state_save_restore", &_ULTIMETER_TEST_state_save_restore },
+#endif
+#ifdef ULTIMETER_DRIVER_SLIDING_WINDOW_LONG_SAMPLES
+    { "sliding_window_gust", &_ULTIMETER_TEST_sliding_window_gust },
+#endif
+#if ((defined ULTIMETER_DRIVER_WIND_ROSE_SECTORS) && (!defined ULTIMETER_DRIVER_WIND_SPEED_ONLY))
+    { "wind_rose", &_ULTIMETER_TEST_wind_rose },
+#endif
+#ifdef ULTIMETER_DRIVER_DEBOUNCE_WIND_SPEED_MAX_MH
+    { "debounce", &_ULTIMETER_TEST_debounce },
+#endif
+};
+
+/*** ULTIMETER TEST functions ***/
+
+/*******************************************************************/
+int main(int argc, char** argv) {
+    // Local variables.
+    uint32_t run_count = 0;
+    uint32_t idx = 0;
+    // Run the test given as argument, or all tests.
+    for (idx = 0; idx < (sizeof(ultimeter_test_cases) / sizeof(ULTIMETER_TEST_case_t)); idx++) {
+        if ((argc < 2) || (strcmp(argv[1], ultimeter_test_cases[idx].name) == 0)) {
+            printf("[%s]\r\n", ultimeter_test_cases[idx].name);
+            ultimeter_test_cases[idx].function();
+            run_count++;
+        }
+    }
+    if (run_count == 0) {
+        printf("Unknown test %s\r\n", argv[1]);
+        test_error_count++;
+    }
+    printf("%u error(s)\r\n", (unsigned int) test_error_count);
+    return ((test_error_count == 0) ? 0 : 1);
+}
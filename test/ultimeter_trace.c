@@ -0,0 +1,234 @@
+/*
+ * ultimeter_trace.c
+ *
+ *  Created on: 17 oct. 2026
+ *      Author: Ludo
+ */
+
+#include "ultimeter_trace.h"
+
+#ifndef ULTIMETER_DRIVER_DISABLE_FLAGS_FILE
+#include "ultimeter_driver_flags.h"
+#endif
+#include "ultimeter.h"
+#include "ultimeter_hw_sim.h"
+#include "ultimeter_math.h"
+#include "types.h"
+
+#include <math.h>
+
+/*** ULTIMETER TRACE local macros ***/
+
+#define ULTIMETER_TRACE_PI      3.14159265358979323846
+
+/*** ULTIMETER TRACE local functions ***/
+
+/*******************************************************************/
+static double _ULTIMETER_TRACE_random(ULTIMETER_TRACE_t* trace) {
+    // Xorshift generator, the traces are reproducible for a given seed.
+    trace->random ^= (trace->random << 13);
+    trace->random ^= (trace->random >> 17);
+    trace->random ^= (trace->random << 5);
+    // Uniform value between -1 and 1.
+    return ((((double) trace->random) / 2147483647.5) - 1.0);
+}
+
+/*******************************************************************/
+static double _ULTIMETER_TRACE_modulate(uint32_t base, uint32_t amplitude, uint32_t period_seconds, double time_seconds) {
+    // Local variables.
+    double value = (double) base;
+    // Sine modulation.
+    if (period_seconds != 0) {
+        value += ((double) amplitude) * sin((2.0 * ULTIMETER_TRACE_PI * time_seconds) / ((double) period_seconds));
+    }
+    return value;
+}
+
+/*******************************************************************/
+static void _ULTIMETER_TRACE_generate_rotation(ULTIMETER_TRACE_t* trace) {
+    // Local variables.
+    double start_seconds = (trace->rotation_end_seconds);
+    double frequency_hz = 0.0;
+    double period_seconds = 0.0;
+    double direction_degrees = 0.0;
+    // Calm wind.
+    if ((trace->profile.rotation_frequency_mhz) == 0) {
+        trace->wind_speed_edge_ticks = ULTIMETER_HW_SIM_TIME_NONE;
+        trace->wind_direction_edge_ticks = ULTIMETER_HW_SIM_TIME_NONE;
+        goto errors;
+    }
+    // Rotation period.
+    frequency_hz = _ULTIMETER_TRACE_modulate(trace->profile.rotation_frequency_mhz, trace->profile.rotation_gust_mhz, trace->profile.rotation_gust_period_seconds, start_seconds) / 1000.0;
+    if (frequency_hz < (((double) ULTIMETER_TRACE_ROTATION_FREQUENCY_MIN_MHZ) / 1000.0)) {
+        frequency_hz = (((double) ULTIMETER_TRACE_ROTATION_FREQUENCY_MIN_MHZ) / 1000.0);
+    }
+    period_seconds = (1.0 + ((((double) trace->profile.jitter_per_mille) / 1000.0) * _ULTIMETER_TRACE_random(trace))) / frequency_hz;
+    // Rotation direction.
+    direction_degrees = fmod(_ULTIMETER_TRACE_modulate(trace->profile.direction_degrees, trace->profile.direction_sweep_degrees, trace->profile.direction_sweep_period_seconds, start_seconds), 360.0);
+    if (direction_degrees < 0.0) {
+        direction_degrees += 360.0;
+    }
+    trace->rotation_direction_degrees = direction_degrees;
+    // Edges of the rotation.
+    trace->rotation_end_seconds = (start_seconds + period_seconds);
+    trace->wind_direction_edge_ticks = (uint64_t) (((start_seconds + ((period_seconds * direction_degrees) / 360.0)) * ((double) trace->timer_frequency_hz)) + 0.5);
+    trace->wind_speed_edge_ticks = (uint64_t) (((trace->rotation_end_seconds) * ((double) trace->timer_frequency_hz)) + 0.5);
+#ifdef ULTIMETER_DRIVER_WIND_SPEED_ONLY
+    trace->wind_direction_edge_ticks = ULTIMETER_HW_SIM_TIME_NONE;
+#endif
+errors:
+    return;
+}
+
+/*** ULTIMETER TRACE functions ***/
+
+/*******************************************************************/
+void ULTIMETER_TRACE_init(ULTIMETER_TRACE_t* trace, uint8_t instance, uint32_t timer_frequency_hz, ULTIMETER_TRACE_profile_t* profile) {
+    // Local variables.
+    uint64_t maximum_mhz = 0;
+    // Store parameters.
+    trace->instance = instance;
+    trace->timer_frequency_hz = timer_frequency_hz;
+    trace->profile = (*profile);
+    trace->random = ((profile->seed) == 0) ? 1 : (profile->seed);
+    // Scale the rotation rate down to the supported maximum.
+    maximum_mhz = ((uint64_t) (profile->rotation_frequency_mhz)) + ((uint64_t) (profile->rotation_gust_mhz));
+    if (maximum_mhz > ULTIMETER_TRACE_ROTATION_FREQUENCY_MAX_MHZ) {
+        trace->profile.rotation_frequency_mhz = (uint32_t) ((((uint64_t) (profile->rotation_frequency_mhz)) * ULTIMETER_TRACE_ROTATION_FREQUENCY_MAX_MHZ) / maximum_mhz);
+        trace->profile.rotation_gust_mhz = (uint32_t) ((((uint64_t) (profile->rotation_gust_mhz)) * ULTIMETER_TRACE_ROTATION_FREQUENCY_MAX_MHZ) / maximum_mhz);
+    }
+    // The simulated instance is configured at time 0.
+    trace->time_ticks = 0;
+    trace->rotation_end_seconds = 0.0;
+    trace->rotation_direction_degrees = 0.0;
+    trace->process_error_count = 0;
+    _ULTIMETER_TRACE_generate_rotation(trace);
+    ULTIMETER_TRACE_reset_truth(trace);
+}
+
+/*******************************************************************/
+uint64_t ULTIMETER_TRACE_get_next_time(ULTIMETER_TRACE_t* trace) {
+    // Local variables.
+    uint64_t next_ticks = ULTIMETER_HW_SIM_get_tick_time(trace->instance);
+    // Earliest event.
+    if ((trace->wind_direction_edge_ticks) < next_ticks) {
+        next_ticks = (trace->wind_direction_edge_ticks);
+    }
+    if ((trace->wind_speed_edge_ticks) < next_ticks) {
+        next_ticks = (trace->wind_speed_edge_ticks);
+    }
+    return next_ticks;
+}
+
+/*******************************************************************/
+ULTIMETER_TRACE_event_t ULTIMETER_TRACE_step(ULTIMETER_TRACE_t* trace, uint64_t end_ticks) {
+    // Local variables.
+    ULTIMETER_TRACE_event_t event = ULTIMETER_TRACE_EVENT_END;
+    uint64_t next_ticks = ULTIMETER_TRACE_get_next_time(trace);
+    // Check end of trace.
+    if (next_ticks > end_ticks) {
+        trace->time_ticks = end_ticks;
+        goto errors;
+    }
+    trace->time_ticks = next_ticks;
+    // Simultaneous events are ordered as speed edge, direction edge and tick.
+    if ((trace->wind_speed_edge_ticks) == next_ticks) {
+        event = ULTIMETER_TRACE_EVENT_WIND_SPEED_EDGE;
+        // Rotation is complete.
+        trace->truth_rotation_count++;
+        trace->truth_north += cos((trace->rotation_direction_degrees) * ULTIMETER_TRACE_PI / 180.0);
+        trace->truth_east += sin((trace->rotation_direction_degrees) * ULTIMETER_TRACE_PI / 180.0);
+        // A late direction edge is never generated after the rotation end.
+        if ((trace->wind_direction_edge_ticks) <= next_ticks) {
+            trace->wind_direction_edge_ticks = ULTIMETER_HW_SIM_TIME_NONE;
+        }
+        _ULTIMETER_TRACE_generate_rotation(trace);
+    }
+    else if ((trace->wind_direction_edge_ticks) == next_ticks) {
+        event = ULTIMETER_TRACE_EVENT_WIND_DIRECTION_EDGE;
+        trace->wind_direction_edge_ticks = ULTIMETER_HW_SIM_TIME_NONE;
+    }
+    else {
+        event = ULTIMETER_TRACE_EVENT_TICK;
+    }
+errors:
+    ULTIMETER_HW_SIM_set_time(trace->instance, trace->time_ticks);
+    return event;
+}
+
+/*******************************************************************/
+void ULTIMETER_TRACE_dispatch(ULTIMETER_TRACE_t* trace, ULTIMETER_handle_t* handle, ULTIMETER_TRACE_event_t event) {
+    // Local variables.
+    ULTIMETER_status_t status = ULTIMETER_SUCCESS;
+    // Call simulated hardware.
+    switch (event) {
+    case ULTIMETER_TRACE_EVENT_WIND_SPEED_EDGE:
+        ULTIMETER_HW_SIM_wind_speed_edge(trace->instance);
+        break;
+    case ULTIMETER_TRACE_EVENT_WIND_DIRECTION_EDGE:
+        ULTIMETER_HW_SIM_wind_direction_edge(trace->instance);
+        break;
+    case ULTIMETER_TRACE_EVENT_TICK:
+        ULTIMETER_HW_SIM_tick(trace->instance);
+        status = ULTIMETER_process(handle);
+        if (status != ULTIMETER_SUCCESS) {
+            trace->process_error_count++;
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+/*******************************************************************/
+void ULTIMETER_TRACE_run(ULTIMETER_TRACE_t* trace, ULTIMETER_handle_t* handle, uint32_t duration_seconds) {
+    // Local variables.
+    ULTIMETER_TRACE_event_t event = ULTIMETER_TRACE_EVENT_END;
+    uint64_t end_ticks = (trace->time_ticks) + (((uint64_t) duration_seconds) * ((uint64_t) trace->timer_frequency_hz));
+    // Events loop.
+    do {
+        event = ULTIMETER_TRACE_step(trace, end_ticks);
+        ULTIMETER_TRACE_dispatch(trace, handle, event);
+    }
+    while (event != ULTIMETER_TRACE_EVENT_END);
+}
+
+/*******************************************************************/
+void ULTIMETER_TRACE_reset_truth(ULTIMETER_TRACE_t* trace) {
+    trace->truth_start_ticks = (trace->time_ticks);
+    trace->truth_rotation_count = 0;
+    trace->truth_north = 0.0;
+    trace->truth_east = 0.0;
+}
+
+/*******************************************************************/
+void ULTIMETER_TRACE_get_truth(ULTIMETER_TRACE_t* trace, double* average_speed_mh, double* average_direction_degrees, uint32_t* rotation_count) {
+    // Local variables.
+    double duration_seconds = ((double) ((trace->time_ticks) - (trace->truth_start_ticks))) / ((double) trace->timer_frequency_hz);
+    // Reset outputs.
+    (*average_speed_mh) = 0.0;
+    (*average_direction_degrees) = 0.0;
+    (*rotation_count) = (trace->truth_rotation_count);
+    // Average speed.
+    if (duration_seconds > 0.0) {
+        (*average_speed_mh) = (((double) trace->truth_rotation_count) * ((double) ULTIMETER_WIND_SPEED_1HZ_TO_MH)) / duration_seconds;
+    }
+    // Vector average of the rotations directions.
+    if ((trace->truth_rotation_count) != 0) {
+        (*average_direction_degrees) = atan2(trace->truth_east, trace->truth_north) * 180.0 / ULTIMETER_TRACE_PI;
+        if ((*average_direction_degrees) < 0.0) {
+            (*average_direction_degrees) += 360.0;
+        }
+    }
+}
+
+/*******************************************************************/
+double ULTIMETER_TRACE_get_direction_error(double direction_degrees, double reference_degrees) {
+    // Local variables.
+    double error_degrees = fabs(fmod(direction_degrees - reference_degrees, 360.0));
+    // Shortest angle.
+    if (error_degrees > 180.0) {
+        error_degrees = (360.0 - error_degrees);
+    }
+    return error_degrees;
+}
@@ -0,0 +1,168 @@
+/*
+ * ultimeter_trace.h
+ *
+ *  Created on: 17 oct. 2026
+ *      Author: Ludo
+ */
+
+#ifndef __ULTIMETER_TRACE_H__
+#define __ULTIMETER_TRACE_H__
+
+#ifndef ULTIMETER_DRIVER_DISABLE_FLAGS_FILE
+#include "ultimeter_driver_flags.h"
+#endif
+#include "ultimeter.h"
+#include "ultimeter_hw_sim.h"
+#include "types.h"
+
+/*** ULTIMETER TRACE macros ***/
+
+// Edges are only drained by the tick when the deferred buffer is used, the rotation rate must fit the buffer with some margin.
+#ifdef ULTIMETER_DRIVER_EDGE_BUFFER_SIZE
+#define ULTIMETER_TRACE_ROTATION_FREQUENCY_MAX_MHZ  ((((ULTIMETER_DRIVER_EDGE_BUFFER_SIZE) / 2) - 1) * 1000)
+#else
+#define ULTIMETER_TRACE_ROTATION_FREQUENCY_MAX_MHZ  40000
+#endif
+#define ULTIMETER_TRACE_ROTATION_FREQUENCY_MIN_MHZ  100
+
+/*** ULTIMETER TRACE structures ***/
+
+/*!******************************************************************
+ * \enum ULTIMETER_TRACE_event_t
+ * \brief Simulated hardware events.
+ *******************************************************************/
+typedef enum {
+    ULTIMETER_TRACE_EVENT_WIND_SPEED_EDGE = 0,
+    ULTIMETER_TRACE_EVENT_WIND_DIRECTION_EDGE,
+    ULTIMETER_TRACE_EVENT_TICK,
+    ULTIMETER_TRACE_EVENT_END
+} ULTIMETER_TRACE_event_t;
+
+/*!******************************************************************
+ * \struct ULTIMETER_TRACE_profile_t
+ * \brief Wind profile of a trace.
+ * \note   The rotation rate and the direction are modulated by sine waves, a null rotation rate gives a calm trace without any edge.
+ * \note   The jitter is a uniform random variation of each rotation period.
+ *******************************************************************/
+typedef struct {
+    uint32_t rotation_frequency_mhz;
+    uint32_t rotation_gust_mhz;
+    uint32_t rotation_gust_period_seconds;
+    uint32_t direction_degrees;
+    uint32_t direction_sweep_degrees;
+    uint32_t direction_sweep_period_seconds;
+    uint32_t jitter_per_mille;
+    uint32_t seed;
+} ULTIMETER_TRACE_profile_t;
+
+/*!******************************************************************
+ * \struct ULTIMETER_TRACE_t
+ * \brief Trace generator context.
+ *******************************************************************/
+typedef struct {
+    uint8_t instance;
+    uint32_t timer_frequency_hz;
+    ULTIMETER_TRACE_profile_t profile;
+    uint32_t random;
+    double rotation_end_seconds;
+    uint64_t wind_speed_edge_ticks;
+    uint64_t wind_direction_edge_ticks;
+    uint64_t time_ticks;
+    double rotation_direction_degrees;
+    uint32_t process_error_count;
+    // Ground truth.
+    uint64_t truth_start_ticks;
+    uint32_t truth_rotation_count;
+    double truth_north;
+    double truth_east;
+} ULTIMETER_TRACE_t;
+
+/*** ULTIMETER TRACE functions ***/
+
+/*!******************************************************************
+ * \fn void ULTIMETER_TRACE_init(ULTIMETER_TRACE_t* trace, uint8_t instance, uint32_t timer_frequency_hz, ULTIMETER_TRACE_profile_t* profile)
+ * \brief Init a trace generator.
+ * \param[in]   trace: Pointer to the trace context.
+ * \param[in]   instance: Simulated instance driven by the trace.
+ * \param[in]   timer_frequency_hz: Frequency of the simulated timer.
+ * \param[in]   profile: Pointer to the wind profile.
+ * \param[out]  none
+ * \retval      none
+ * \note   The rotation rate is scaled down to ULTIMETER_TRACE_ROTATION_FREQUENCY_MAX_MHZ, the ground truth is reset.
+ *******************************************************************/
+void ULTIMETER_TRACE_init(ULTIMETER_TRACE_t* trace, uint8_t instance, uint32_t timer_frequency_hz, ULTIMETER_TRACE_profile_t* profile);
+
+/*!******************************************************************
+ * \fn uint64_t ULTIMETER_TRACE_get_next_time(ULTIMETER_TRACE_t* trace)
+ * \brief Get the time of the next event of a trace.
+ * \param[in]   trace: Pointer to the trace context.
+ * \param[out]  none
+ * \retval      Time of the next event in timer ticks.
+ *******************************************************************/
+uint64_t ULTIMETER_TRACE_get_next_time(ULTIMETER_TRACE_t* trace);
+
+/*!******************************************************************
+ * \fn ULTIMETER_TRACE_event_t ULTIMETER_TRACE_step(ULTIMETER_TRACE_t* trace, uint64_t end_ticks)
+ * \brief Move the simulated time to the next event of a trace.
+ * \param[in]   trace: Pointer to the trace context.
+ * \param[in]   end_ticks: End of the trace in timer ticks.
+ * \param[out]  none
+ * \retval      Next event, ULTIMETER_TRACE_EVENT_END if it occurs after end_ticks.
+ * \note   The event is not dispatched, so that its execution can be measured alone.
+ *******************************************************************/
+ULTIMETER_TRACE_event_t ULTIMETER_TRACE_step(ULTIMETER_TRACE_t* trace, uint64_t end_ticks);
+
+/*!******************************************************************
+ * \fn void ULTIMETER_TRACE_dispatch(ULTIMETER_TRACE_t* trace, ULTIMETER_handle_t* handle, ULTIMETER_TRACE_event_t event)
+ * \brief Dispatch an event to the simulated hardware of the instance.
+ * \param[in]   trace: Pointer to the trace context.
+ * \param[in]   handle: Pointer to the driver instance context.
+ * \param[in]   event: Event returned by ULTIMETER_TRACE_step().
+ * \param[out]  none
+ * \retval      none
+ * \note   The tick event also calls ULTIMETER_process() like the application main loop.
+ *******************************************************************/
+void ULTIMETER_TRACE_dispatch(ULTIMETER_TRACE_t* trace, ULTIMETER_handle_t* handle, ULTIMETER_TRACE_event_t event);
+
+/*!******************************************************************
+ * \fn void ULTIMETER_TRACE_run(ULTIMETER_TRACE_t* trace, ULTIMETER_handle_t* handle, uint32_t duration_seconds)
+ * \brief Run a trace on a driver instance.
+ * \param[in]   trace: Pointer to the trace context.
+ * \param[in]   handle: Pointer to the driver instance context.
+ * \param[in]   duration_seconds: Duration of the trace.
+ * \param[out]  none
+ * \retval      none
+ *******************************************************************/
+void ULTIMETER_TRACE_run(ULTIMETER_TRACE_t* trace, ULTIMETER_handle_t* handle, uint32_t duration_seconds);
+
+/*!******************************************************************
+ * \fn void ULTIMETER_TRACE_reset_truth(ULTIMETER_TRACE_t* trace)
+ * \brief Reset the ground truth of a trace at the current time.
+ * \param[in]   trace: Pointer to the trace context.
+ * \param[out]  none
+ * \retval      none
+ *******************************************************************/
+void ULTIMETER_TRACE_reset_truth(ULTIMETER_TRACE_t* trace);
+
+/*!******************************************************************
+ * \fn void ULTIMETER_TRACE_get_truth(ULTIMETER_TRACE_t* trace, double* average_speed_mh, double* average_direction_degrees, uint32_t* rotation_count)
+ * \brief Read the ground truth of a trace since last reset.
+ * \param[in]   trace: Pointer to the trace context.
+ * \param[out]  average_speed_mh: Pointer to the average wind speed in m/h.
+ * \param[out]  average_direction_degrees: Pointer to the vector average of the rotations directions in degrees.
+ * \param[out]  rotation_count: Pointer to the number of generated rotations.
+ * \retval      none
+ *******************************************************************/
+void ULTIMETER_TRACE_get_truth(ULTIMETER_TRACE_t* trace, double* average_speed_mh, double* average_direction_degrees, uint32_t* rotation_count);
+
+/*!******************************************************************
+ * \fn double ULTIMETER_TRACE_get_direction_error(double direction_degrees, double reference_degrees)
+ * \brief Compute the absolute angular difference between two directions.
+ * \param[in]   direction_degrees: Measured direction.
+ * \param[in]   reference_degrees: Reference direction.
+ * \param[out]  none
+ * \retval      Absolute difference in degrees (0 to 180).
+ *******************************************************************/
+double ULTIMETER_TRACE_get_direction_error(double direction_degrees, double reference_degrees);
+
+#endif /* __ULTIMETER_TRACE_H__ */